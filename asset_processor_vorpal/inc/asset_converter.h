@@ -4,8 +4,6 @@
 #include "asset_types.h"
 #include "result_codes.h"
 
-#define IS_NEWER(a,b) (last_write_time(a) > last_write_time(b))
-
 namespace vpl {
 
 	class AssetConverter
@@ -18,6 +16,10 @@ namespace vpl {
 			const std::experimental::filesystem::path& absoluteCookedAssetOutputPath) const = 0;
 		virtual const char* GetExtension() const = 0;
 		virtual const EAssetType GetAssetType() const = 0;
+		//name and settings version are part of the cook cache key,
+		//bump the settings version whenever a change to the converter changes its output
+		virtual const char* GetName() const = 0;
+		virtual uint64_t GetSettingsVersion() const = 0;
 	};
 
 }
\ No newline at end of file
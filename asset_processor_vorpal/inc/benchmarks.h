@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <experimental\filesystem>
+
+#include "../utility/latency_histogram.h"
+
+#define HASH_INDEX_BENCHMARK_LOOKUPS 100000
+#define HASH_INDEX_BENCHMARK_SCAN_LOOKUPS 1000//at 128k entries a single scan reads 4MB, fewer lookups keep it in seconds
+#define HASH_BENCHMARK_PATH_COUNT 10000
+#define HASH_BENCHMARK_BUFFER_BYTES (64 * 1024 * 1024)
+#define LOG_BENCHMARK_CALLS_PER_THREAD 50000
+#define LOG_BENCHMARK_MAX_THREADS 64
+
+namespace vpl
+{
+	//medians over every iteration, in nanoseconds per lookup
+	struct HashIndexBenchmarkResult
+	{
+		uint32_t entryCount;
+		uint32_t iterationCount;
+		double linearScanNs;//memcmp over the entries in directory walk order, how the asset librarian used to look guids up
+		double fanoutSearchNs;//FindLibraryEntry on the sorted entries of a library file
+		double hashIndexNs;
+		uint32_t missCount;//lookups that did not find their own entry, anything but 0 is a bug
+	};
+
+	//looks up guids of assets that are all in the library, built the way the cooker builds them
+	HashIndexBenchmarkResult RunHashIndexBenchmark(uint32_t entryCount, uint32_t iterationCount);
+	void FormatHashIndexBenchmark(const HashIndexBenchmarkResult& result, char* out_text, size_t textSize);
+
+	//medians over every iteration, in milliseconds per load, both files come from the os file cache after the first one
+	struct MeshLoadBenchmarkResult
+	{
+		uint32_t iterationCount;
+		uint32_t submeshCount;
+		uint64_t vertexCount;
+		uint64_t indexCount;
+		uint64_t assbinBytes;
+		uint64_t meshFileBytes;
+		double assbinMs;//an Assimp::Importer reading the assbin plus the per vertex copy the runtime used to do
+		double meshFileMs;//one read of the cooked mesh file, validated and used in place like LoadMesh does
+	};
+
+	//cooks the scene into an assbin and a mesh file in workDirectory and times loading them the way the runtime did and does
+	bool RunMeshLoadBenchmark(
+		const std::experimental::filesystem::path& scenePath,
+		const std::experimental::filesystem::path& workDirectory,
+		uint32_t iterationCount,
+		MeshLoadBenchmarkResult& out_result);
+	void FormatMeshLoadBenchmark(const MeshLoadBenchmarkResult& result, char* out_text, size_t textSize);
+
+	//medians over every iteration
+	struct HashBenchmarkResult
+	{
+		uint32_t iterationCount;
+		uint32_t pathCount;
+		uint32_t averagePathBytes;
+		double pathSHA1Ns;//utility::SHA1 of a std::string, how asset ids were built before Hash128, per path
+		double pathHash64Ns;
+		double pathHash128Ns;
+		uint64_t bufferBytes;
+		double bufferSHA1GBs;//gigabytes per second
+		double bufferHash128GBs;
+		uint64_t checksum;//every hash is folded in so none of them can be optimized out
+	};
+
+	//short relative asset paths like the cooker hashes for every file, then one large buffer like a texture
+	HashBenchmarkResult RunHashBenchmark(uint32_t iterationCount);
+	void FormatHashBenchmark(const HashBenchmarkResult& result, char* out_text, size_t textSize);
+
+	//per call latencies in nanoseconds, over every thread
+	struct LogBenchmarkResult
+	{
+		uint32_t threadCount;
+		uint32_t callsPerThread;
+		bool binaryLog;
+		pug::utility::LatencyHistogram logLatency;//PUG_LOG into the async logger
+		pug::utility::LatencyHistogram flushedLatency;//formatting, writing and flushing every line under a lock, how the logger used to work
+		double drainMs;//FlushLog after the last call, until the writer thread has everything on disk
+	};
+
+	//logs LOG_BENCHMARK_CALLS_PER_THREAD lines from every thread into the running log, file only, nothing goes to the console
+	//the flushed comparison writes the same lines to scratchFilePath and deletes it
+	void RunLogBenchmark(uint32_t threadCount, const std::experimental::filesystem::path& scratchFilePath, LogBenchmarkResult& out_result);
+	void FormatLogBenchmark(const LogBenchmarkResult& result, char* out_text, size_t textSize);
+}
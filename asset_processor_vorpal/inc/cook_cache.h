@@ -0,0 +1,75 @@
+#pragma once
+
+#include <experimental\filesystem>
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+#include "../utility/hash.h"
+#include "../utility/hash_index.h"
+#include "library_format.h"
+
+#define COOK_CACHE_FILE_NAME "cook_cache.pcc"
+#define COOK_CACHE_MAGIC 0x43435550//"PUCC" when read as bytes
+#define COOK_CACHE_VERSION 2
+
+namespace vpl {
+
+	class AssetConverter;
+
+	//persistent record of what every asset was last cooked from
+	//an asset only needs cooking when the hash of its source bytes, converter and converter settings changed,
+	//file timestamps are ignored so touching or checking out a file does not trigger a re cook
+	class CookCache
+	{
+	public:
+		CookCache();
+		~CookCache();
+
+		bool Load(const std::experimental::filesystem::path& cacheFilePath);
+		bool Save(const std::experimental::filesystem::path& cacheFilePath);
+
+		//Hash128(source bytes + converter name + converter settings version), the file is streamed through the hash
+		//out_contentKey has to hold HASH128_BYTES
+		static bool ComputeContentKey(
+			const std::experimental::filesystem::path& absoluteRawAssetPath,
+			const AssetConverter& converter,
+			char* out_contentKey);
+
+		//true if the asset was cooked from this exact content key during a previous run
+		bool IsUpToDate(const char* assetGUID, const char* contentKey) const;
+		//thread safe, only stored entries are written to the next cache file
+		void Store(const char* assetGUID, const char* contentKey);
+
+		void RecordHit() { ++m_hitCount; }
+		void RecordMiss() { ++m_missCount; }
+		uint32_t GetHitCount() const { return m_hitCount; }
+		uint32_t GetMissCount() const { return m_missCount; }
+
+	private:
+		struct Entry
+		{
+			char assetGUID[LIBRARY_GUID_BYTES];
+			char contentKey[HASH128_BYTES];
+		};//36 bytes
+
+		struct FileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t entryCount;
+			uint32_t entrySize;
+		};
+
+		//entries read from the previous cache file, read only while cooking
+		std::vector<Entry> m_previousEntries;
+		pug::utility::HashIndex m_previousIndex;
+
+		std::vector<Entry> m_entries;
+		std::mutex m_entriesLock;
+
+		std::atomic<uint32_t> m_hitCount;
+		std::atomic<uint32_t> m_missCount;
+	};
+
+}
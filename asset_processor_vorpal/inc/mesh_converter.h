@@ -1,12 +1,12 @@
 #pragma once
 #include "asset_converter.h"
 
-#define COOKED_MESH_EXTENSION ".assbin"
+#define COOKED_MESH_EXTENSION ".pmesh"//see mesh_format.h
+#define MESH_CONVERTER_VERSION 2
 
 namespace Assimp
 {
 	class Importer;
-	class Exporter;
 }
 
 namespace vpl {
@@ -24,10 +24,14 @@ namespace vpl {
 			const std::experimental::filesystem::path& outputDirectory) const override;
 		const char* GetExtension() const override { return COOKED_MESH_EXTENSION; }
 		const EAssetType GetAssetType() const override { return EAssetType::Mesh; }
+		const char* GetName() const override { return "mesh"; }
+		uint64_t GetSettingsVersion() const override;
+
+		//the assimp post processing every cooked mesh goes through
+		static uint32_t GetPostProcessingFlags();
 
 	private:
 		Assimp::Importer* m_importer;
-		Assimp::Exporter* m_exporter;
 	};
 
 }
\ No newline at end of file
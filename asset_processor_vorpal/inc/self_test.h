@@ -0,0 +1,14 @@
+#pragma once
+#include <cstdint>
+#include <experimental\filesystem>
+
+#define SELF_TEST_FILE_BYTES (1024 * 1024 + 13)//not a multiple of the sha1 block size
+
+namespace vpl
+{
+	//checks the sha1 code the cooker fingerprints assets with against the published test vectors
+	//and the legacy guid hash against digests of the original implementation,
+	//on the scalar path and on the sha extensions when the cpu has them
+	//temporary files go to workDirectory, every failed check is logged, returns the number of failed checks
+	uint32_t RunSHA1SelfTest(const std::experimental::filesystem::path& workDirectory);
+}
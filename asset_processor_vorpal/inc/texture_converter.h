@@ -2,6 +2,7 @@
 #include "asset_converter.h"
 
 #define COOKED_TEXTURE_EXTENSION ".dds"
+#define TEXTURE_CONVERTER_VERSION 1//bump when the texconv arguments change
 
 namespace vpl {
 
@@ -18,6 +19,8 @@ namespace vpl {
 			const std::experimental::filesystem::path& outputDirectory) const override;
 		const char* GetExtension() const override { return COOKED_TEXTURE_EXTENSION; }
 		const EAssetType GetAssetType() const override { return EAssetType::Texture; }
+		const char* GetName() const override { return "texture"; }
+		uint64_t GetSettingsVersion() const override { return TEXTURE_CONVERTER_VERSION; }
 
 	private:
 
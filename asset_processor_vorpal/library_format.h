@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+#define LIBRARY_FILE_MAGIC 0x4C414D50//"PMAL" when read as bytes
+#define LIBRARY_FILE_VERSION 3
+#define LIBRARY_GUID_BYTES 20
+//first version whose guids are Hash128 ids instead of sha1 hashes
+#define LIBRARY_HASH128_GUID_VERSION 3
+#define LIBRARY_FANOUT_SIZE 256
+
+namespace vpl
+{
+	//entries written by the asset cook tool
+	//the guid is the hash of the path relative to the library folder,
+	//sha1 up to version 2, since version 3 the 16 byte pug::utility::Hash128 of the '/' separated path followed by 4 zero bytes
+	struct LibraryAssetEntry
+	{
+		char assetGUID[LIBRARY_GUID_BYTES];//20 bytes
+		uint32_t type;
+		char extension[8];
+	};//32 bytes, hmmm alignment *drool*
+	static_assert(sizeof(LibraryAssetEntry) == 32, "Library entries are read and written as raw 32 byte records");
+
+	//version 1 header, the entries follow in directory walk order
+	//no magic, old files are recognized by the first word not being LIBRARY_FILE_MAGIC
+	struct LibraryFileHeaderV1
+	{
+		uint32_t entryCount;
+		uint32_t entrySize;
+	};
+
+	//version 2 and 3 header, the entries follow sorted by guid
+	//fanout[b] holds the number of entries whose first guid byte is <= b (like a git pack index),
+	//so the entries starting with byte b are in the range [fanout[b - 1], fanout[b])
+	struct LibraryFileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t entrySize;
+		uint32_t fanout[LIBRARY_FANOUT_SIZE];
+	};//1040 bytes, keeps the entries 16 byte aligned
+
+	inline int32_t CompareGUID(const char* a, const char* b)
+	{
+		return memcmp(a, b, LIBRARY_GUID_BYTES);
+	}
+
+	//binary search in the fanout bucket of the first guid byte
+	//returns the index of the entry or -1 if the guid is not in the library
+	inline int32_t FindLibraryEntry(
+		const LibraryFileHeader& header,
+		const LibraryAssetEntry* entries,
+		const char* guid)
+	{
+		const uint8_t firstByte = (uint8_t)guid[0];
+		uint32_t low = firstByte == 0 ? 0 : header.fanout[firstByte - 1];
+		uint32_t high = header.fanout[firstByte];
+		while (low < high)
+		{
+			uint32_t middle = low + ((high - low) >> 1);
+			int32_t comparison = CompareGUID(entries[middle].assetGUID, guid);
+			if (comparison == 0)
+			{
+				return (int32_t)middle;
+			}
+			if (comparison < 0)
+			{
+				low = middle + 1;
+			}
+			else
+			{
+				high = middle;
+			}
+		}
+		return -1;
+	}
+}//vpl
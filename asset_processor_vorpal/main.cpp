@@ -3,6 +3,10 @@
 #include <string>
 #include <cassert>
 #include <fstream>
+#include <vector>
+#include <algorithm>
+#include <mutex>
+#include <thread>
 #include <experimental\filesystem>
 
 #include "Windows.h"
@@ -10,13 +14,19 @@
 #include "logger.h"
 #include "mesh_converter.h"
 #include "texture_converter.h"
+#include "library_format.h"
+#include "cook_cache.h"
+#include "benchmarks.h"
+#include "self_test.h"
 
 #include "../utility/hash.h"
+#include "../utility/job_pool.h"
+#include "../utility/profiler.h"
+#include "../utility/allocator.h"
 
 #define MAX_PATH_SIZE 260
-#define MAX_ASSET_ENTRIES 1024
-#define ASSET_ENTRY_SIZE 32
 #define LIBRARY_FILE_NAME "asset_library.mal"
+#define BENCHMARK_ITERATIONS 5
 
 using namespace std;
 using namespace std::experimental::filesystem;
@@ -26,34 +36,86 @@ using namespace pug::log;
 
 const char* helpMessage =
 "Please specify a valid absolute windows path to be parsed, all sub folders will be parsed aswell!\n"
+"Usage: asset_processor <path> [-j <thread count>] [-binarylog] [-profile <trace.json>]\n"
+"  -j <thread count>  cook assets on this many threads, 0 uses one thread per core (default: 1)\n"
+"  -binarylog         write log.plog instead of log.txt, log_decoder turns it back into text\n"
+"  -profile <file>    write a Chrome trace of the cook, open it in chrome://tracing or ui.perfetto.dev\n"
+"Usage: asset_processor -benchmark <name> [argument]\n"
+"  hashindex          guid lookups in the hash index against a linear scan, at 2k, 16k and 128k assets\n"
+"  meshload <scene>   loading the scene as an assbin against loading it as a cooked mesh file\n"
+"  hash               SHA1 against Hash128 on short asset paths and on a 64MB buffer\n"
+"  log [threads]      per call latency of the logger from this many threads (default: one per core),\n"
+"                     adds 50000 lines per thread to the log, -binarylog measures the binary log\n"
+"Usage: asset_processor -selftest\n"
+"  checks SHA1 and HashFile against the published test vectors, exits with 1 if any check fails\n"
 ;
 
-AssetConverter* g_converters[] =
+//every cook thread owns its own set of converters,
+//the mesh converter holds an assimp importer which can not be shared between threads
+struct ConverterSet
 {
-	new MeshConverter(),
-	new TextureConverter(),
+	MeshConverter meshConverter;
+	TextureConverter textureConverter;
+	AssetConverter* converters[2] =
+	{
+		&meshConverter,
+		&textureConverter,
+	};
+};
+
+//a file found in the input folder, gathered up front so it can be cooked on any thread
+struct CookJob
+{
+	path absoluteRawAssetPath;
+	path relativeAssetPath;
 };
 
-char g_assetEntries[ASSET_ENTRY_SIZE * MAX_ASSET_ENTRIES];
-uint32_t g_numAssetEntries;
+vector<LibraryAssetEntry> g_assetEntries;
+mutex g_assetEntriesLock;
+mutex g_directoryLock;
 fstream g_assetLibraryFile;
+CookCache g_cookCache;
 
 void WriteAssetEntriesToFile()
 {
+	PUG_PROFILE_FUNCTION();
 	if (g_assetLibraryFile.is_open())
 	{
-		//write file header
-		uint32_t assetEntrySize = ASSET_ENTRY_SIZE;
-		if ((!g_assetLibraryFile.write((char*)&g_numAssetEntries, sizeof(g_numAssetEntries))))
+		//sort by guid so the runtime can binary search the mapped file
+		sort(g_assetEntries.begin(), g_assetEntries.end(), [](const LibraryAssetEntry& a, const LibraryAssetEntry& b)
+		{
+			return CompareGUID(a.assetGUID, b.assetGUID) < 0;
+		});
+		for (size_t i = 1; i < g_assetEntries.size(); ++i)
 		{
-			Error("Failed to write asset count to library file!");
+			if (CompareGUID(g_assetEntries[i - 1].assetGUID, g_assetEntries[i].assetGUID) == 0)
+			{
+				Warning("Duplicate asset guid found, only one of the assets will be found at runtime!");
+			}
+		}
+
+		//build the fanout table over the first guid byte
+		LibraryFileHeader header = {};
+		header.magic = LIBRARY_FILE_MAGIC;
+		header.version = LIBRARY_FILE_VERSION;
+		header.entryCount = (uint32_t)g_assetEntries.size();
+		header.entrySize = sizeof(LibraryAssetEntry);
+		for (const LibraryAssetEntry& entry : g_assetEntries)
+		{
+			++header.fanout[(uint8_t)entry.assetGUID[0]];
 		}
-		if ((!g_assetLibraryFile.write((char*)&assetEntrySize, sizeof(assetEntrySize))))
+		for (uint32_t i = 1; i < LIBRARY_FANOUT_SIZE; ++i)
 		{
-			Error("Failed to write asset entry size to library file!");
+			header.fanout[i] += header.fanout[i - 1];
+		}
+
+		//write file header
+		if (!g_assetLibraryFile.write((char*)&header, sizeof(header)))
+		{
+			Error("Failed to write header to library file!");
 		}
 		//write file body
-		if (!g_assetLibraryFile.write(g_assetEntries, ASSET_ENTRY_SIZE * g_numAssetEntries))
+		if (!g_assetLibraryFile.write((char*)g_assetEntries.data(), sizeof(LibraryAssetEntry) * g_assetEntries.size()))
 		{
 			Error("Failed to write asset entries to library file!");
 		}
@@ -65,37 +127,38 @@ void WriteAssetEntriesToFile()
 }
 
 void FormatAndAddAssetEntry(
-	const path& relativeAssetPath, 
+	const char* assetGUID, 
 	const EAssetType& type, 
 	const char* extension)
 {
-	char assetEntry[ASSET_ENTRY_SIZE];
-	utility::SHA1(relativeAssetPath.string(), assetEntry, SHA1_HASH_BYTES);//the hash function will write the result to the first 20 bytes after the passed ptr
-	memcpy(assetEntry + SHA1_HASH_BYTES, &type, sizeof(uint32_t));
-	memcpy(assetEntry + SHA1_HASH_BYTES + sizeof(uint32_t), extension, ASSET_ENTRY_SIZE - (SHA1_HASH_BYTES + sizeof(uint32_t)));
-
-	//copy formated asset entry to asset buffer
-	memcpy(g_assetEntries + (ASSET_ENTRY_SIZE * g_numAssetEntries), assetEntry, ASSET_ENTRY_SIZE);
-	++g_numAssetEntries;
-	assert(g_numAssetEntries <= MAX_ASSET_ENTRIES);
+	LibraryAssetEntry assetEntry = {};
+	memcpy(assetEntry.assetGUID, assetGUID, sizeof(assetEntry.assetGUID));
+	assetEntry.type = (uint32_t)type;
+	memcpy(assetEntry.extension, extension, strnlen(extension, sizeof(assetEntry.extension)));//not null terminated when all 8 bytes are used
+
+	lock_guard<mutex> lock(g_assetEntriesLock);//entries are sorted before writing, so the order they come in does not matter
+	g_assetEntries.push_back(assetEntry);
 }
 
-void CookAsset(const path& absoluteRawAssetPath, 
+void CookAsset(ConverterSet& converterSet,
+			   const path& absoluteRawAssetPath, 
 			   const path& outputDirectoryPath, 
 			   const path& relativeAssetPath)
 {
+	PUG_PROFILE_FUNCTION();
+	AssetConverter** converters = converterSet.converters;
 	AssetConverter* suitableConverter = nullptr;
 
-	for (uint32_t i = 0; i < sizeof(g_converters) / sizeof(g_converters[0]); ++i)
+	for (uint32_t i = 0; i < sizeof(converterSet.converters) / sizeof(converterSet.converters[0]); ++i)
 	{
 		path extension = absoluteRawAssetPath.extension();
 		if (extension.string().length() > 8)
 		{
 			Error("Files that have an extension of more than 8 characters are not supported");
 		}
-		if (g_converters[i]->IsExtensionSupported(extension))
+		if (converters[i]->IsExtensionSupported(extension))
 		{
-			suitableConverter = g_converters[i];
+			suitableConverter = converters[i];
 			break;
 		}
 	}
@@ -103,45 +166,119 @@ void CookAsset(const path& absoluteRawAssetPath,
 	if (suitableConverter != nullptr)
 	{//we found a converter that accepts these kind of files
 		path outputPath = outputDirectoryPath / relativeAssetPath.parent_path();
-		if (!exists(outputPath))
-		{//create any non-existing folder structures
-			create_directories(outputPath);
+		{
+			lock_guard<mutex> lock(g_directoryLock);
+			if (!exists(outputPath))
+			{//create any non-existing folder structures
+				create_directories(outputPath);
+			}
 		}
 
 		string rawAssetStem = absoluteRawAssetPath.stem().string();
 		path absoluteCookedAssetPath = outputPath / (rawAssetStem + suitableConverter->GetExtension());
+
+		const string relativeAssetPathString = relativeAssetPath.generic_string();//'/' separators, the same id as PUG_ASSET_ID
+		char assetGUID[LIBRARY_GUID_BYTES];
+		utility::WriteHash128(utility::HashBuffer128(relativeAssetPathString.data(), relativeAssetPathString.size()), assetGUID, sizeof(assetGUID));
+		char contentKey[HASH128_BYTES];
+		if (!CookCache::ComputeContentKey(absoluteRawAssetPath, *suitableConverter, contentKey))
+		{
+			PUG_ERROR("Failed to read asset from path: %s", absoluteRawAssetPath.string().c_str());
+			return;
+		}
+
 		if (exists(absoluteCookedAssetPath))
 		{//existing output file found
-			if (IS_NEWER(absoluteRawAssetPath, absoluteCookedAssetPath))
-			{//needs re cooking
-				Info("Updating asset from path: %s", absoluteRawAssetPath.string());
+			if (!g_cookCache.IsUpToDate(assetGUID, contentKey))
+			{//source content or converter settings changed, needs re cooking
+				g_cookCache.RecordMiss();
+				PUG_INFO("Updating asset from path: %s", absoluteRawAssetPath.string());
 				if(!suitableConverter->CookAsset(absoluteRawAssetPath, absoluteCookedAssetPath))
 				{//smth went wrong
-					Error("Failed to update asset from path: %s\n  Check the log for details", absoluteRawAssetPath.string().c_str());
+					PUG_ERROR("Failed to update asset from path: %s\n  Check the log for details", absoluteRawAssetPath.string().c_str());
 					return;
 				}
 			}
 			else
 			{
-				Log("Skipped %s", absoluteRawAssetPath.string());
+				g_cookCache.RecordHit();
+				PUG_LOG("Skipped %s", absoluteRawAssetPath.string());
 			}
 		}
 		else
 		{//new file entry
-			Info("Cooking new asset from path: %s", absoluteRawAssetPath.string());
+			g_cookCache.RecordMiss();
+			PUG_INFO("Cooking new asset from path: %s", absoluteRawAssetPath.string());
 			if (!suitableConverter->CookAsset(absoluteRawAssetPath, absoluteCookedAssetPath))
 			{//smth went wrong
-				Error("Failed to cook asset from path: %s\n  Check the log for details", absoluteRawAssetPath.string().c_str());
+				PUG_ERROR("Failed to cook asset from path: %s\n  Check the log for details", absoluteRawAssetPath.string().c_str());
 				return;
 			}
 		}
 
-		FormatAndAddAssetEntry(relativeAssetPath, suitableConverter->GetAssetType(), suitableConverter->GetExtension());
+		g_cookCache.Store(assetGUID, contentKey);
+		FormatAndAddAssetEntry(assetGUID, suitableConverter->GetAssetType(), suitableConverter->GetExtension());
 	}
 	else
 	{
-		Log("No suitable convert found for file: %s", absoluteRawAssetPath.string());
+		PUG_LOG("No suitable convert found for file: %s", absoluteRawAssetPath.string());
+	}
+}
+
+//results only go to the log, nothing is cooked
+bool RunBenchmark(const char* name, const char* argument)
+{
+	char resultText[1024];
+	if (!strcmp(name, "hashindex"))
+	{
+		const uint32_t entryCounts[] = { 2 * 1024, 16 * 1024, 128 * 1024 };
+		bool succeeded = true;
+		for (uint32_t entryCount : entryCounts)
+		{
+			HashIndexBenchmarkResult result = RunHashIndexBenchmark(entryCount, BENCHMARK_ITERATIONS);
+			FormatHashIndexBenchmark(result, resultText, sizeof(resultText));
+			Info("%s", resultText);
+			succeeded &= result.missCount == 0;
+		}
+		return succeeded;
+	}
+	if (!strcmp(name, "meshload"))
+	{
+		if (argument == nullptr || !exists(argument))
+		{
+			Error("The meshload benchmark needs the path of a scene file");
+			return false;
+		}
+		path workDirectory = temp_directory_path() / "pug_mesh_benchmark";
+		create_directories(workDirectory);
+		MeshLoadBenchmarkResult result;
+		const bool succeeded = RunMeshLoadBenchmark(argument, workDirectory, BENCHMARK_ITERATIONS, result);
+		remove_all(workDirectory);
+		if (succeeded)
+		{
+			FormatMeshLoadBenchmark(result, resultText, sizeof(resultText));
+			Info("%s", resultText);
+		}
+		return succeeded;
 	}
+	if (!strcmp(name, "hash"))
+	{
+		HashBenchmarkResult result = RunHashBenchmark(BENCHMARK_ITERATIONS);
+		FormatHashBenchmark(result, resultText, sizeof(resultText));
+		Info("%s", resultText);
+		return true;
+	}
+	if (!strcmp(name, "log"))
+	{
+		const uint32_t threadCount = argument != nullptr ? (uint32_t)atoi(argument) : max(thread::hardware_concurrency(), 1u);
+		LogBenchmarkResult result;
+		RunLogBenchmark(threadCount, temp_directory_path() / "pug_log_benchmark.txt", result);
+		FormatLogBenchmark(result, resultText, sizeof(resultText));
+		Info("%s", resultText);
+		return true;
+	}
+	Error("Unknown benchmark %s. Use \'help\' for a list of benchmarks", name);
+	return false;
 }
 
 int main(int argc, char* argv[])
@@ -150,11 +287,20 @@ int main(int argc, char* argv[])
 	GetModuleFileName(GetModuleHandleA(NULL), executablePath, MAX_PATH_SIZE);
 	path exePath = executablePath;
 
-	StartLog(exePath.parent_path().string());
+	ELogFileFormat logFileFormat = LogFileFormat_Text;
+	for (int i = 2; i < argc; ++i)
+	{//before anything is logged
+		if (!strcmp(argv[i], "-binarylog"))
+		{
+			logFileFormat = LogFileFormat_Binary;
+		}
+	}
+	StartLog(exePath.parent_path().string(), BreakLevel_Error, logFileFormat);
 
 	if (argc <= 1)
 	{
 		Error("No command specified. Use \'help\' for a detailed command list");
+		EndLog();
 		return 1;
 	}
 
@@ -164,14 +310,77 @@ int main(int argc, char* argv[])
 	if (!strcmp(argv[1], "help") || !strcmp(argv[1], "--help") || !strcmp(argv[1], "-h") || !strcmp(argv[1], "-help"))
 	{
 		Info(helpMessage);
+		EndLog();
 		return 1;
 	}
 
+	if (!strcmp(argv[1], "-benchmark"))
+	{
+		const bool succeeded = argc > 2 && RunBenchmark(argv[2], argc > 3 && argv[3][0] != '-' ? argv[3] : nullptr);//not -binarylog
+		if (argc <= 2)
+		{
+			Error("No benchmark specified. Use \'help\' for a list of benchmarks");
+		}
+		EndLog();
+		return succeeded ? 0 : 1;
+	}
+
+	if (!strcmp(argv[1], "-selftest"))
+	{
+		path workDirectory = temp_directory_path() / "pug_self_test";
+		create_directories(workDirectory);
+		const uint32_t failedCount = RunSHA1SelfTest(workDirectory);
+		remove_all(workDirectory);
+		if (failedCount > 0)
+		{
+			Error("Self test failed, %d checks did not pass", failedCount);
+		}
+		else
+		{
+			Info("Self test passed");
+		}
+		EndLog();
+		return failedCount > 0 ? 1 : 0;
+	}
+
+	uint32_t threadCount = 1;
+	const char* profileFilePath = nullptr;
+	for (int i = 2; i < argc; ++i)
+	{
+		if (!strcmp(argv[i], "-j") && i + 1 < argc)
+		{
+			threadCount = (uint32_t)atoi(argv[++i]);
+			if (threadCount == 0)
+			{
+				threadCount = max(thread::hardware_concurrency(), 1u);
+			}
+		}
+		else if (!strcmp(argv[i], "-binarylog"))
+		{
+			//handled before the log was started
+		}
+		else if (!strcmp(argv[i], "-profile") && i + 1 < argc)
+		{
+			profileFilePath = argv[++i];
+		}
+		else
+		{
+			Warning("Unknown argument %s", argv[i]);
+		}
+	}
+
+	if (profileFilePath != nullptr)
+	{
+		utility::SetProfilerThreadName("main");
+		utility::BeginProfileCapture();
+	}
+
 	path inputFolderPath = canonical(argv[1]);
 	path outputFolderPath = canonical(argv[1] + string("/../library/"));
 	if (!exists(inputFolderPath))
 	{
 		Error("Specified input folder does not exist!");
+		EndLog();
 		return 1;
 	}
 	if (!exists(outputFolderPath))
@@ -179,20 +388,26 @@ int main(int argc, char* argv[])
 		if (!create_directories(outputFolderPath))
 		{
 			Error("Failed to create output directory at %s!", outputFolderPath.string().c_str());
+			EndLog();
 			return 1;
 		}
 	}
 
 	path libraryFilePath = outputFolderPath / LIBRARY_FILE_NAME;
-	g_numAssetEntries = 0;
+	g_assetEntries.clear();
 	g_assetLibraryFile.open(libraryFilePath, fstream::out | fstream::binary | fstream::trunc);
 	if (!g_assetLibraryFile.is_open())
 	{
 		Error("Failed to open library file!");
+		EndLog();
 		return 1;
 	}
-	memset(g_assetEntries, 0, ASSET_ENTRY_SIZE * MAX_ASSET_ENTRIES);
 
+	path cookCachePath = outputFolderPath / COOK_CACHE_FILE_NAME;
+	g_cookCache.Load(cookCachePath);
+
+	//gather the file list first so it can be spread over the cook threads
+	vector<CookJob> cookJobs;
 	size_t len = inputFolderPath.string().length();//the length of the path of our asset root directory
 	recursive_directory_iterator it = recursive_directory_iterator(inputFolderPath);
 	for (recursive_directory_iterator end = recursive_directory_iterator(); it != end; ++it)
@@ -204,12 +419,56 @@ int main(int argc, char* argv[])
 			auto relBeg = absolutePath.begin() + (len + 1);//+1 for the additional seperator
 			auto relEnd = absolutePath.end();
 			string rel = string(relBeg, relEnd);
-			CookAsset(dirEntry, outputFolderPath, rel);
+			cookJobs.push_back({ dirEntry.path(), rel });
 		}
 	}
 
+	threadCount = min(threadCount, max((uint32_t)cookJobs.size(), 1u));
+	Info("Cooking %d files on %d threads", (uint32_t)cookJobs.size(), threadCount);
+
+	vector<ConverterSet*> converterSets;
+	for (uint32_t i = 0; i < threadCount; ++i)
+	{
+		converterSets.push_back(utility::New<ConverterSet>(utility::MemoryTag_Cooker));
+	}
+
+	utility::JobPool jobPool;
+	jobPool.Initialize(threadCount);
+	jobPool.Run((uint32_t)cookJobs.size(), [&](uint32_t jobIndex, uint32_t workerIndex)
+	{
+		const CookJob& job = cookJobs[jobIndex];
+		CookAsset(*converterSets[workerIndex], job.absoluteRawAssetPath, outputFolderPath, job.relativeAssetPath);
+	});
+	jobPool.Destroy();
+	for (ConverterSet* converterSet : converterSets)
+	{
+		utility::Delete(converterSet);
+	}
+
+	g_cookCache.Save(cookCachePath);
+	Info("Cook cache: %d hits, %d misses", g_cookCache.GetHitCount(), g_cookCache.GetMissCount());
+
+	utility::MemoryStats memoryStats;
+	utility::GetMemoryStats(memoryStats);
+	char memoryStatsText[1024];
+	utility::FormatMemoryStats(memoryStats, memoryStatsText, sizeof(memoryStatsText));
+	Info("Tracked memory:\n%s", memoryStatsText);
+
 	WriteAssetEntriesToFile();
 	g_assetLibraryFile.close();
+
+	if (profileFilePath != nullptr)
+	{
+		utility::EndProfileCapture();
+		if (utility::WriteChromeTrace(profileFilePath))
+		{
+			Info("Wrote profile to %s, %d events dropped", profileFilePath, (uint32_t)utility::GetProfilerDroppedEventCount());
+		}
+		else
+		{
+			Error("Failed to write profile to %s!", profileFilePath);
+		}
+	}
 	EndLog();
 	return 0;
 }
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+
+#define MESH_FILE_MAGIC 0x48534D50//"PMSH" when read as bytes
+#define MESH_FILE_VERSION 1
+#define MESH_FILE_ALIGNMENT 16
+#define MESH_FILE_NO_TEXTURE 0xFFFFFFFF
+#define MESH_FILE_ALIGN(offset) (((offset) + (MESH_FILE_ALIGNMENT - 1)) & ~(uint64_t)(MESH_FILE_ALIGNMENT - 1))
+
+namespace vpl
+{
+	//cooked mesh file layout, every section starts at a MESH_FILE_ALIGNMENT aligned offset
+	//header | submesh table | material table | string table | vertex stream | index stream
+	//the runtime reads the file in one go and uses the streams in place
+
+	enum EMeshTextureSlot : uint32_t
+	{
+		MeshTextureSlot_Diffuse = 0,//albedo
+		MeshTextureSlot_Specular,//roughness
+		MeshTextureSlot_Normal,//normal or bump
+		MeshTextureSlot_Emissive,
+		MeshTextureSlot_Count,
+	};
+
+	struct MeshFileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t submeshCount;
+		uint32_t materialCount;
+		uint64_t submeshTableOffset;
+		uint64_t materialTableOffset;
+		uint64_t stringTableOffset;
+		uint64_t vertexDataOffset;
+		uint64_t indexDataOffset;
+		uint64_t fileSize;
+	};//64 bytes
+
+	//matches the layout of vpl::graphics::Vertex so the stream can be uploaded as is
+	struct MeshFileVertex
+	{
+		float position[3];
+		float normal[3];
+		float tangent[3];
+		float uv[2];
+	};//44 bytes
+
+	struct MeshFileSubmesh
+	{
+		uint64_t vertexOffset;//relative to the start of the file
+		uint64_t indexOffset;//relative to the start of the file
+		uint32_t vertexCount;
+		uint32_t indexCount;//triangle lists, 3 indices per face
+		uint32_t materialIndex;
+		uint32_t padding;
+	};//32 bytes
+
+	struct MeshFileMaterial
+	{
+		float ambient[4];
+		float diffuse[4];
+		float specular[4];
+		float emissive[4];
+		uint32_t texturePaths[MeshTextureSlot_Count];//offsets into the string table, MESH_FILE_NO_TEXTURE if unused
+	};//80 bytes
+}//vpl
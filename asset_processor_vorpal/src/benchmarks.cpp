@@ -0,0 +1,509 @@
+#include "benchmarks.h"
+#include "library_format.h"
+#include "mesh_format.h"
+#include "mesh_converter.h"
+#include "logger.h"
+
+#include "../utility/hash.h"
+#include "../utility/hash_index.h"
+#include "../utility/allocator.h"
+
+#include "assimp/Importer.hpp"
+#include "assimp/Exporter.hpp"
+#include "assimp/scene.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define VERTICES_PER_FACE 3
+
+using namespace vpl;
+using namespace pug::log;
+using namespace std;
+using namespace std::experimental::filesystem;
+
+static uint32_t NextRandom(uint32_t& state)
+{//xorshift32, the same data every run
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+static double GetElapsedNs(chrono::steady_clock::time_point start)
+{
+	return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+}
+
+static double GetElapsedMs(chrono::steady_clock::time_point start)
+{
+	return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+static double GetMedian(vector<double>& samples)
+{
+	sort(samples.begin(), samples.end());
+	return samples[samples.size() / 2];
+}
+
+//the guid the cooker writes for the asset at this relative path
+static void MakeAssetGUID(uint32_t assetIndex, char* out_guid)
+{
+	char path[64];
+	const int length = snprintf(path, sizeof(path), "models/set_%u/asset_%u.fbx", assetIndex / 64, assetIndex);
+	memset(out_guid, 0, LIBRARY_GUID_BYTES);
+	pug::utility::WriteHash128(pug::utility::HashBuffer128(path, (size_t)length), out_guid, LIBRARY_GUID_BYTES);
+}
+
+static int32_t FindEntryLinear(const vector<LibraryAssetEntry>& entries, const char* guid)
+{
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		if (CompareGUID(entries[i].assetGUID, guid) == 0)
+		{
+			return (int32_t)i;
+		}
+	}
+	return -1;
+}
+
+HashIndexBenchmarkResult vpl::RunHashIndexBenchmark(uint32_t entryCount, uint32_t iterationCount)
+{
+	HashIndexBenchmarkResult result = {};
+	result.entryCount = entryCount;
+	result.iterationCount = iterationCount > 0 ? iterationCount : 1;
+
+	//entries in the order they were found, like the library the old librarian scanned
+	vector<LibraryAssetEntry> entries(entryCount);
+	for (uint32_t i = 0; i < entryCount; ++i)
+	{
+		memset(&entries[i], 0, sizeof(LibraryAssetEntry));
+		MakeAssetGUID(i, entries[i].assetGUID);
+		entries[i].type = i;//the position in walk order, checked after every lookup
+	}
+
+	vector<LibraryAssetEntry> sortedEntries = entries;
+	sort(sortedEntries.begin(), sortedEntries.end(), [](const LibraryAssetEntry& a, const LibraryAssetEntry& b)
+	{
+		return CompareGUID(a.assetGUID, b.assetGUID) < 0;
+	});
+	LibraryFileHeader header = {};
+	header.entryCount = entryCount;
+	for (const LibraryAssetEntry& entry : sortedEntries)
+	{
+		++header.fanout[(uint8_t)entry.assetGUID[0]];
+	}
+	for (uint32_t i = 1; i < LIBRARY_FANOUT_SIZE; ++i)
+	{
+		header.fanout[i] += header.fanout[i - 1];
+	}
+
+	pug::utility::HashIndex hashIndex;
+	hashIndex.Initialize(entryCount);
+	for (uint32_t i = 0; i < entryCount; ++i)
+	{
+		hashIndex.Insert(entries[i].assetGUID, i);
+	}
+
+	//random order so neither method gets to walk the entries front to back
+	vector<uint32_t> lookups(HASH_INDEX_BENCHMARK_LOOKUPS);
+	uint32_t randomState = 0x9E3779B9;
+	for (uint32_t& lookup : lookups)
+	{
+		lookup = entryCount > 0 ? NextRandom(randomState) % entryCount : 0;
+	}
+	const uint32_t scanLookupCount = min((uint32_t)HASH_INDEX_BENCHMARK_SCAN_LOOKUPS, (uint32_t)lookups.size());
+
+	vector<double> linearScanSamples, fanoutSearchSamples, hashIndexSamples;
+	for (uint32_t iteration = 0; iteration < result.iterationCount && entryCount > 0; ++iteration)
+	{
+		uint32_t misses = 0;
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		for (uint32_t i = 0; i < scanLookupCount; ++i)
+		{
+			const int32_t index = FindEntryLinear(entries, entries[lookups[i]].assetGUID);
+			misses += index != (int32_t)lookups[i];
+		}
+		linearScanSamples.push_back(GetElapsedNs(start) / scanLookupCount);
+
+		start = chrono::steady_clock::now();
+		for (uint32_t lookup : lookups)
+		{
+			const int32_t index = FindLibraryEntry(header, sortedEntries.data(), entries[lookup].assetGUID);
+			misses += index < 0 || sortedEntries[index].type != lookup;
+		}
+		fanoutSearchSamples.push_back(GetElapsedNs(start) / lookups.size());
+
+		start = chrono::steady_clock::now();
+		for (uint32_t lookup : lookups)
+		{
+			uint32_t value = HASH_INDEX_INVALID_VALUE;
+			misses += !hashIndex.Find(entries[lookup].assetGUID, value) || value != lookup;
+		}
+		hashIndexSamples.push_back(GetElapsedNs(start) / lookups.size());
+		result.missCount = misses;
+	}
+	hashIndex.Destroy();
+
+	if (entryCount > 0)
+	{
+		result.linearScanNs = GetMedian(linearScanSamples);
+		result.fanoutSearchNs = GetMedian(fanoutSearchSamples);
+		result.hashIndexNs = GetMedian(hashIndexSamples);
+	}
+	return result;
+}
+
+void vpl::FormatHashIndexBenchmark(const HashIndexBenchmarkResult& result, char* out_text, size_t textSize)
+{
+	snprintf(out_text, textSize,
+		"Guid lookup, %u entries, median of %u: linear scan %.1fns fanout search %.1fns hash index %.1fns (%.0fx faster than the scan), %u misses",
+		result.entryCount, result.iterationCount, result.linearScanNs, result.fanoutSearchNs, result.hashIndexNs,
+		result.hashIndexNs > 0.0 ? result.linearScanNs / result.hashIndexNs : 0.0, result.missCount);
+}
+
+//the runtime loader before the cooked mesh format, without the materials
+static bool LoadAssbin(const path& assbinPath, MeshLoadBenchmarkResult& out_result)
+{
+	Assimp::Importer importer;
+	const aiScene* scene = importer.ReadFile(assbinPath.string(), 0);
+	if (scene == nullptr)
+	{
+		return false;
+	}
+	out_result.submeshCount = scene->mNumMeshes;
+	out_result.vertexCount = 0;
+	out_result.indexCount = 0;
+	for (uint32_t i = 0; i < scene->mNumMeshes; ++i)
+	{
+		const aiMesh* mesh = scene->mMeshes[i];
+		MeshFileVertex* vertices = (MeshFileVertex*)pug::utility::Allocate(sizeof(MeshFileVertex) * mesh->mNumVertices, 32, pug::utility::MemoryTag_Cooker);
+		uint32_t* indices = (uint32_t*)pug::utility::Allocate(sizeof(uint32_t) * mesh->mNumFaces * VERTICES_PER_FACE, 32, pug::utility::MemoryTag_Cooker);
+		const bool meshHasUVs = (mesh->GetNumUVChannels() >= 1 && mesh->mNumUVComponents[0] >= 2);
+		const bool meshHasTangents = mesh->HasTangentsAndBitangents();
+		for (uint32_t v = 0; v < mesh->mNumVertices; ++v)
+		{
+			MeshFileVertex& vertex = vertices[v];
+			vertex = {};
+			vertex.position[0] = mesh->mVertices[v].x;
+			vertex.position[1] = mesh->mVertices[v].y;
+			vertex.position[2] = mesh->mVertices[v].z;
+			vertex.normal[0] = mesh->mNormals[v].x;
+			vertex.normal[1] = mesh->mNormals[v].y;
+			vertex.normal[2] = mesh->mNormals[v].z;
+			if (meshHasTangents)
+			{
+				vertex.tangent[0] = mesh->mTangents[v].x;
+				vertex.tangent[1] = mesh->mTangents[v].y;
+				vertex.tangent[2] = mesh->mTangents[v].z;
+			}
+			if (meshHasUVs)
+			{
+				vertex.uv[0] = mesh->mTextureCoords[0][v].x;
+				vertex.uv[1] = mesh->mTextureCoords[0][v].y;
+			}
+		}
+		uint32_t indexCount = 0;
+		for (uint32_t f = 0; f < mesh->mNumFaces; ++f)
+		{
+			const aiFace& face = mesh->mFaces[f];
+			if (face.mNumIndices != VERTICES_PER_FACE)
+			{//the mesh file drops these as well
+				continue;
+			}
+			indices[indexCount++] = face.mIndices[0];
+			indices[indexCount++] = face.mIndices[1];
+			indices[indexCount++] = face.mIndices[2];
+		}
+		out_result.vertexCount += mesh->mNumVertices;
+		out_result.indexCount += indexCount;
+		pug::utility::Free(vertices);
+		pug::utility::Free(indices);
+	}
+	return true;
+}
+
+//what LoadMesh does with a cooked mesh file, minus the material tables
+static bool LoadMeshFile(const path& meshFilePath, MeshLoadBenchmarkResult& out_result)
+{
+	const uint64_t fileSize = file_size(meshFilePath);
+	if (fileSize < sizeof(MeshFileHeader))
+	{
+		return false;
+	}
+	fstream meshFile;
+	meshFile.open(meshFilePath, fstream::in | fstream::binary);
+	uint8_t* data = (uint8_t*)pug::utility::Allocate((size_t)fileSize, MESH_FILE_ALIGNMENT, pug::utility::MemoryTag_Cooker);
+	if ((uint64_t)meshFile.read((char*)data, fileSize).gcount() != fileSize)
+	{
+		pug::utility::Free(data);
+		return false;
+	}
+
+	const MeshFileHeader& header = *(const MeshFileHeader*)data;
+	bool valid = header.magic == MESH_FILE_MAGIC && header.version == MESH_FILE_VERSION && header.fileSize == fileSize &&
+		header.submeshTableOffset + sizeof(MeshFileSubmesh) * header.submeshCount <= fileSize;
+	const MeshFileSubmesh* submeshes = (const MeshFileSubmesh*)(data + header.submeshTableOffset);
+	out_result.submeshCount = valid ? header.submeshCount : 0;
+	out_result.vertexCount = 0;
+	out_result.indexCount = 0;
+	for (uint32_t i = 0; valid && i < header.submeshCount; ++i)
+	{
+		const MeshFileSubmesh& submesh = submeshes[i];
+		valid = submesh.vertexOffset + sizeof(MeshFileVertex) * submesh.vertexCount <= header.indexDataOffset &&
+			submesh.indexOffset + sizeof(uint32_t) * submesh.indexCount <= fileSize;
+		out_result.vertexCount += submesh.vertexCount;
+		out_result.indexCount += submesh.indexCount;
+	}
+	pug::utility::Free(data);
+	return valid;
+}
+
+bool vpl::RunMeshLoadBenchmark(
+	const path& scenePath,
+	const path& workDirectory,
+	uint32_t iterationCount,
+	MeshLoadBenchmarkResult& out_result)
+{
+	out_result = MeshLoadBenchmarkResult();
+	out_result.iterationCount = iterationCount > 0 ? iterationCount : 1;
+
+	//the assbin is exported from the same post processed scene the mesh file is written from
+	const path assbinPath = workDirectory / (scenePath.stem().string() + ".assbin");
+	const path meshFilePath = workDirectory / (scenePath.stem().string() + COOKED_MESH_EXTENSION);
+	{
+		Assimp::Importer importer;
+		const aiScene* scene = importer.ReadFile(scenePath.string(), MeshConverter::GetPostProcessingFlags());
+		if (scene == nullptr)
+		{
+			Error("Failed to read mesh file from path: %s", scenePath.string().c_str());
+			return false;
+		}
+		Assimp::Exporter exporter;
+		if (exporter.Export(scene, "assbin", assbinPath.string()) == aiReturn_FAILURE)
+		{
+			Error("Failed to export assbin to path: %s", assbinPath.string().c_str());
+			return false;
+		}
+	}
+	MeshConverter meshConverter;
+	if (meshConverter.CookAsset(scenePath, meshFilePath) != RESULT_OK)
+	{
+		Error("Failed to cook mesh file to path: %s", meshFilePath.string().c_str());
+		return false;
+	}
+	out_result.assbinBytes = file_size(assbinPath);
+	out_result.meshFileBytes = file_size(meshFilePath);
+
+	vector<double> assbinSamples, meshFileSamples;
+	MeshLoadBenchmarkResult assbinCounts = {};
+	bool succeeded = true;
+	for (uint32_t iteration = 0; iteration < out_result.iterationCount && succeeded; ++iteration)
+	{
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		succeeded &= LoadAssbin(assbinPath, assbinCounts);
+		assbinSamples.push_back(GetElapsedMs(start));
+
+		start = chrono::steady_clock::now();
+		succeeded &= LoadMeshFile(meshFilePath, out_result);
+		meshFileSamples.push_back(GetElapsedMs(start));
+	}
+	if (!succeeded)
+	{
+		Error("Failed to load the cooked files back from %s", workDirectory.string().c_str());
+		return false;
+	}
+	if (assbinCounts.vertexCount != out_result.vertexCount || assbinCounts.indexCount != out_result.indexCount)
+	{
+		Warning("The assbin and the mesh file hold different geometry, %d and %d vertices",
+			(uint32_t)assbinCounts.vertexCount, (uint32_t)out_result.vertexCount);
+	}
+	out_result.assbinMs = GetMedian(assbinSamples);
+	out_result.meshFileMs = GetMedian(meshFileSamples);
+	return true;
+}
+
+void vpl::FormatMeshLoadBenchmark(const MeshLoadBenchmarkResult& result, char* out_text, size_t textSize)
+{
+	snprintf(out_text, textSize,
+		"Mesh load, %u submeshes %llu vertices %llu indices, median of %u: assbin %.3fms (%llu bytes) mesh file %.3fms (%llu bytes), %.1fx faster",
+		result.submeshCount, (unsigned long long)result.vertexCount, (unsigned long long)result.indexCount, result.iterationCount,
+		result.assbinMs, (unsigned long long)result.assbinBytes, result.meshFileMs, (unsigned long long)result.meshFileBytes,
+		result.meshFileMs > 0.0 ? result.assbinMs / result.meshFileMs : 0.0);
+}
+
+HashBenchmarkResult vpl::RunHashBenchmark(uint32_t iterationCount)
+{
+	HashBenchmarkResult result = {};
+	result.iterationCount = iterationCount > 0 ? iterationCount : 1;
+	result.pathCount = HASH_BENCHMARK_PATH_COUNT;
+	result.bufferBytes = HASH_BENCHMARK_BUFFER_BYTES;
+
+	vector<string> paths(result.pathCount);
+	uint64_t pathBytes = 0;
+	uint32_t randomState = 0x9E3779B9;
+	for (uint32_t i = 0; i < result.pathCount; ++i)
+	{
+		char path[128];
+		const uint32_t folder = NextRandom(randomState) % 64;
+		snprintf(path, sizeof(path), "textures/environment/set_%u/surface_%u_diffuse.dds", folder, i);
+		paths[i] = path;
+		pathBytes += paths[i].size();
+	}
+	result.averagePathBytes = (uint32_t)(pathBytes / result.pathCount);
+
+	vector<uint8_t> buffer(HASH_BENCHMARK_BUFFER_BYTES);
+	for (size_t i = 0; i + sizeof(uint32_t) <= buffer.size(); i += sizeof(uint32_t))
+	{
+		const uint32_t value = NextRandom(randomState);
+		memcpy(&buffer[i], &value, sizeof(value));
+	}
+
+	vector<double> pathSHA1Samples, pathHash64Samples, pathHash128Samples, bufferSHA1Samples, bufferHash128Samples;
+	uint64_t checksum = 0;
+	for (uint32_t iteration = 0; iteration < result.iterationCount; ++iteration)
+	{
+		char digest[SHA1_HASH_BYTES];
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		for (const string& path : paths)
+		{
+			pug::utility::SHA1(path, digest, sizeof(digest));
+			checksum += (uint8_t)digest[0];
+		}
+		pathSHA1Samples.push_back(GetElapsedNs(start) / result.pathCount);
+
+		start = chrono::steady_clock::now();
+		for (const string& path : paths)
+		{
+			checksum += pug::utility::HashBuffer64(path.data(), path.size());
+		}
+		pathHash64Samples.push_back(GetElapsedNs(start) / result.pathCount);
+
+		start = chrono::steady_clock::now();
+		for (const string& path : paths)
+		{
+			checksum += pug::utility::HashBuffer128(path.data(), path.size()).high;
+		}
+		pathHash128Samples.push_back(GetElapsedNs(start) / result.pathCount);
+
+		start = chrono::steady_clock::now();
+		pug::utility::SHA1State sha1State;
+		pug::utility::SHA1Init(sha1State);
+		pug::utility::SHA1Update(sha1State, buffer.data(), buffer.size());
+		pug::utility::SHA1Final(sha1State, digest, sizeof(digest));
+		checksum += (uint8_t)digest[0];
+		bufferSHA1Samples.push_back(GetElapsedNs(start));
+
+		start = chrono::steady_clock::now();
+		checksum += pug::utility::HashBuffer128(buffer.data(), buffer.size()).low;
+		bufferHash128Samples.push_back(GetElapsedNs(start));
+	}
+
+	result.pathSHA1Ns = GetMedian(pathSHA1Samples);
+	result.pathHash64Ns = GetMedian(pathHash64Samples);
+	result.pathHash128Ns = GetMedian(pathHash128Samples);
+	//bytes per nanosecond are gigabytes per second
+	result.bufferSHA1GBs = result.bufferBytes / GetMedian(bufferSHA1Samples);
+	result.bufferHash128GBs = result.bufferBytes / GetMedian(bufferHash128Samples);
+	result.checksum = checksum;
+	return result;
+}
+
+void vpl::FormatHashBenchmark(const HashBenchmarkResult& result, char* out_text, size_t textSize)
+{
+	snprintf(out_text, textSize,
+		"Path hashing, %u paths of %u bytes on average, median of %u: SHA1 %.1fns Hash64 %.1fns Hash128 %.1fns per path\n"
+		"Buffer hashing, %llu MB: SHA1 %.2fGB/s Hash128 %.2fGB/s (checksum %llx)",
+		result.pathCount, result.averagePathBytes, result.iterationCount, result.pathSHA1Ns, result.pathHash64Ns, result.pathHash128Ns,
+		(unsigned long long)(result.bufferBytes / (1024 * 1024)), result.bufferSHA1GBs, result.bufferHash128GBs,
+		(unsigned long long)result.checksum);
+}
+
+void vpl::RunLogBenchmark(uint32_t threadCount, const path& scratchFilePath, LogBenchmarkResult& out_result)
+{
+	out_result.threadCount = min(max(threadCount, 1u), (uint32_t)LOG_BENCHMARK_MAX_THREADS);
+	out_result.callsPerThread = LOG_BENCHMARK_CALLS_PER_THREAD;
+	out_result.binaryLog = IsBinaryLogEnabled();
+	out_result.logLatency.Reset();
+	out_result.flushedLatency.Reset();
+	FlushLog();
+
+	fstream scratchFile;
+	scratchFile.open(scratchFilePath, fstream::out | fstream::trunc);
+	mutex scratchFileLock;
+
+	vector<pug::utility::LatencyHistogram> logLatencies(out_result.threadCount);
+	vector<pug::utility::LatencyHistogram> flushedLatencies(out_result.threadCount);
+	atomic<uint32_t> readyCount(0);
+	vector<thread> threads;
+	for (uint32_t threadIndex = 0; threadIndex < out_result.threadCount; ++threadIndex)
+	{
+		threads.emplace_back([&, threadIndex]()
+		{
+			//start together so the producers actually contend for the queue
+			readyCount.fetch_add(1);
+			while (readyCount.load() < out_result.threadCount)
+			{
+				this_thread::yield();
+			}
+			//the old way first, the writer thread would otherwise catch up while it runs
+			for (uint32_t i = 0; i < out_result.callsPerThread; ++i)
+			{
+				const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+				char line[128];
+				const int length = snprintf(line, sizeof(line), "Log benchmark line %u from thread %u of %s\n", i, threadIndex, "the cooker");
+				{
+					lock_guard<mutex> lock(scratchFileLock);
+					scratchFile.write(line, length);
+					scratchFile.flush();
+				}
+				flushedLatencies[threadIndex].Record((uint64_t)GetElapsedNs(start));
+			}
+			for (uint32_t i = 0; i < out_result.callsPerThread; ++i)
+			{
+				const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+				PUG_LOG("Log benchmark line %d from thread %d of %s", i, threadIndex, "the cooker");
+				logLatencies[threadIndex].Record((uint64_t)GetElapsedNs(start));
+			}
+		});
+	}
+	for (thread& benchmarkThread : threads)
+	{
+		benchmarkThread.join();
+	}
+
+	const chrono::steady_clock::time_point drainStart = chrono::steady_clock::now();
+	FlushLog();
+	out_result.drainMs = GetElapsedMs(drainStart);
+
+	for (uint32_t i = 0; i < out_result.threadCount; ++i)
+	{
+		out_result.logLatency.Merge(logLatencies[i]);
+		out_result.flushedLatency.Merge(flushedLatencies[i]);
+	}
+	scratchFile.close();
+	remove(scratchFilePath);
+}
+
+void vpl::FormatLogBenchmark(const LogBenchmarkResult& result, char* out_text, size_t textSize)
+{
+	const pug::utility::LatencyHistogram& log = result.logLatency;
+	const pug::utility::LatencyHistogram& flushed = result.flushedLatency;
+	snprintf(out_text, textSize,
+		"Log calls, %u threads with %u calls each, %s log, in ns:\n"
+		"  PUG_LOG        p50 %llu p99 %llu p99.9 %llu max %llu mean %.0f, drained in %.3fms\n"
+		"  write + flush  p50 %llu p99 %llu p99.9 %llu max %llu mean %.0f",
+		result.threadCount, result.callsPerThread, result.binaryLog ? "binary" : "text",
+		(unsigned long long)log.GetPercentile(50.0), (unsigned long long)log.GetPercentile(99.0),
+		(unsigned long long)log.GetPercentile(99.9), (unsigned long long)log.GetMax(), log.GetMean(), result.drainMs,
+		(unsigned long long)flushed.GetPercentile(50.0), (unsigned long long)flushed.GetPercentile(99.0),
+		(unsigned long long)flushed.GetPercentile(99.9), (unsigned long long)flushed.GetMax(), flushed.GetMean());
+}
@@ -0,0 +1,162 @@
+#include "cook_cache.h"
+#include "asset_converter.h"
+#include "logger.h"
+
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+
+#define CONTENT_KEY_CHUNK_SIZE (64 * 1024)
+
+using namespace vpl;
+using namespace pug;
+using namespace pug::log;
+using namespace std;
+using namespace std::experimental::filesystem;
+
+CookCache::CookCache()
+	: m_hitCount(0)
+	, m_missCount(0)
+{
+
+}
+
+CookCache::~CookCache()
+{
+
+}
+
+bool CookCache::Load(const path& cacheFilePath)
+{
+	m_previousEntries.clear();
+	m_previousIndex.Clear();
+	if (!exists(cacheFilePath))
+	{//first cook, everything is a miss
+		return true;
+	}
+
+	fstream cacheFile;
+	cacheFile.open(cacheFilePath, fstream::in | fstream::binary);
+	if (!cacheFile.is_open())
+	{
+		Warning("Failed to open cook cache %s, all assets will be cooked", cacheFilePath.string().c_str());
+		return false;
+	}
+
+	FileHeader header = {};
+	if (!cacheFile.read((char*)&header, sizeof(header)) ||
+		header.magic != COOK_CACHE_MAGIC ||
+		header.version != COOK_CACHE_VERSION ||
+		header.entrySize != sizeof(Entry))
+	{
+		Warning("Cook cache %s is invalid or outdated, all assets will be cooked", cacheFilePath.string().c_str());
+		return false;
+	}
+
+	//checked before anything is allocated, a corrupt count could ask for up to 4G entries
+	std::error_code sizeError;
+	const uintmax_t fileSize = file_size(cacheFilePath, sizeError);
+	if (sizeError || fileSize < sizeof(header) || (uint64_t)header.entryCount * sizeof(Entry) > fileSize - sizeof(header))
+	{
+		Warning("Cook cache %s is truncated, all assets will be cooked", cacheFilePath.string().c_str());
+		return false;
+	}
+
+	m_previousEntries.resize(header.entryCount);
+	if (!cacheFile.read((char*)m_previousEntries.data(), sizeof(Entry) * header.entryCount))
+	{
+		Warning("Cook cache %s is truncated, all assets will be cooked", cacheFilePath.string().c_str());
+		m_previousEntries.clear();
+		return false;
+	}
+
+	m_previousIndex.Initialize(header.entryCount);
+	for (uint32_t i = 0; i < header.entryCount; ++i)
+	{
+		m_previousIndex.Insert(m_previousEntries[i].assetGUID, i);
+	}
+	return true;
+}
+
+bool CookCache::Save(const path& cacheFilePath)
+{
+	//sorted so the cache file does not depend on the order the cook threads finished in
+	sort(m_entries.begin(), m_entries.end(), [](const Entry& a, const Entry& b)
+	{
+		return memcmp(a.assetGUID, b.assetGUID, sizeof(a.assetGUID)) < 0;
+	});
+
+	fstream cacheFile;
+	cacheFile.open(cacheFilePath, fstream::out | fstream::binary | fstream::trunc);
+	if (!cacheFile.is_open())
+	{
+		Error("Failed to open cook cache %s for writing!", cacheFilePath.string().c_str());
+		return false;
+	}
+
+	FileHeader header = {};
+	header.magic = COOK_CACHE_MAGIC;
+	header.version = COOK_CACHE_VERSION;
+	header.entryCount = (uint32_t)m_entries.size();
+	header.entrySize = sizeof(Entry);
+	if (!cacheFile.write((char*)&header, sizeof(header)) ||
+		!cacheFile.write((char*)m_entries.data(), sizeof(Entry) * m_entries.size()))
+	{
+		Error("Failed to write cook cache %s!", cacheFilePath.string().c_str());
+		return false;
+	}
+	return true;
+}
+
+bool CookCache::ComputeContentKey(
+	const path& absoluteRawAssetPath,
+	const AssetConverter& converter,
+	char* out_contentKey)
+{
+	fstream sourceFile;
+	sourceFile.open(absoluteRawAssetPath, fstream::in | fstream::binary);
+	if (!sourceFile.is_open())
+	{
+		return false;
+	}
+
+	utility::Hash128State state;
+	utility::Hash128Init(state);
+	char chunk[CONTENT_KEY_CHUNK_SIZE];
+	while (sourceFile.read(chunk, sizeof(chunk)) || sourceFile.gcount() > 0)
+	{
+		utility::Hash128Update(state, chunk, (size_t)sourceFile.gcount());
+	}
+	if (sourceFile.bad())
+	{
+		return false;
+	}
+
+	const char* converterName = converter.GetName();
+	utility::Hash128Update(state, converterName, strlen(converterName));
+	uint64_t settingsVersion = converter.GetSettingsVersion();
+	utility::Hash128Update(state, &settingsVersion, sizeof(settingsVersion));
+
+	utility::WriteHash128(utility::Hash128Final(state), out_contentKey, HASH128_BYTES);
+	return true;
+}
+
+bool CookCache::IsUpToDate(const char* assetGUID, const char* contentKey) const
+{
+	uint32_t index = 0;
+	if (!m_previousIndex.Find(assetGUID, index))
+	{
+		return false;
+	}
+	return memcmp(m_previousEntries[index].contentKey, contentKey, HASH128_BYTES) == 0;
+}
+
+void CookCache::Store(const char* assetGUID, const char* contentKey)
+{
+	Entry entry;
+	memcpy(entry.assetGUID, assetGUID, sizeof(entry.assetGUID));
+	memcpy(entry.contentKey, contentKey, sizeof(entry.contentKey));
+
+	lock_guard<mutex> lock(m_entriesLock);
+	m_entries.push_back(entry);
+}
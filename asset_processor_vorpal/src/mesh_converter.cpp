@@ -1,31 +1,240 @@
 #include "mesh_converter.h"
+#include "mesh_format.h"
 #include "logger.h"
+#include "../utility/profiler.h"
+#include "../utility/allocator.h"
 
 #include "assimp/Importer.hpp"
-#include "assimp/Exporter.hpp"
+#include "assimp/scene.h"
 #include "assimp/postprocess.h"
 
 #include "Assimp/DefaultLogger.hpp"
 #include "Assimp/Logger.hpp"
 
 #include <experimental\filesystem>
+#include <fstream>
+#include <vector>
+#include <string>
+
+#define VERTICES_PER_FACE 3
 
 using namespace vpl;
 using namespace pug::log;
 using namespace Assimp;
+using namespace std;
 using namespace std::experimental::filesystem;
 
+uint32_t MeshConverter::GetPostProcessingFlags()
+{
+	uint32_t postProcessingFlags = 0;
+	postProcessingFlags |= aiProcess_CalcTangentSpace;
+	postProcessingFlags |= aiProcess_JoinIdenticalVertices;
+	postProcessingFlags |= aiProcess_ConvertToLeftHanded;
+	postProcessingFlags |= aiProcess_Triangulate;
+	postProcessingFlags |= aiProcess_RemoveComponent;
+	postProcessingFlags |= aiProcess_GenNormals;
+	postProcessingFlags |= aiProcess_ValidateDataStructure;
+	postProcessingFlags |= aiProcess_ImproveCacheLocality;
+	postProcessingFlags |= aiProcess_FixInfacingNormals;
+	postProcessingFlags |= aiProcess_FindDegenerates;
+	postProcessingFlags |= aiProcess_FindInvalidData;
+	postProcessingFlags |= aiProcess_GenUVCoords;
+	postProcessingFlags |= aiProcess_FindInstances;
+	postProcessingFlags |= aiProcess_OptimizeMeshes;
+	postProcessingFlags |= aiProcess_OptimizeGraph;
+	return postProcessingFlags;
+}
+
+static void CopyColor(const aiColor3D& color, float alpha, float* out_color)
+{
+	out_color[0] = color.r;
+	out_color[1] = color.g;
+	out_color[2] = color.b;
+	out_color[3] = alpha;
+}
+
+static uint32_t AddString(vector<char>& stringTable, const char* string)
+{
+	uint32_t offset = (uint32_t)stringTable.size();
+	stringTable.insert(stringTable.end(), string, string + strlen(string) + 1);
+	return offset;
+}
+
+static void ConvertMaterial(const aiMaterial* material, vector<char>& stringTable, MeshFileMaterial& out_material)
+{
+	aiColor3D diffuse, ambient, emissive, specular;
+	float shininessStrength = 1.0f;
+
+	material->Get(AI_MATKEY_COLOR_DIFFUSE, diffuse);
+	material->Get(AI_MATKEY_COLOR_AMBIENT, ambient);
+	material->Get(AI_MATKEY_COLOR_SPECULAR, specular);
+	material->Get(AI_MATKEY_COLOR_EMISSIVE, emissive);
+	material->Get(AI_MATKEY_SHININESS_STRENGTH, shininessStrength);
+
+	CopyColor(aiColor3D(1.0f), 1.0f, out_material.ambient);
+	CopyColor(diffuse, 1.0f, out_material.diffuse);
+	CopyColor(specular * shininessStrength, 1.0f, out_material.specular);
+	CopyColor(emissive, 1.0f, out_material.emissive);
+	for (uint32_t i = 0; i < MeshTextureSlot_Count; ++i)
+	{
+		out_material.texturePaths[i] = MESH_FILE_NO_TEXTURE;
+	}
+
+	aiString texturePath;
+	for (size_t tt = (size_t)(aiTextureType_DIFFUSE); tt < (size_t)(aiTextureType_UNKNOWN); ++tt)
+	{
+		for (size_t t = 0; t < material->GetTextureCount((aiTextureType)tt); ++t)
+		{
+			material->GetTexture((aiTextureType)tt, (unsigned int)t, &texturePath);
+			switch (tt)
+			{
+			case (size_t)aiTextureType_DIFFUSE:
+				out_material.texturePaths[MeshTextureSlot_Diffuse] = AddString(stringTable, texturePath.C_Str());
+				CopyColor(aiColor3D(1.0f), 1.0f, out_material.diffuse);
+				break;
+			case (size_t)aiTextureType_SPECULAR:
+				out_material.texturePaths[MeshTextureSlot_Specular] = AddString(stringTable, texturePath.C_Str());
+				CopyColor(aiColor3D(1.0f), 1.0f, out_material.specular);
+				break;
+			case (size_t)aiTextureType_NORMALS:
+			case (size_t)aiTextureType_HEIGHT:
+				out_material.texturePaths[MeshTextureSlot_Normal] = AddString(stringTable, texturePath.C_Str());
+				break;
+			case (size_t)aiTextureType_EMISSIVE:
+				out_material.texturePaths[MeshTextureSlot_Emissive] = AddString(stringTable, texturePath.C_Str());
+				CopyColor(aiColor3D(1.0f), 1.0f, out_material.emissive);
+				break;
+			case (size_t)aiTextureType_AMBIENT:
+				//Info("Loading of ambient maps is not supported!");
+				break;
+			default:
+				PUG_WARNING("Unsupported texture type! path: %s", texturePath.C_Str());
+				break;
+			}
+		}
+	}
+}
+
+//flatten the imported scene into the cooked mesh layout described in mesh_format.h
+static bool WriteMeshFile(const aiScene* scene, const path& outputPath)
+{
+	vector<MeshFileSubmesh> submeshes(scene->mNumMeshes);
+	vector<MeshFileMaterial> materials(scene->mNumMaterials);
+	vector<char> stringTable;
+	vector<MeshFileVertex> vertices;
+	vector<uint32_t> indices;
+
+	for (uint32_t i = 0; i < scene->mNumMaterials; ++i)
+	{
+		ConvertMaterial(scene->mMaterials[i], stringTable, materials[i]);
+	}
+
+	//vertex and index offsets are relative to their stream for now, fixed up once the layout is known
+	for (uint32_t i = 0; i < scene->mNumMeshes; ++i)
+	{
+		const aiMesh* mesh = scene->mMeshes[i];
+		const bool meshHasUVs = (mesh->GetNumUVChannels() >= 1 && mesh->mNumUVComponents[0] >= 2);
+		const bool meshHasTangents = mesh->HasTangentsAndBitangents();
+
+		MeshFileSubmesh& submesh = submeshes[i];
+		submesh.vertexOffset = vertices.size() * sizeof(MeshFileVertex);
+		submesh.indexOffset = indices.size() * sizeof(uint32_t);
+		submesh.vertexCount = mesh->mNumVertices;
+		submesh.materialIndex = mesh->mMaterialIndex;
+		submesh.padding = 0;
+
+		for (uint32_t v = 0; v < mesh->mNumVertices; ++v)
+		{
+			MeshFileVertex vertex = {};
+			vertex.position[0] = mesh->mVertices[v].x;
+			vertex.position[1] = mesh->mVertices[v].y;
+			vertex.position[2] = mesh->mVertices[v].z;
+			vertex.normal[0] = mesh->mNormals[v].x;
+			vertex.normal[1] = mesh->mNormals[v].y;
+			vertex.normal[2] = mesh->mNormals[v].z;
+			if (meshHasTangents)
+			{//prevent reading from empty tangent array
+				vertex.tangent[0] = mesh->mTangents[v].x;
+				vertex.tangent[1] = mesh->mTangents[v].y;
+				vertex.tangent[2] = mesh->mTangents[v].z;
+			}
+			if (meshHasUVs)
+			{
+				vertex.uv[0] = mesh->mTextureCoords[0][v].x;
+				vertex.uv[1] = mesh->mTextureCoords[0][v].y;
+			}
+			vertices.push_back(vertex);
+		}
+
+		for (uint32_t f = 0; f < mesh->mNumFaces; ++f)
+		{
+			const aiFace& face = mesh->mFaces[f];
+			if (face.mNumIndices != VERTICES_PER_FACE)
+			{//points and lines survive triangulation, the runtime only draws triangle lists
+				continue;
+			}
+			indices.push_back(face.mIndices[0]);
+			indices.push_back(face.mIndices[1]);
+			indices.push_back(face.mIndices[2]);
+		}
+		submesh.indexCount = (uint32_t)(indices.size() - submesh.indexOffset / sizeof(uint32_t));
+
+		//keep every submesh stream aligned
+		while ((vertices.size() * sizeof(MeshFileVertex)) % MESH_FILE_ALIGNMENT != 0)
+		{
+			vertices.push_back({});
+		}
+		while ((indices.size() * sizeof(uint32_t)) % MESH_FILE_ALIGNMENT != 0)
+		{
+			indices.push_back(0);
+		}
+	}
+
+	MeshFileHeader header = {};
+	header.magic = MESH_FILE_MAGIC;
+	header.version = MESH_FILE_VERSION;
+	header.submeshCount = (uint32_t)submeshes.size();
+	header.materialCount = (uint32_t)materials.size();
+	header.submeshTableOffset = MESH_FILE_ALIGN(sizeof(MeshFileHeader));
+	header.materialTableOffset = MESH_FILE_ALIGN(header.submeshTableOffset + sizeof(MeshFileSubmesh) * submeshes.size());
+	header.stringTableOffset = MESH_FILE_ALIGN(header.materialTableOffset + sizeof(MeshFileMaterial) * materials.size());
+	header.vertexDataOffset = MESH_FILE_ALIGN(header.stringTableOffset + stringTable.size());
+	header.indexDataOffset = MESH_FILE_ALIGN(header.vertexDataOffset + sizeof(MeshFileVertex) * vertices.size());
+	header.fileSize = MESH_FILE_ALIGN(header.indexDataOffset + sizeof(uint32_t) * indices.size());
+
+	for (MeshFileSubmesh& submesh : submeshes)
+	{
+		submesh.vertexOffset += header.vertexDataOffset;
+		submesh.indexOffset += header.indexDataOffset;
+	}
+
+	//assemble the whole file in memory and write it in one go
+	vector<uint8_t> file((size_t)header.fileSize, 0);
+	memcpy(file.data(), &header, sizeof(header));
+	memcpy(file.data() + header.submeshTableOffset, submeshes.data(), sizeof(MeshFileSubmesh) * submeshes.size());
+	memcpy(file.data() + header.materialTableOffset, materials.data(), sizeof(MeshFileMaterial) * materials.size());
+	memcpy(file.data() + header.stringTableOffset, stringTable.data(), stringTable.size());
+	memcpy(file.data() + header.vertexDataOffset, vertices.data(), sizeof(MeshFileVertex) * vertices.size());
+	memcpy(file.data() + header.indexDataOffset, indices.data(), sizeof(uint32_t) * indices.size());
+
+	fstream outputFile;
+	outputFile.open(outputPath, fstream::out | fstream::binary | fstream::trunc);
+	if (!outputFile.is_open())
+	{
+		return false;
+	}
+	return (bool)outputFile.write((const char*)file.data(), file.size());
+}
+
 MeshConverter::MeshConverter()
-	: m_importer(new Importer())
-	, m_exporter(new Exporter())
+	: m_importer(pug::utility::New<Importer>(pug::utility::MemoryTag_Cooker))
 {
 
 }
 
 MeshConverter::~MeshConverter()
 {
-	delete m_exporter;
-	delete m_importer;
+	pug::utility::Delete(m_importer);
 }
 
 bool MeshConverter::IsExtensionSupported(const path& extension) const
@@ -33,26 +242,17 @@ bool MeshConverter::IsExtensionSupported(const path& extension) const
 	return m_importer->IsExtensionSupported(extension.string());
 }
 
+uint64_t MeshConverter::GetSettingsVersion() const
+{//changing the post processing flags invalidates every cooked mesh
+	return ((uint64_t)MESH_CONVERTER_VERSION << 32) | GetPostProcessingFlags();
+}
+
 uint32_t MeshConverter::CookAsset(
 	const path& absoluteRawAssetInputPath, 
 	const path& absoluteCookedAssetOutputPath) const
 {
-	uint32_t postProcessingFlags = 0;
-	postProcessingFlags |= aiProcess_CalcTangentSpace;
-	postProcessingFlags |= aiProcess_JoinIdenticalVertices;
-	postProcessingFlags |= aiProcess_ConvertToLeftHanded;
-	postProcessingFlags |= aiProcess_Triangulate;
-	postProcessingFlags |= aiProcess_RemoveComponent;
-	postProcessingFlags |= aiProcess_GenNormals;
-	postProcessingFlags |= aiProcess_ValidateDataStructure;
-	postProcessingFlags |= aiProcess_ImproveCacheLocality;
-	postProcessingFlags |= aiProcess_FixInfacingNormals;
-	postProcessingFlags |= aiProcess_FindDegenerates;
-	postProcessingFlags |= aiProcess_FindInvalidData;
-	postProcessingFlags |= aiProcess_GenUVCoords;
-	postProcessingFlags |= aiProcess_FindInstances;
-	postProcessingFlags |= aiProcess_OptimizeMeshes;
-	postProcessingFlags |= aiProcess_OptimizeGraph;
+	PUG_PROFILE_SCOPE("MeshConverter::CookAsset");
+	uint32_t postProcessingFlags = GetPostProcessingFlags();
 
 	if (!m_importer->ValidateFlags(postProcessingFlags))
 	{
@@ -65,17 +265,19 @@ uint32_t MeshConverter::CookAsset(
 	const aiScene* scene = m_importer->ReadFile(absoluteRawAssetInputPath.string(), postProcessingFlags);
 	if (!scene)
 	{
-		Log("Failed to read mesh file from path: %s", absoluteRawAssetInputPath.string());
+		PUG_LOG("Failed to read mesh file from path: %s", absoluteRawAssetInputPath.string());
 		return RESULT_FAILED;
 	}
 
-	if (m_exporter->Export(scene, "assbin", absoluteCookedAssetOutputPath.string()) == aiReturn::aiReturn_FAILURE)
+	if (!WriteMeshFile(scene, absoluteCookedAssetOutputPath))
 	{
-		Log("Failed to export mesh to path: %s", absoluteCookedAssetOutputPath.string());
+		PUG_LOG("Failed to export mesh to path: %s", absoluteCookedAssetOutputPath.string());
+		m_importer->FreeScene();
 		return RESULT_FAILED;
 	}
 
 	//Assimp::DefaultLogger::delete();
 
+	m_importer->FreeScene();
 	return RESULT_OK;
 }
\ No newline at end of file
@@ -0,0 +1,216 @@
+#include "self_test.h"
+#include "logger.h"
+
+#include "../utility/hash.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace vpl;
+using namespace pug::log;
+using namespace std;
+using namespace std::experimental::filesystem;
+
+//FIPS 180 examples and the usual extra vectors, digests as sha1sum prints them
+struct SHA1TestVector
+{
+	const char* message;
+	uint32_t repeatCount;
+	const char* digest;
+};
+
+static const SHA1TestVector g_sha1TestVectors[] =
+{
+	{ "", 1, "da39a3ee5e6b4b0d3255bfef95601890afd80709" },
+	{ "abc", 1, "a9993e364706816aba3e25717850c26c9cd0d89d" },
+	{ "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1, "84983e441c3bd26ebaae4aa1f95129e5e54670f1" },//448 bits, the length spills into a second block
+	{ "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", 1, "a49b2446a02c645bf419f995b67091253a04a259" },
+	{ "The quick brown fox jumps over the lazy dog", 1, "2fd4e1c67a2d28fced849ee1bb76e7391b93eb12" },
+	{ "a", 1000000, "34aa973cd4c4daa4f61eeb2bdbad27316534016f" },
+};
+
+//digests of the original string hash, the legacy guids of version 1 and 2 libraries, with the words in big endian order
+//only the first 64 bytes of a string reach these, the last two paths share them and their guid
+static const SHA1TestVector g_legacyGUIDTestVectors[] =
+{
+	{ "abc", 1, "a9993e364706816aba3e25717850c26c9cd0d89d" },
+	{ "textures/environment/set_12/surface_00417_diffuse_a.dds", 1, "703373dadf12b727695ed4310d33916628642cf4" },
+	{ "models/environment/castle_courtyard/props/crate_large_01.fbx", 1, "d47a7980ccff882149c66caa42d6573edba23981" },
+	{ "models/environment/castle_courtyard/props/crate_large_000001.fbx", 1, "00ef8a6f952466ea1ec1d30e57173eb59e77b610" },
+	{ "models/environment/castle_courtyard/props/wooden_crate_large_damaged.fbx", 1, "17c9e618544fa086c0a9748092304669a6a80d8f" },
+	{ "models/environment/castle_courtyard/props/wooden_crate_large_damaged.fbx/materials/wood_planks_weathered_albedo_roughness_2k.dds", 1, "17c9e618544fa086c0a9748092304669a6a80d8f" },
+};
+
+static void FormatDigest(const char* digest, char* out_text)
+{
+	for (uint32_t i = 0; i < SHA1_HASH_BYTES; ++i)
+	{
+		snprintf(out_text + i * 2, 3, "%02x", (uint8_t)digest[i]);
+	}
+}
+
+static bool CheckDigest(const char* digest, const char* expected, const char* check, const char* message)
+{
+	char text[SHA1_HASH_BYTES * 2 + 1];
+	FormatDigest(digest, text);
+	if (strcmp(text, expected) != 0)
+	{
+		Warning("SHA1 self test failed: %s of \"%s\" gave %s, expected %s", check, string(message).substr(0, 16).c_str(), text, expected);
+		return false;
+	}
+	return true;
+}
+
+//the message handed to SHA1Update in pieces of chunkSize bytes, 0 hands it over in one call
+static void HashInChunks(const string& message, size_t chunkSize, char* out_digest)
+{
+	pug::utility::SHA1State state;
+	pug::utility::SHA1Init(state);
+	if (chunkSize == 0)
+	{
+		pug::utility::SHA1Update(state, message.data(), message.size());
+	}
+	for (size_t offset = 0; chunkSize > 0 && offset < message.size(); offset += chunkSize)
+	{
+		pug::utility::SHA1Update(state, message.data() + offset, min(chunkSize, message.size() - offset));
+	}
+	pug::utility::SHA1Final(state, out_digest, SHA1_HASH_BYTES);
+}
+
+static uint32_t RunSHA1VectorChecks()
+{
+	uint32_t failedCount = 0;
+	//odd sizes cross the block boundaries at every offset, 64 is exactly one block
+	const size_t chunkSizes[] = { 0, 1, 3, 7, 63, 64, 65, 1000 };
+	char digest[SHA1_HASH_BYTES];
+	for (const SHA1TestVector& vector : g_sha1TestVectors)
+	{
+		string message;
+		message.reserve(strlen(vector.message) * vector.repeatCount);
+		for (uint32_t i = 0; i < vector.repeatCount; ++i)
+		{
+			message += vector.message;
+		}
+		for (size_t chunkSize : chunkSizes)
+		{
+			if (chunkSize == 1 && message.size() > 1000)
+			{//a million single byte updates only take long, 3 already covers every offset
+				continue;
+			}
+			char check[32];
+			snprintf(check, sizeof(check), "updates of %u bytes", (uint32_t)chunkSize);
+			HashInChunks(message, chunkSize, digest);
+			failedCount += !CheckDigest(digest, vector.digest, chunkSize == 0 ? "one update" : check, vector.message);
+		}
+	}
+
+	//SHA1Final leaves the state alone, hashing can go on after it
+	pug::utility::SHA1State state;
+	pug::utility::SHA1Init(state);
+	pug::utility::SHA1Update(state, "ab", 2);
+	pug::utility::SHA1Final(state, digest, sizeof(digest));
+	pug::utility::SHA1Update(state, "c", 1);
+	pug::utility::SHA1Final(state, digest, sizeof(digest));
+	failedCount += !CheckDigest(digest, g_sha1TestVectors[1].digest, "updates after SHA1Final", g_sha1TestVectors[1].message);
+
+	//the legacy guid hash stores the digest words in host order, version 1 and 2 libraries depend on it
+	const uint16_t byteOrderProbe = 1;
+	for (const SHA1TestVector& vector : g_legacyGUIDTestVectors)
+	{
+		pug::utility::SHA1(vector.message, digest, sizeof(digest));
+		if (*(const uint8_t*)&byteOrderProbe == 1)
+		{
+			for (uint32_t word = 0; word < SHA1_HASH_BYTES / 4; ++word)
+			{
+				swap(digest[word * 4 + 0], digest[word * 4 + 3]);
+				swap(digest[word * 4 + 1], digest[word * 4 + 2]);
+			}
+		}
+		failedCount += !CheckDigest(digest, vector.digest, "the legacy guid hash", vector.message);
+	}
+	return failedCount;
+}
+
+static uint32_t RunHashFileChecks(const path& workDirectory)
+{
+	uint32_t failedCount = 0;
+	char digest[SHA1_HASH_BYTES];
+	char expectedDigest[SHA1_HASH_BYTES];
+	char expectedText[SHA1_HASH_BYTES * 2 + 1];
+
+	string content(SELF_TEST_FILE_BYTES, '\0');
+	uint32_t randomState = 0x9E3779B9;
+	for (char& c : content)
+	{//xorshift32
+		randomState ^= randomState << 13;
+		randomState ^= randomState >> 17;
+		randomState ^= randomState << 5;
+		c = (char)randomState;
+	}
+	HashInChunks(content, 0, expectedDigest);
+	FormatDigest(expectedDigest, expectedText);
+
+	const path filePath = workDirectory / "sha1_self_test.bin";
+	const path emptyFilePath = workDirectory / "sha1_self_test_empty.bin";
+	{
+		fstream file;
+		file.open(filePath, fstream::out | fstream::binary | fstream::trunc);
+		file.write(content.data(), content.size());
+		fstream emptyFile;
+		emptyFile.open(emptyFilePath, fstream::out | fstream::binary | fstream::trunc);
+		if (!file || !emptyFile)
+		{
+			Warning("SHA1 self test failed: could not write the test files to %s", workDirectory.string().c_str());
+			return 1;
+		}
+	}
+
+	if (!pug::utility::HashFile(filePath.string().c_str(), digest, sizeof(digest)))
+	{
+		Warning("SHA1 self test failed: HashFile could not read %s", filePath.string().c_str());
+		++failedCount;
+	}
+	else
+	{
+		failedCount += !CheckDigest(digest, expectedText, "HashFile", "random file");
+	}
+	//an empty file can not be mapped, it goes through the buffered read
+	if (!pug::utility::HashFile(emptyFilePath.string().c_str(), digest, sizeof(digest)))
+	{
+		Warning("SHA1 self test failed: HashFile could not read %s", emptyFilePath.string().c_str());
+		++failedCount;
+	}
+	else
+	{
+		failedCount += !CheckDigest(digest, g_sha1TestVectors[0].digest, "HashFile", "empty file");
+	}
+	if (pug::utility::HashFile((workDirectory / "sha1_self_test_missing.bin").string().c_str(), digest, sizeof(digest)))
+	{
+		Warning("SHA1 self test failed: HashFile succeeded on a missing file");
+		++failedCount;
+	}
+
+	remove(filePath);
+	remove(emptyFilePath);
+	return failedCount;
+}
+
+uint32_t vpl::RunSHA1SelfTest(const path& workDirectory)
+{
+	uint32_t failedCount = 0;
+	const bool hardwareEnabled = pug::utility::IsSHA1HardwareEnabled();
+	if (hardwareEnabled)
+	{
+		failedCount += RunSHA1VectorChecks();
+		failedCount += RunHashFileChecks(workDirectory);
+		pug::utility::SetSHA1HardwareEnabled(false);
+	}
+	Info("SHA1 self test: sha extensions %s", hardwareEnabled ? "checked" : "not available");
+	failedCount += RunSHA1VectorChecks();
+	failedCount += RunHashFileChecks(workDirectory);
+	pug::utility::SetSHA1HardwareEnabled(true);
+	return failedCount;
+}
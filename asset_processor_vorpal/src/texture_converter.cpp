@@ -1,5 +1,6 @@
 #include "texture_converter.h"
 #include "texconv/texconv.h"
+#include "../utility/profiler.h"
 
 #include <algorithm>
 
@@ -34,6 +35,7 @@ uint32_t TextureConverter::CookAsset(
 	const std::experimental::filesystem::path& asset,
 	const std::experimental::filesystem::path& outputDirectory) const
 {
+	PUG_PROFILE_SCOPE("TextureConverter::CookAsset");
 	std::string path = asset.string();
 	std::string out = outputDirectory.parent_path().string();
 	std::string format = "BC3_UNORM";
@@ -0,0 +1,126 @@
+#pragma once
+#include "renderer_interface.h"
+
+#include <vector>
+
+//sort key layout from the most significant bit: layer 4 | pipeline 12 | material 16 | depth 32
+#define DRAW_KEY_LAYER_BITS 4
+#define DRAW_KEY_PIPELINE_BITS 12
+#define DRAW_KEY_MATERIAL_BITS 16
+#define DRAW_KEY_DEPTH_BITS 32
+#define DRAW_KEY_DEPTH_SHIFT 0
+#define DRAW_KEY_MATERIAL_SHIFT (DRAW_KEY_DEPTH_SHIFT + DRAW_KEY_DEPTH_BITS)
+#define DRAW_KEY_PIPELINE_SHIFT (DRAW_KEY_MATERIAL_SHIFT + DRAW_KEY_MATERIAL_BITS)
+#define DRAW_KEY_LAYER_SHIFT (DRAW_KEY_PIPELINE_SHIFT + DRAW_KEY_PIPELINE_BITS)
+
+#define DRAW_QUEUE_RADIX_BITS 8
+#define DRAW_QUEUE_RADIX_SIZE (1 << DRAW_QUEUE_RADIX_BITS)
+#define DRAW_QUEUE_RADIX_PASSES (64 / DRAW_QUEUE_RADIX_BITS)
+
+#define DRAW_STATE_UNSET 0xFFFFFFFF//no state bound yet, 0 is a valid texture state (untextured)
+
+namespace pug {
+namespace graphics {
+
+	//opaque layers sort front to back so early z rejects more, transparent ones back to front so they blend correctly
+	//values that do not fit their field are masked
+	uint64_t MakeDrawSortKey(uint32_t layer, uint32_t pipeline, uint32_t material, float depth, bool backToFront);
+
+	//draw packets of one frame, sorted by their DrawCall::sortKey before they are turned into api calls
+	//the packets stay where they were submitted, only 16 byte (key, index) pairs are moved by the sort
+	class DrawQueue
+	{
+	public:
+		DrawQueue() {}
+		~DrawQueue() {}
+
+		void Reserve(uint32_t capacity);
+		void Submit(const DrawCall& drawCall);
+		//stable lsd radix sort, byte positions that are the same for every key are skipped
+		void Sort();
+		void Clear();
+
+		uint32_t GetCount() const { return (uint32_t)m_entries.size(); }
+		//in key order after Sort, in submission order before
+		const DrawCall& GetSorted(uint32_t index) const { return m_packets[m_entries[index].index]; }
+
+	private:
+		struct SortEntry
+		{
+			uint64_t key;
+			uint32_t index;
+			uint32_t padding;
+		};
+
+		std::vector<DrawCall> m_packets;
+		std::vector<SortEntry> m_entries;
+		std::vector<SortEntry> m_scratch;
+	};
+
+	//state changes a translation issued, added up over every range translated with the same stats
+	struct DrawTranslationStats
+	{
+		uint32_t drawCount;
+		uint32_t pipelineChanges;
+		uint32_t vertexBufferChanges;
+		uint32_t indexBufferChanges;
+		uint32_t textureChanges;
+	};
+
+	//for ranges translated into separate stats, e.g. one per chunk
+	void AddDrawTranslationStats(const DrawTranslationStats& stats, DrawTranslationStats& out_total);
+
+	//turns the packets [begin, end) into calls on writer and leaves out binds of the state that is already set
+	//the range starts without any state, like a fresh command list
+	//Writer needs SetPipeline, SetVertexBuffer, SetIndexBuffer and SetTexture taking an id and DrawIndexed taking the DrawCall
+	template<typename Writer>
+	void TranslateDrawPackets(const DrawQueue& queue, uint32_t begin, uint32_t end, Writer& writer, DrawTranslationStats& out_stats)
+	{
+		uint32_t pipeline = DRAW_STATE_UNSET;
+		uint32_t vertexBuffer = DRAW_STATE_UNSET;
+		uint32_t indexBuffer = DRAW_STATE_UNSET;
+		uint32_t texture = DRAW_STATE_UNSET;
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			const DrawCall& drawCall = queue.GetSorted(i);
+			if (drawCall.pipeline != pipeline)
+			{
+				pipeline = drawCall.pipeline;
+				writer.SetPipeline(pipeline);
+				++out_stats.pipelineChanges;
+			}
+			if (drawCall.vertexBuffer != vertexBuffer)
+			{
+				vertexBuffer = drawCall.vertexBuffer;
+				writer.SetVertexBuffer(vertexBuffer);
+				++out_stats.vertexBufferChanges;
+			}
+			if (drawCall.indexBuffer != indexBuffer)
+			{
+				indexBuffer = drawCall.indexBuffer;
+				writer.SetIndexBuffer(indexBuffer);
+				++out_stats.indexBufferChanges;
+			}
+			if (drawCall.texture != texture)
+			{
+				texture = drawCall.texture;
+				writer.SetTexture(texture);
+				++out_stats.textureChanges;
+			}
+			writer.DrawIndexed(drawCall);
+			++out_stats.drawCount;
+		}
+	}
+
+	//for the null renderer and benchmarks, only the stats are of interest
+	struct NullDrawWriter
+	{
+		void SetPipeline(uint32_t) {}
+		void SetVertexBuffer(uint32_t) {}
+		void SetIndexBuffer(uint32_t) {}
+		void SetTexture(uint32_t) {}
+		void DrawIndexed(const DrawCall&) {}
+	};
+
+}
+}
@@ -51,6 +51,13 @@ namespace graphics
 			D3D12_CLEAR_VALUE* a_clearValue
 		);
 
+		//buffer in an upload heap that the gpu reads from directly, data is copied into it
+		PUG_RESULT CreateUploadBuffer(
+			ID3D12Resource*& out_buffer,
+			const void* a_data,
+			uint32_t a_size
+		);
+
 		PUG_RESULT CreateVertexAndIndexBuffer(
 			ID3D12Resource*& out_vertexBuffer,
 			ID3D12Resource*& out_indexBuffer,
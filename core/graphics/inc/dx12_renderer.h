@@ -3,6 +3,11 @@
 #include <dxgi1_4.h>
 #include "renderer_interface.h"
 #include "dx12_device.h"
+#include "slot_allocator.h"
+#include "draw_queue.h"
+#include "parallel_draw_recorder.h"
+
+#include <vector>
 
 namespace pug {
 namespace graphics {
@@ -20,9 +25,19 @@ namespace graphics {
 		virtual void Draw()							override;
 		virtual void Destroy()						override;
 
+		virtual PUG_RESULT CreateVertexBuffer(const void* vertexData, uint32_t vertexStride, uint32_t vertexCount, uint32_t& out_vertexBuffer) override;
+		virtual PUG_RESULT CreateIndexBuffer(const uint32_t* indexData, uint32_t indexCount, uint32_t& out_indexBuffer) override;
+		virtual PUG_RESULT CreateTexture(const TextureDesc& desc, const uint8_t* textureData, uint64_t dataSize, uint32_t& out_texture) override;
+		virtual bool DestroyVertexBuffer(uint32_t vertexBuffer) override;
+		virtual bool DestroyIndexBuffer(uint32_t indexBuffer) override;
+		virtual bool DestroyTexture(uint32_t texture) override;
+
+		virtual void Submit(const DrawCall& drawCall) override;
+
 	private:
 
 		void PopulateCommandList();
+		void RecordDrawChunk(uint32_t chunkIndex, const DrawChunk& chunk, uint32_t workerIndex, D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle);
 		void TransitionToNextFrame();
 
 		PUG_RESULT LoadPipeline(Window* a_window);
@@ -44,7 +59,15 @@ namespace graphics {
 
 		ID3D12CommandQueue* m_directCommandQueue;
 		ID3D12CommandAllocator* m_directCommandAllocators[BufferCount];
-		ID3D12GraphicsCommandList* m_directCommandList;
+		ID3D12GraphicsCommandList* m_directCommandList;//clears the frame, the draws follow in the chunk lists
+		ID3D12GraphicsCommandList* m_presentCommandList;
+
+		// Parallel draw recording, chunk i of the sorted draws goes into m_chunkCommandLists[i]
+
+		ParallelDrawRecorder m_drawRecorder;
+		//a worker records its chunks one after another, so one allocator per worker and frame in flight is enough
+		ID3D12CommandAllocator* m_workerCommandAllocators[BufferCount][DRAW_RECORD_MAX_WORKERS];
+		ID3D12GraphicsCommandList* m_chunkCommandLists[DRAW_RECORD_MAX_CHUNKS];
 
 		// Pipeline state resources
 
@@ -65,6 +88,19 @@ namespace graphics {
 		D3D12_RECT m_scissorRect;
 		float m_aspectRatio;
 
+		// Buffers created through the renderer interface, indexed by the slot of their id
+
+		utility::SlotAllocator m_vertexBufferSlots;
+		utility::SlotAllocator m_indexBufferSlots;
+		ID3D12Resource* m_vertexBuffers[RENDERER_MAX_BUFFERS];
+		ID3D12Resource* m_indexBuffers[RENDERER_MAX_BUFFERS];
+		D3D12_VERTEX_BUFFER_VIEW m_vertexBufferViews[RENDERER_MAX_BUFFERS];
+		D3D12_INDEX_BUFFER_VIEW m_indexBufferViews[RENDERER_MAX_BUFFERS];
+		//destroyed while a frame in flight might still use them, released once the frame is done
+		std::vector<ID3D12Resource*> m_pendingReleases[BufferCount];
+
+		DrawQueue m_drawQueue;//submitted for the next Draw
+
 		// TEMPORARY ---- REMOVE!!!!!!!!
 		ID3D12Resource* m_vertexBuffer;
 		ID3D12Resource* m_indexBuffer;
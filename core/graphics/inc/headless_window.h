@@ -0,0 +1,21 @@
+#pragma once
+#include "window.h"
+
+namespace pug {
+namespace graphics {
+
+	//a window without an operating system window behind it, pairs with the NullRenderer for runs without a display
+	class HeadlessWindow final : public Window
+	{
+	public:
+		HeadlessWindow() = default;
+		~HeadlessWindow() {}
+
+		virtual void Destroy() final;
+		virtual void DispatchMessages() final;
+
+		PUG_RESULT Initialize(const vmath::Int2& a_size);
+	};
+
+}
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "renderer_interface.h"
+#include "slot_allocator.h"
+#include "draw_queue.h"
+#include "parallel_draw_recorder.h"
+
+namespace pug {
+namespace graphics {
+
+	struct NullRendererStats
+	{
+		uint32_t vertexBufferCount;
+		uint32_t indexBufferCount;
+		uint32_t textureCount;
+		uint64_t resourceBytes;//vertex, index and texture data that is alive
+		uint64_t frameCount;
+		uint32_t drawCount;//submitted for the frame that is being recorded
+		uint32_t lastFrameDrawCount;
+		uint64_t invalidCallCount;//draws and destroys with ids that are stale or were never created
+		DrawTranslationStats lastFrameTranslation;//state changes the sorted draws of the last frame needed, summed over its chunks
+		uint32_t lastFrameChunkCount;
+	};
+
+	//accepts everything the gpu backends do without touching a gpu, for benchmarks and tests on machines without one
+	//ids are validated like a real backend would use them, the data itself is dropped
+	//draws are translated in chunks on recordWorkerCount threads like the gpu backends record them, 0 picks the default count
+	class NullRenderer : public IRenderer
+	{
+	public:
+		explicit NullRenderer(uint32_t recordWorkerCount = 1);
+		~NullRenderer() {}
+
+		virtual PUG_RESULT Initialize(Window* a_window) override;
+		virtual PUG_RESULT Resize(Window* a_window) override;
+		virtual void Draw() override;
+		virtual void Destroy() override;
+
+		virtual PUG_RESULT CreateVertexBuffer(const void* vertexData, uint32_t vertexStride, uint32_t vertexCount, uint32_t& out_vertexBuffer) override;
+		virtual PUG_RESULT CreateIndexBuffer(const uint32_t* indexData, uint32_t indexCount, uint32_t& out_indexBuffer) override;
+		virtual PUG_RESULT CreateTexture(const TextureDesc& desc, const uint8_t* textureData, uint64_t dataSize, uint32_t& out_texture) override;
+		virtual bool DestroyVertexBuffer(uint32_t vertexBuffer) override;
+		virtual bool DestroyIndexBuffer(uint32_t indexBuffer) override;
+		virtual bool DestroyTexture(uint32_t texture) override;
+
+		virtual void Submit(const DrawCall& drawCall) override;
+
+		const NullRendererStats& GetStats() const { return m_stats; }
+		bool IsValidDraw(const DrawCall& drawCall) const;
+
+	private:
+		utility::SlotAllocator m_vertexBufferSlots;
+		utility::SlotAllocator m_indexBufferSlots;
+		utility::SlotAllocator m_textureSlots;
+		uint64_t m_vertexBufferBytes[RENDERER_MAX_BUFFERS];
+		uint64_t m_indexBufferBytes[RENDERER_MAX_BUFFERS];
+		uint64_t m_textureBytes[RENDERER_MAX_TEXTURES];
+		DrawQueue m_drawQueue;
+		ParallelDrawRecorder m_drawRecorder;
+		DrawTranslationStats m_chunkStats[DRAW_RECORD_MAX_CHUNKS];
+		NullRendererStats m_stats;
+		uint32_t m_recordWorkerCount;
+	};
+
+}
+}
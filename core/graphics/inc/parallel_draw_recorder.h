@@ -0,0 +1,63 @@
+#pragma once
+#include "job_pool.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#define DRAW_RECORD_MAX_WORKERS 8
+#define DRAW_RECORD_CHUNKS_PER_WORKER 3//more chunks than workers so a worker that finishes early can steal
+#define DRAW_RECORD_MAX_CHUNKS (DRAW_RECORD_MAX_WORKERS * DRAW_RECORD_CHUNKS_PER_WORKER)
+#define DRAW_RECORD_MIN_CHUNK_PACKETS 512//below this a chunk costs more to hand to a thread than to record
+
+namespace pug {
+namespace graphics {
+
+	//a range [begin, end) of the sorted draw packets
+	struct DrawChunk
+	{
+		uint32_t begin;
+		uint32_t end;
+	};
+
+	//chunkIndex is also the submission position of the chunk, workerIndex can be used to index per worker state
+	typedef std::function<void(uint32_t chunkIndex, const DrawChunk& chunk, uint32_t workerIndex)> DrawChunkFunction;
+
+	//splits [0, packetCount) into neighbouring chunks of about the same size, in order
+	//returns the chunk count, 0 for no packets and at most maxChunks
+	uint32_t SplitDrawChunks(uint32_t packetCount, uint32_t maxChunks, uint32_t minChunkPackets, DrawChunk* out_chunks);
+
+	//hardware threads minus the one calling Draw, clamped to [1, DRAW_RECORD_MAX_WORKERS]
+	uint32_t GetDefaultDrawRecordWorkerCount();
+
+	//records the sorted draws of a frame on worker threads, one chunk per command list
+	//it knows nothing about the api, the backend hands it a function that records a single chunk
+	class ParallelDrawRecorder
+	{
+	public:
+		ParallelDrawRecorder();
+		~ParallelDrawRecorder();
+
+		//0 picks GetDefaultDrawRecordWorkerCount, with 1 worker every chunk is recorded on the calling thread
+		void Initialize(uint32_t workerCount, uint32_t minChunkPackets = DRAW_RECORD_MIN_CHUNK_PACKETS);
+		void Destroy();
+
+		//blocks until every chunk is recorded and returns the chunk count
+		//a worker records its chunks one after another, never two at the same time
+		uint32_t Record(uint32_t packetCount, const DrawChunkFunction& recordChunk);
+
+		uint32_t GetWorkerCount() const { return m_workerCount; }
+		//a single worker gets a single chunk, splitting would only add state changes
+		uint32_t GetMaxChunkCount() const { return m_workerCount > 1 ? m_workerCount * DRAW_RECORD_CHUNKS_PER_WORKER : 1; }
+		//the chunks of the last Record
+		const DrawChunk* GetChunks() const { return m_chunks; }
+
+	private:
+		utility::JobPool m_jobPool;
+		DrawChunk m_chunks[DRAW_RECORD_MAX_CHUNKS];
+		uint32_t m_workerCount;
+		uint32_t m_minChunkPackets;
+	};
+
+}
+}
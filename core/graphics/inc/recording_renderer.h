@@ -0,0 +1,72 @@
+#pragma once
+#include "null_renderer.h"
+
+#include <vector>
+
+namespace pug {
+namespace graphics {
+
+	enum ERenderCommand : uint32_t
+	{
+		RenderCommand_CreateVertexBuffer = 0,
+		RenderCommand_CreateIndexBuffer,
+		RenderCommand_CreateTexture,
+		RenderCommand_DestroyVertexBuffer,
+		RenderCommand_DestroyIndexBuffer,
+		RenderCommand_DestroyTexture,
+		RenderCommand_Draw,
+		RenderCommand_Present,
+		RenderCommand_Count
+	};
+
+	//one call into the renderer, the data of create calls is kept as its size and hash
+	struct RenderCommand
+	{
+		ERenderCommand type;
+		uint32_t frame;
+		uint32_t id;//the resource created or destroyed
+		PUG_RESULT result;
+		uint32_t stride;//vertex stride or texture width
+		uint32_t count;//vertex or index count, texture height
+		uint32_t format;//ETextureFormat
+		uint32_t mipCount;
+		uint64_t dataSize;
+		uint64_t dataHash;
+		DrawCall draw;
+	};
+
+	//a NullRenderer that also keeps every call in order, so tests can compare the stream against an expected one
+	//invalid calls are recorded as well, Present marks the end of each frame
+	class RecordingRenderer : public NullRenderer
+	{
+	public:
+		RecordingRenderer() {}
+		~RecordingRenderer() {}
+
+		virtual void Draw() override;
+		virtual void Destroy() override;
+
+		virtual PUG_RESULT CreateVertexBuffer(const void* vertexData, uint32_t vertexStride, uint32_t vertexCount, uint32_t& out_vertexBuffer) override;
+		virtual PUG_RESULT CreateIndexBuffer(const uint32_t* indexData, uint32_t indexCount, uint32_t& out_indexBuffer) override;
+		virtual PUG_RESULT CreateTexture(const TextureDesc& desc, const uint8_t* textureData, uint64_t dataSize, uint32_t& out_texture) override;
+		virtual bool DestroyVertexBuffer(uint32_t vertexBuffer) override;
+		virtual bool DestroyIndexBuffer(uint32_t indexBuffer) override;
+		virtual bool DestroyTexture(uint32_t texture) override;
+
+		virtual void Submit(const DrawCall& drawCall) override;
+
+		const std::vector<RenderCommand>& GetCommands() const { return m_commands; }
+		void ClearCommands() { m_commands.clear(); }
+
+	private:
+		RenderCommand& AddCommand(ERenderCommand type, uint32_t id, PUG_RESULT result);
+
+		std::vector<RenderCommand> m_commands;
+	};
+
+	const char* GetRenderCommandName(ERenderCommand type);
+	//a single line without a line break, stable across runs so streams can be diffed as text
+	void FormatRenderCommand(const RenderCommand& command, char* out_text, size_t textSize);
+
+}
+}
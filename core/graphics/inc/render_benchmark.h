@@ -0,0 +1,50 @@
+#pragma once
+#include "draw_queue.h"
+#include "parallel_draw_recorder.h"
+
+#define DRAW_BENCHMARK_MESH_COUNT 256
+#define DRAW_BENCHMARK_MATERIAL_COUNT 512
+#define DRAW_BENCHMARK_PIPELINE_COUNT 16
+#define DRAW_BENCHMARK_LAYER_COUNT 4//the last one is transparent and sorted back to front
+
+namespace pug {
+namespace graphics {
+
+	//medians over every iteration, in milliseconds
+	struct DrawQueueBenchmarkResult
+	{
+		uint32_t packetCount;
+		uint32_t iterationCount;
+		double submitMs;
+		double radixSortMs;
+		double stdSortMs;//std::stable_sort of the same keys, for comparison
+		double translateMs;
+		DrawTranslationStats unsorted;//state changes in submission order
+		DrawTranslationStats sorted;
+	};
+
+	//fills a DrawQueue with packets of random meshes, materials and depths and times sorting and translating them
+	//runs on the cpu only, the packets never reach a renderer
+	DrawQueueBenchmarkResult RunDrawQueueBenchmark(uint32_t packetCount, uint32_t iterationCount);
+	void FormatDrawQueueBenchmark(const DrawQueueBenchmarkResult& result, char* out_text, size_t textSize);
+
+	//medians over every iteration, in milliseconds
+	struct ParallelRecordBenchmarkResult
+	{
+		uint32_t packetCount;
+		uint32_t iterationCount;
+		uint32_t workerCount;
+		uint32_t chunkCount;
+		double singleThreadMs;//the whole queue recorded on the calling thread
+		double parallelMs;
+		DrawTranslationStats singleThread;
+		DrawTranslationStats parallel;//every chunk starts without state, so it rebinds a little more
+	};
+
+	//records the same sorted packets into memory, once on the calling thread and once with a ParallelDrawRecorder
+	//0 workers picks the default count
+	ParallelRecordBenchmarkResult RunParallelRecordBenchmark(uint32_t packetCount, uint32_t iterationCount, uint32_t workerCount);
+	void FormatParallelRecordBenchmark(const ParallelRecordBenchmarkResult& result, char* out_text, size_t textSize);
+
+}
+}
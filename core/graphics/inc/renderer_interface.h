@@ -1,20 +1,73 @@
 #pragma once
 #include <cstdint>
+#include <cstddef>
 #include "result_codes.h"
 
+#define RENDERER_INVALID_ID 0//resource ids are generational handles, 0 is never handed out
+#define RENDERER_MAX_BUFFERS 4096
+#define RENDERER_MAX_TEXTURES 4096
+#define RENDERER_DEFAULT_PIPELINE 0
+#define RENDERER_MAX_PIPELINES 1
 
 namespace pug {
 namespace graphics {
 	class Window;
 
+	enum ETextureFormat : uint32_t
+	{
+		TextureFormat_Unknown = 0,
+		TextureFormat_RGBA8,
+		TextureFormat_BC1,
+		TextureFormat_BC2,
+		TextureFormat_BC3,
+		TextureFormat_BC4,
+		TextureFormat_BC5,
+		TextureFormat_Count
+	};
+
+	struct TextureDesc
+	{
+		uint32_t width;
+		uint32_t height;
+		uint32_t mipCount;
+		ETextureFormat format;
+	};
+
+	//one indexed draw, the buffers and texture are ids returned by the renderer
+	struct DrawCall
+	{
+		uint32_t vertexBuffer;
+		uint32_t indexBuffer;
+		uint32_t texture;//RENDERER_INVALID_ID for untextured draws
+		uint32_t indexCount;
+		uint32_t startIndex;
+		int32_t baseVertex;
+		uint32_t pipeline;//RENDERER_DEFAULT_PIPELINE until pipelines can be created
+		uint64_t sortKey;//draws are issued in ascending key order, see MakeDrawSortKey
+	};
+
 	class IRenderer
 	{
 	public:
 		virtual PUG_RESULT Initialize(Window* a_window) = 0;
 		virtual PUG_RESULT Resize(Window* a_window) = 0;
-		virtual void Draw(/*some arguments here probably*/) = 0;
+		//draws everything submitted since the last call and presents
+		virtual void Draw() = 0;
 		virtual void Destroy() = 0;
+
+		//the data is copied, it can be freed as soon as the call returns
+		virtual PUG_RESULT CreateVertexBuffer(const void* vertexData, uint32_t vertexStride, uint32_t vertexCount, uint32_t& out_vertexBuffer) = 0;
+		virtual PUG_RESULT CreateIndexBuffer(const uint32_t* indexData, uint32_t indexCount, uint32_t& out_indexBuffer) = 0;
+		//textureData holds every mip level, largest first, as stored in a dds file
+		virtual PUG_RESULT CreateTexture(const TextureDesc& desc, const uint8_t* textureData, uint64_t dataSize, uint32_t& out_texture) = 0;
+		//false for ids that are stale or were never handed out
+		virtual bool DestroyVertexBuffer(uint32_t vertexBuffer) = 0;
+		virtual bool DestroyIndexBuffer(uint32_t indexBuffer) = 0;
+		virtual bool DestroyTexture(uint32_t texture) = 0;
+
+		//queued until the next Draw, the submission order does not matter
+		virtual void Submit(const DrawCall& drawCall) = 0;
 	};
 
 }
-}
\ No newline at end of file
+}
@@ -1,6 +1,6 @@
 #pragma once
 #include <cstdint>
-#include "vmath\vmath.h"
+#include "vmath/vmath.h"
 #include <string>
 #include "result_codes.h"
 
@@ -13,6 +13,7 @@ namespace graphics {
 		~Window() {};
 
 		static Window* Create(const std::string& a_title, const vmath::Int2& a_size);
+		static Window* CreateHeadless(const vmath::Int2& a_size);
 		
 		virtual void DispatchMessages() = 0;
 
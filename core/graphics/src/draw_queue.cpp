@@ -0,0 +1,109 @@
+#include "draw_queue.h"
+
+#include <cstring>
+
+namespace pug {
+namespace graphics {
+
+	//flips the float bits so unsigned integer order matches float order, negative values included
+	static uint32_t GetSortableDepth(float depth)
+	{
+		uint32_t bits;
+		memcpy(&bits, &depth, sizeof(bits));
+		return (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
+	}
+
+	uint64_t MakeDrawSortKey(uint32_t layer, uint32_t pipeline, uint32_t material, float depth, bool backToFront)
+	{
+		const uint32_t sortableDepth = backToFront ? ~GetSortableDepth(depth) : GetSortableDepth(depth);
+		return ((uint64_t)(layer & ((1u << DRAW_KEY_LAYER_BITS) - 1)) << DRAW_KEY_LAYER_SHIFT) |
+			((uint64_t)(pipeline & ((1u << DRAW_KEY_PIPELINE_BITS) - 1)) << DRAW_KEY_PIPELINE_SHIFT) |
+			((uint64_t)(material & ((1u << DRAW_KEY_MATERIAL_BITS) - 1)) << DRAW_KEY_MATERIAL_SHIFT) |
+			((uint64_t)sortableDepth << DRAW_KEY_DEPTH_SHIFT);
+	}
+
+	void AddDrawTranslationStats(const DrawTranslationStats& stats, DrawTranslationStats& out_total)
+	{
+		out_total.drawCount += stats.drawCount;
+		out_total.pipelineChanges += stats.pipelineChanges;
+		out_total.vertexBufferChanges += stats.vertexBufferChanges;
+		out_total.indexBufferChanges += stats.indexBufferChanges;
+		out_total.textureChanges += stats.textureChanges;
+	}
+
+	void DrawQueue::Reserve(uint32_t capacity)
+	{
+		m_packets.reserve(capacity);
+		m_entries.reserve(capacity);
+		m_scratch.reserve(capacity);
+	}
+
+	void DrawQueue::Submit(const DrawCall& drawCall)
+	{
+		SortEntry entry;
+		entry.key = drawCall.sortKey;
+		entry.index = (uint32_t)m_packets.size();
+		entry.padding = 0;
+		m_packets.push_back(drawCall);
+		m_entries.push_back(entry);
+	}
+
+	void DrawQueue::Sort()
+	{
+		const uint32_t count = (uint32_t)m_entries.size();
+		if (count < 2)
+		{
+			return;
+		}
+
+		//one read over the keys builds the histograms of every pass
+		uint32_t histograms[DRAW_QUEUE_RADIX_PASSES][DRAW_QUEUE_RADIX_SIZE];
+		memset(histograms, 0, sizeof(histograms));
+		for (const SortEntry& entry : m_entries)
+		{
+			for (uint32_t pass = 0; pass < DRAW_QUEUE_RADIX_PASSES; ++pass)
+			{
+				++histograms[pass][(entry.key >> (pass * DRAW_QUEUE_RADIX_BITS)) & (DRAW_QUEUE_RADIX_SIZE - 1)];
+			}
+		}
+
+		m_scratch.resize(count);
+		SortEntry* source = m_entries.data();
+		SortEntry* destination = m_scratch.data();
+		for (uint32_t pass = 0; pass < DRAW_QUEUE_RADIX_PASSES; ++pass)
+		{
+			uint32_t* histogram = histograms[pass];
+			const uint32_t shift = pass * DRAW_QUEUE_RADIX_BITS;
+			if (histogram[(source[0].key >> shift) & (DRAW_QUEUE_RADIX_SIZE - 1)] == count)
+			{//every key has the same byte here, e.g. unused layers or pipelines
+				continue;
+			}
+			uint32_t offset = 0;
+			for (uint32_t i = 0; i < DRAW_QUEUE_RADIX_SIZE; ++i)
+			{//counts to start offsets
+				const uint32_t bucketCount = histogram[i];
+				histogram[i] = offset;
+				offset += bucketCount;
+			}
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				destination[histogram[(source[i].key >> shift) & (DRAW_QUEUE_RADIX_SIZE - 1)]++] = source[i];
+			}
+			SortEntry* swap = source;
+			source = destination;
+			destination = swap;
+		}
+		if (source != m_entries.data())
+		{//an odd number of passes ran
+			m_entries.swap(m_scratch);
+		}
+	}
+
+	void DrawQueue::Clear()
+	{
+		m_packets.clear();
+		m_entries.clear();
+	}
+
+}
+}
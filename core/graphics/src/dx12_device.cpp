@@ -95,6 +95,35 @@ namespace graphics
 		return PUG_RESULT_OK;
 	}
 
+	PUG_RESULT DX12Device::CreateUploadBuffer(ID3D12Resource*& out_buffer, const void* a_data, uint32_t a_size)
+	{
+		if (!PUG_SUCCEEDED(CreateCommittedResource(
+			out_buffer,
+			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+			D3D12_HEAP_FLAG_NONE,
+			&CD3DX12_RESOURCE_DESC::Buffer(a_size),
+			D3D12_RESOURCE_STATE_GENERIC_READ,
+			nullptr
+		)))
+		{
+			return PUG_RESULT_GRAPHICS_ERROR;
+		}
+
+		uint8_t* pDataBegin;
+		CD3DX12_RANGE readRange(0, 0);// We do not intend to read from this resource on the CPU.
+		if (FAILED(out_buffer->Map(0, &readRange, reinterpret_cast<void**>(&pDataBegin))))
+		{
+			log::Error("Error mapping upload buffer.");
+			out_buffer->Release();
+			out_buffer = nullptr;
+			return PUG_RESULT_GRAPHICS_ERROR;
+		}
+		memcpy(pDataBegin, a_data, a_size);
+		out_buffer->Unmap(0, nullptr);
+
+		return PUG_RESULT_OK;
+	}
+
 	PUG_RESULT DX12Device::CreateVertexAndIndexBuffer(ID3D12Resource *& out_vertexBuffer, ID3D12Resource *& out_indexBuffer, D3D12_VERTEX_BUFFER_VIEW& out_vertexBufferView, D3D12_INDEX_BUFFER_VIEW& out_indexBufferView, Vertex * vertexArray, uint32_t vertexCount, uint32_t * indexArray, uint32_t indexCount)
 	{
 		// Vertex buffer
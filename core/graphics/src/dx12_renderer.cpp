@@ -3,10 +3,13 @@
 #include "d3dx12.h"
 #include <d3dcompiler.h>
 #include "logger.h"
+#include "profiler.h"
+#include "frame_stats.h"
 #include <codecvt>
 #include <experimental\filesystem>
 #include <comdef.h>
 #include "vertex.h"
+#include "draw_queue.h"
 
 namespace pug {
 namespace graphics {
@@ -61,12 +64,15 @@ namespace graphics {
 	}
 
 	DX12Renderer::DX12Renderer()
-		: m_currentFrameIndex(0)
+		: m_presentCommandList(nullptr)
+		, m_currentFrameIndex(0)
 	{
 		for (uint32_t i = 0; i < BufferCount; ++i)
 		{
 			m_fenceValues[i] = 0;
 		}
+		memset(m_workerCommandAllocators, 0, sizeof(m_workerCommandAllocators));
+		memset(m_chunkCommandLists, 0, sizeof(m_chunkCommandLists));
 	}
 
 	PUG_RESULT DX12Renderer::Initialize(Window* a_window)
@@ -76,6 +82,11 @@ namespace graphics {
 		m_scissorRect = CD3DX12_RECT(0, 0, static_cast<LONG>(size.x), static_cast<LONG>(size.y));
 		m_aspectRatio = (float)size.x / (float)size.y;
 
+		m_vertexBufferSlots.Initialize(RENDERER_MAX_BUFFERS);
+		m_indexBufferSlots.Initialize(RENDERER_MAX_BUFFERS);
+		memset(m_vertexBuffers, 0, sizeof(m_vertexBuffers));
+		memset(m_indexBuffers, 0, sizeof(m_indexBuffers));
+
 		if (!PUG_SUCCEEDED(LoadPipeline(a_window)))
 			return PUG_RESULT_GRAPHICS_ERROR;
 		if (!PUG_SUCCEEDED(LoadAssets()))
@@ -319,6 +330,47 @@ namespace graphics {
 
 		m_directCommandList->Close();
 
+		if (!PUG_SUCCEEDED(m_device->CreateGraphicsCommandList(
+			m_presentCommandList,
+			m_directCommandAllocators[m_swapChain->GetCurrentBackBufferIndex()],
+			D3D12_COMMAND_LIST_TYPE_DIRECT,
+			nullptr
+		)))
+		{
+			return PUG_RESULT_GRAPHICS_ERROR;
+		}
+
+		m_presentCommandList->Close();
+
+		// Create the allocators and lists the draw recording workers use
+
+		m_drawRecorder.Initialize(0);
+		for (uint32_t i = 0; i < BufferCount; ++i)
+		{
+			for (uint32_t w = 0; w < m_drawRecorder.GetWorkerCount(); ++w)
+			{
+				if (!PUG_SUCCEEDED(m_device->CreateCommandAllocator(m_workerCommandAllocators[i][w])))
+				{
+					return PUG_RESULT_GRAPHICS_ERROR;
+				}
+			}
+		}
+		for (uint32_t i = 0; i < m_drawRecorder.GetMaxChunkCount(); ++i)
+		{
+			if (!PUG_SUCCEEDED(m_device->CreateGraphicsCommandList(
+				m_chunkCommandLists[i],
+				m_workerCommandAllocators[0][0],
+				D3D12_COMMAND_LIST_TYPE_DIRECT,
+				m_PSO
+			)))
+			{
+				return PUG_RESULT_GRAPHICS_ERROR;
+			}
+
+			m_chunkCommandLists[i]->Close();
+		}
+		log::Info("Recording draws on %u threads.", m_drawRecorder.GetWorkerCount());
+
 		// Create synchroniztion objects
 		{
 			if (!PUG_SUCCEEDED(m_device->CreateFence(m_fence)))
@@ -370,12 +422,35 @@ namespace graphics {
 
 	void DX12Renderer::Draw()
 	{
+		PUG_PROFILE_FUNCTION();
 		PopulateCommandList();
 		TransitionToNextFrame();
 	}
 
+	//binds the views of the ids TranslateDrawPackets hands over, which Submit validated
+	struct DX12DrawWriter
+	{
+		ID3D12GraphicsCommandList* commandList;
+		ID3D12RootSignature* rootSignature;
+		ID3D12PipelineState* pipelineState;
+		const D3D12_VERTEX_BUFFER_VIEW* vertexBufferViews;
+		const D3D12_INDEX_BUFFER_VIEW* indexBufferViews;
+
+		void SetPipeline(uint32_t)
+		{//only the default pipeline exists so far
+			commandList->SetPipelineState(pipelineState);
+			commandList->SetGraphicsRootSignature(rootSignature);
+		}
+		void SetVertexBuffer(uint32_t vertexBuffer) { commandList->IASetVertexBuffers(0, 1, &vertexBufferViews[SLOT_INDEX(vertexBuffer)]); }
+		void SetIndexBuffer(uint32_t indexBuffer) { commandList->IASetIndexBuffer(&indexBufferViews[SLOT_INDEX(indexBuffer)]); }
+		void SetTexture(uint32_t) {}//textures are not supported by this backend yet
+		void DrawIndexed(const DrawCall& drawCall) { commandList->DrawIndexedInstanced(drawCall.indexCount, 1, drawCall.startIndex, drawCall.baseVertex, 0); }
+	};
+
 	void DX12Renderer::PopulateCommandList()
 	{
+		PUG_PROFILE_FUNCTION();
+		utility::FramePhaseScope phaseScope(utility::FramePhase_PopulateCommandList);
 		m_directCommandAllocators[m_currentFrameIndex]->Reset();
 		m_directCommandList->Reset(m_directCommandAllocators[m_currentFrameIndex], m_PSO);
 
@@ -396,36 +471,86 @@ namespace graphics {
 		float color[4] = { 0.0f, 0.4f, 0.5f, 0.5f };
 		m_directCommandList->ClearRenderTargetView(rtvHandle, color, 0, nullptr);
 
-		m_directCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-		m_directCommandList->IASetVertexBuffers(0, 1, &m_vbView);
-		m_directCommandList->IASetIndexBuffer(&m_ibView);
-		m_directCommandList->DrawIndexedInstanced(6, 1, 0, 0, 0);
+		if (m_drawQueue.GetCount() == 0)
+		{//nothing submitted, keep showing the test quad
+			m_directCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+			m_directCommandList->IASetVertexBuffers(0, 1, &m_vbView);
+			m_directCommandList->IASetIndexBuffer(&m_ibView);
+			m_directCommandList->DrawIndexedInstanced(6, 1, 0, 0, 0);
+		}
+		m_directCommandList->Close();
+
+		uint32_t chunkCount = 0;
+		if (m_drawQueue.GetCount() > 0)
+		{
+			{
+				PUG_PROFILE_SCOPE("SortDrawQueue");
+				m_drawQueue.Sort();
+			}
+			//the gpu finished the last frame that used these allocators before TransitionToNextFrame returned
+			for (uint32_t w = 0; w < m_drawRecorder.GetWorkerCount(); ++w)
+			{
+				m_workerCommandAllocators[m_currentFrameIndex][w]->Reset();
+			}
+			chunkCount = m_drawRecorder.Record(m_drawQueue.GetCount(), [this, rtvHandle](uint32_t chunkIndex, const DrawChunk& chunk, uint32_t workerIndex)
+			{
+				RecordDrawChunk(chunkIndex, chunk, workerIndex, rtvHandle);
+			});
+		}
+		m_drawQueue.Clear();
 
 		// Indicate that the render target will now be used to present when the command list is done executing.
+		m_presentCommandList->Reset(m_directCommandAllocators[m_currentFrameIndex], nullptr);
+
 		CD3DX12_RESOURCE_BARRIER presentResourceBarrier =
 			CD3DX12_RESOURCE_BARRIER::Transition(m_OMTargets[m_currentFrameIndex], D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
 
-		m_directCommandList->ResourceBarrier(1, &presentResourceBarrier);
+		m_presentCommandList->ResourceBarrier(1, &presentResourceBarrier);
 
-		m_directCommandList->Close();
+		m_presentCommandList->Close();
 
-		ID3D12CommandList* ppCommandLists[] =
+		//one submission in draw order, the chunks were recorded in any order
+		ID3D12CommandList* ppCommandLists[DRAW_RECORD_MAX_CHUNKS + 2];
+		uint32_t commandListCount = 0;
+		ppCommandLists[commandListCount++] = m_directCommandList;
+		for (uint32_t i = 0; i < chunkCount; ++i)
 		{
-			m_directCommandList
-		};
+			ppCommandLists[commandListCount++] = m_chunkCommandLists[i];
+		}
+		ppCommandLists[commandListCount++] = m_presentCommandList;
 
-		m_directCommandQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
+		m_directCommandQueue->ExecuteCommandLists(commandListCount, ppCommandLists);
 		m_swapChain->Present(1, 0);
 	}
 
+	void DX12Renderer::RecordDrawChunk(uint32_t chunkIndex, const DrawChunk& chunk, uint32_t workerIndex, D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle)
+	{
+		ID3D12GraphicsCommandList* commandList = m_chunkCommandLists[chunkIndex];
+		commandList->Reset(m_workerCommandAllocators[m_currentFrameIndex][workerIndex], m_PSO);
+
+		//nothing carries over from the list before, every chunk sets up the pass again
+		commandList->SetGraphicsRootSignature(m_rootSignature);
+		commandList->OMSetRenderTargets(1, &rtvHandle, false, nullptr);
+		commandList->RSSetViewports(1, &m_viewport);
+		commandList->RSSetScissorRects(1, &m_scissorRect);
+		commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+		DX12DrawWriter writer = { commandList, m_rootSignature, m_PSO, m_vertexBufferViews, m_indexBufferViews };
+		DrawTranslationStats translationStats = {};
+		TranslateDrawPackets(m_drawQueue, chunk.begin, chunk.end, writer, translationStats);
+
+		commandList->Close();
+	}
+
 	void DX12Renderer::TransitionToNextFrame()
 	{
+		PUG_PROFILE_FUNCTION();
 		//Schedule signal
 		const UINT currFenceValue = m_fenceValues[m_currentFrameIndex];
 
 		if (FAILED(m_directCommandQueue->Signal(m_fence, currFenceValue)))
 		{
-			log::Error("Error scheduling signal.");
+			PUG_ERROR("Error scheduling signal for fence value %u.", currFenceValue);
 		}
 
 		//Update frame index
@@ -434,17 +559,178 @@ namespace graphics {
 		//Wait
 		if (m_fence->GetCompletedValue() < m_fenceValues[m_currentFrameIndex])
 		{
+			utility::FramePhaseScope phaseScope(utility::FramePhase_FenceWait);
 			m_fence->SetEventOnCompletion(m_fenceValues[m_currentFrameIndex], m_fenceEvent);
 			WaitForSingleObjectEx(m_fenceEvent, INFINITE, FALSE);
 		}
 
 		m_fenceValues[m_currentFrameIndex] = currFenceValue + 1;
+
+		//the gpu is done with the frame that used this back buffer last
+		for (ID3D12Resource* resource : m_pendingReleases[m_currentFrameIndex])
+		{
+			resource->Release();
+		}
+		m_pendingReleases[m_currentFrameIndex].clear();
 	}
 
 	void DX12Renderer::Destroy()
 	{
+		for (uint32_t i = 0; i < BufferCount; ++i)
+		{
+			for (ID3D12Resource* resource : m_pendingReleases[i])
+			{
+				resource->Release();
+			}
+			m_pendingReleases[i].clear();
+		}
+		for (uint32_t i = 0; i < RENDERER_MAX_BUFFERS; ++i)
+		{
+			if (m_vertexBuffers[i] != nullptr)
+			{
+				m_vertexBuffers[i]->Release();
+				m_vertexBuffers[i] = nullptr;
+			}
+			if (m_indexBuffers[i] != nullptr)
+			{
+				m_indexBuffers[i]->Release();
+				m_indexBuffers[i] = nullptr;
+			}
+		}
+		m_vertexBufferSlots.Destroy();
+		m_indexBufferSlots.Destroy();
+		m_drawQueue.Clear();
+
+		m_drawRecorder.Destroy();
+		for (uint32_t i = 0; i < DRAW_RECORD_MAX_CHUNKS; ++i)
+		{
+			if (m_chunkCommandLists[i] != nullptr)
+			{
+				m_chunkCommandLists[i]->Release();
+				m_chunkCommandLists[i] = nullptr;
+			}
+		}
+		for (uint32_t i = 0; i < BufferCount; ++i)
+		{
+			for (uint32_t w = 0; w < DRAW_RECORD_MAX_WORKERS; ++w)
+			{
+				if (m_workerCommandAllocators[i][w] != nullptr)
+				{
+					m_workerCommandAllocators[i][w]->Release();
+					m_workerCommandAllocators[i][w] = nullptr;
+				}
+			}
+		}
+		if (m_presentCommandList != nullptr)
+		{
+			m_presentCommandList->Release();
+			m_presentCommandList = nullptr;
+		}
+	}
+
+	PUG_RESULT DX12Renderer::CreateVertexBuffer(const void* vertexData, uint32_t vertexStride, uint32_t vertexCount, uint32_t& out_vertexBuffer)
+	{
+		out_vertexBuffer = RENDERER_INVALID_ID;
+		const uint64_t size = (uint64_t)vertexStride * vertexCount;
+		if (vertexData == nullptr || size == 0 || size > UINT32_MAX)
+		{
+			return PUG_RESULT_GRAPHICS_ERROR;
+		}
+		const uint32_t id = m_vertexBufferSlots.Allocate();
+		if (id == SLOT_INVALID_HANDLE)
+		{
+			return PUG_RESULT_ARRAY_FULL;
+		}
+		ID3D12Resource*& buffer = m_vertexBuffers[SLOT_INDEX(id)];
+		if (!PUG_SUCCEEDED(m_device->CreateUploadBuffer(buffer, vertexData, (uint32_t)size)))
+		{
+			m_vertexBufferSlots.Free(id);
+			buffer = nullptr;
+			return PUG_RESULT_GRAPHICS_ERROR;
+		}
+		D3D12_VERTEX_BUFFER_VIEW& view = m_vertexBufferViews[SLOT_INDEX(id)];
+		view.BufferLocation = buffer->GetGPUVirtualAddress();
+		view.StrideInBytes = vertexStride;
+		view.SizeInBytes = (uint32_t)size;
+		out_vertexBuffer = id;
+		return PUG_RESULT_OK;
+	}
 
+	PUG_RESULT DX12Renderer::CreateIndexBuffer(const uint32_t* indexData, uint32_t indexCount, uint32_t& out_indexBuffer)
+	{
+		out_indexBuffer = RENDERER_INVALID_ID;
+		const uint64_t size = (uint64_t)sizeof(uint32_t) * indexCount;
+		if (indexData == nullptr || size == 0 || size > UINT32_MAX)
+		{
+			return PUG_RESULT_GRAPHICS_ERROR;
+		}
+		const uint32_t id = m_indexBufferSlots.Allocate();
+		if (id == SLOT_INVALID_HANDLE)
+		{
+			return PUG_RESULT_ARRAY_FULL;
+		}
+		ID3D12Resource*& buffer = m_indexBuffers[SLOT_INDEX(id)];
+		if (!PUG_SUCCEEDED(m_device->CreateUploadBuffer(buffer, indexData, (uint32_t)size)))
+		{
+			m_indexBufferSlots.Free(id);
+			buffer = nullptr;
+			return PUG_RESULT_GRAPHICS_ERROR;
+		}
+		D3D12_INDEX_BUFFER_VIEW& view = m_indexBufferViews[SLOT_INDEX(id)];
+		view.BufferLocation = buffer->GetGPUVirtualAddress();
+		view.Format = DXGI_FORMAT_R32_UINT;
+		view.SizeInBytes = (uint32_t)size;
+		out_indexBuffer = id;
+		return PUG_RESULT_OK;
+	}
+
+	PUG_RESULT DX12Renderer::CreateTexture(const TextureDesc& desc, const uint8_t* textureData, uint64_t dataSize, uint32_t& out_texture)
+	{
+		out_texture = RENDERER_INVALID_ID;
+		PUG_ERROR("The dx12 renderer has no shader resource bindings yet, textures can not be created");
+		return PUG_RESULT_GRAPHICS_ERROR;
+	}
+
+	bool DX12Renderer::DestroyVertexBuffer(uint32_t vertexBuffer)
+	{
+		if (!m_vertexBufferSlots.Free(vertexBuffer))
+		{
+			return false;
+		}
+		m_pendingReleases[m_currentFrameIndex].push_back(m_vertexBuffers[SLOT_INDEX(vertexBuffer)]);
+		m_vertexBuffers[SLOT_INDEX(vertexBuffer)] = nullptr;
+		return true;
+	}
+
+	bool DX12Renderer::DestroyIndexBuffer(uint32_t indexBuffer)
+	{
+		if (!m_indexBufferSlots.Free(indexBuffer))
+		{
+			return false;
+		}
+		m_pendingReleases[m_currentFrameIndex].push_back(m_indexBuffers[SLOT_INDEX(indexBuffer)]);
+		m_indexBuffers[SLOT_INDEX(indexBuffer)] = nullptr;
+		return true;
+	}
 
+	bool DX12Renderer::DestroyTexture(uint32_t texture)
+	{
+		return false;
+	}
+
+	void DX12Renderer::Submit(const DrawCall& drawCall)
+	{
+		if (!m_vertexBufferSlots.IsValid(drawCall.vertexBuffer) || !m_indexBufferSlots.IsValid(drawCall.indexBuffer))
+		{
+			PUG_WARNING("Dropped a draw call with a stale buffer id");
+			return;
+		}
+		if (drawCall.pipeline >= RENDERER_MAX_PIPELINES)
+		{
+			PUG_WARNING("Dropped a draw call with an unknown pipeline");
+			return;
+		}
+		m_drawQueue.Submit(drawCall);
 	}
 
 
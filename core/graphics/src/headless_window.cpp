@@ -0,0 +1,31 @@
+#include "headless_window.h"
+
+namespace pug {
+namespace graphics {
+
+	Window* Window::CreateHeadless(const vmath::Int2& a_size)
+	{
+		HeadlessWindow* window = new HeadlessWindow();
+		window->Initialize(a_size);
+
+		return window;
+	}
+
+	PUG_RESULT HeadlessWindow::Initialize(const vmath::Int2& a_size)
+	{
+		m_size = a_size;
+		return PUG_RESULT_OK;
+	}
+
+	void HeadlessWindow::Destroy()
+	{
+		delete this;
+	}
+
+	void HeadlessWindow::DispatchMessages()
+	{
+		//there are no messages without a window
+	}
+
+}
+}
@@ -0,0 +1,174 @@
+#include "null_renderer.h"
+
+namespace pug {
+namespace graphics {
+
+	NullRenderer::NullRenderer(uint32_t recordWorkerCount)
+		: m_stats()
+		, m_recordWorkerCount(recordWorkerCount)
+	{
+
+	}
+
+	PUG_RESULT NullRenderer::Initialize(Window* a_window)
+	{
+		m_vertexBufferSlots.Initialize(RENDERER_MAX_BUFFERS);
+		m_indexBufferSlots.Initialize(RENDERER_MAX_BUFFERS);
+		m_textureSlots.Initialize(RENDERER_MAX_TEXTURES);
+		m_drawRecorder.Initialize(m_recordWorkerCount);
+		m_stats = NullRendererStats();
+		return PUG_RESULT_OK;
+	}
+
+	PUG_RESULT NullRenderer::Resize(Window* a_window)
+	{
+		return PUG_RESULT_OK;
+	}
+
+	void NullRenderer::Draw()
+	{//sorted and translated like a gpu backend would, so benchmarks see the same cpu cost
+		m_drawQueue.Sort();
+		const uint32_t chunkCount = m_drawRecorder.Record(m_drawQueue.GetCount(), [this](uint32_t chunkIndex, const DrawChunk& chunk, uint32_t workerIndex)
+		{
+			NullDrawWriter writer;
+			m_chunkStats[chunkIndex] = DrawTranslationStats();
+			TranslateDrawPackets(m_drawQueue, chunk.begin, chunk.end, writer, m_chunkStats[chunkIndex]);
+		});
+		m_stats.lastFrameTranslation = DrawTranslationStats();
+		for (uint32_t i = 0; i < chunkCount; ++i)
+		{
+			AddDrawTranslationStats(m_chunkStats[i], m_stats.lastFrameTranslation);
+		}
+		m_stats.lastFrameChunkCount = chunkCount;
+		m_drawQueue.Clear();
+		m_stats.lastFrameDrawCount = m_stats.drawCount;
+		m_stats.drawCount = 0;
+		++m_stats.frameCount;
+	}
+
+	void NullRenderer::Destroy()
+	{
+		m_vertexBufferSlots.Destroy();
+		m_indexBufferSlots.Destroy();
+		m_textureSlots.Destroy();
+		m_drawQueue.Clear();
+		m_drawRecorder.Destroy();
+		m_stats = NullRendererStats();
+	}
+
+	PUG_RESULT NullRenderer::CreateVertexBuffer(const void* vertexData, uint32_t vertexStride, uint32_t vertexCount, uint32_t& out_vertexBuffer)
+	{
+		out_vertexBuffer = RENDERER_INVALID_ID;
+		if (vertexData == nullptr || vertexStride == 0 || vertexCount == 0)
+		{
+			return PUG_RESULT_GRAPHICS_ERROR;
+		}
+		const uint32_t id = m_vertexBufferSlots.Allocate();
+		if (id == SLOT_INVALID_HANDLE)
+		{
+			return PUG_RESULT_ARRAY_FULL;
+		}
+		m_vertexBufferBytes[SLOT_INDEX(id)] = (uint64_t)vertexStride * vertexCount;
+		m_stats.resourceBytes += m_vertexBufferBytes[SLOT_INDEX(id)];
+		++m_stats.vertexBufferCount;
+		out_vertexBuffer = id;
+		return PUG_RESULT_OK;
+	}
+
+	PUG_RESULT NullRenderer::CreateIndexBuffer(const uint32_t* indexData, uint32_t indexCount, uint32_t& out_indexBuffer)
+	{
+		out_indexBuffer = RENDERER_INVALID_ID;
+		if (indexData == nullptr || indexCount == 0)
+		{
+			return PUG_RESULT_GRAPHICS_ERROR;
+		}
+		const uint32_t id = m_indexBufferSlots.Allocate();
+		if (id == SLOT_INVALID_HANDLE)
+		{
+			return PUG_RESULT_ARRAY_FULL;
+		}
+		m_indexBufferBytes[SLOT_INDEX(id)] = (uint64_t)sizeof(uint32_t) * indexCount;
+		m_stats.resourceBytes += m_indexBufferBytes[SLOT_INDEX(id)];
+		++m_stats.indexBufferCount;
+		out_indexBuffer = id;
+		return PUG_RESULT_OK;
+	}
+
+	PUG_RESULT NullRenderer::CreateTexture(const TextureDesc& desc, const uint8_t* textureData, uint64_t dataSize, uint32_t& out_texture)
+	{
+		out_texture = RENDERER_INVALID_ID;
+		if (textureData == nullptr || dataSize == 0 || desc.width == 0 || desc.height == 0 ||
+			desc.format == TextureFormat_Unknown || desc.format >= TextureFormat_Count)
+		{
+			return PUG_RESULT_GRAPHICS_ERROR;
+		}
+		const uint32_t id = m_textureSlots.Allocate();
+		if (id == SLOT_INVALID_HANDLE)
+		{
+			return PUG_RESULT_ARRAY_FULL;
+		}
+		m_textureBytes[SLOT_INDEX(id)] = dataSize;
+		m_stats.resourceBytes += dataSize;
+		++m_stats.textureCount;
+		out_texture = id;
+		return PUG_RESULT_OK;
+	}
+
+	bool NullRenderer::DestroyVertexBuffer(uint32_t vertexBuffer)
+	{
+		if (!m_vertexBufferSlots.Free(vertexBuffer))
+		{
+			++m_stats.invalidCallCount;
+			return false;
+		}
+		m_stats.resourceBytes -= m_vertexBufferBytes[SLOT_INDEX(vertexBuffer)];
+		--m_stats.vertexBufferCount;
+		return true;
+	}
+
+	bool NullRenderer::DestroyIndexBuffer(uint32_t indexBuffer)
+	{
+		if (!m_indexBufferSlots.Free(indexBuffer))
+		{
+			++m_stats.invalidCallCount;
+			return false;
+		}
+		m_stats.resourceBytes -= m_indexBufferBytes[SLOT_INDEX(indexBuffer)];
+		--m_stats.indexBufferCount;
+		return true;
+	}
+
+	bool NullRenderer::DestroyTexture(uint32_t texture)
+	{
+		if (!m_textureSlots.Free(texture))
+		{
+			++m_stats.invalidCallCount;
+			return false;
+		}
+		m_stats.resourceBytes -= m_textureBytes[SLOT_INDEX(texture)];
+		--m_stats.textureCount;
+		return true;
+	}
+
+	bool NullRenderer::IsValidDraw(const DrawCall& drawCall) const
+	{
+		return m_vertexBufferSlots.IsValid(drawCall.vertexBuffer) &&
+			m_indexBufferSlots.IsValid(drawCall.indexBuffer) &&
+			(drawCall.texture == RENDERER_INVALID_ID || m_textureSlots.IsValid(drawCall.texture)) &&
+			drawCall.pipeline < RENDERER_MAX_PIPELINES &&
+			drawCall.indexCount > 0;
+	}
+
+	void NullRenderer::Submit(const DrawCall& drawCall)
+	{
+		if (!IsValidDraw(drawCall))
+		{//a gpu backend would read freed memory here
+			++m_stats.invalidCallCount;
+			return;
+		}
+		m_drawQueue.Submit(drawCall);
+		++m_stats.drawCount;
+	}
+
+}
+}
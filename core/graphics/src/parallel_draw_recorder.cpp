@@ -0,0 +1,96 @@
+#include "parallel_draw_recorder.h"
+#include "profiler.h"
+
+#include <thread>
+
+namespace pug {
+namespace graphics {
+
+	uint32_t SplitDrawChunks(uint32_t packetCount, uint32_t maxChunks, uint32_t minChunkPackets, DrawChunk* out_chunks)
+	{
+		if (packetCount == 0 || maxChunks == 0)
+		{
+			return 0;
+		}
+		uint32_t chunkCount = minChunkPackets > 0 ? packetCount / minChunkPackets : packetCount;
+		if (chunkCount > maxChunks)
+		{
+			chunkCount = maxChunks;
+		}
+		if (chunkCount == 0)
+		{
+			chunkCount = 1;
+		}
+		for (uint32_t i = 0; i < chunkCount; ++i)
+		{
+			out_chunks[i].begin = (uint32_t)(((uint64_t)packetCount * i) / chunkCount);
+			out_chunks[i].end = (uint32_t)(((uint64_t)packetCount * (i + 1)) / chunkCount);
+		}
+		return chunkCount;
+	}
+
+	uint32_t GetDefaultDrawRecordWorkerCount()
+	{
+		const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		if (hardwareThreads <= 2)
+		{
+			return 1;
+		}
+		return hardwareThreads - 1 < DRAW_RECORD_MAX_WORKERS ? hardwareThreads - 1 : DRAW_RECORD_MAX_WORKERS;
+	}
+
+	ParallelDrawRecorder::ParallelDrawRecorder()
+		: m_workerCount(1)
+		, m_minChunkPackets(DRAW_RECORD_MIN_CHUNK_PACKETS)
+	{
+
+	}
+
+	ParallelDrawRecorder::~ParallelDrawRecorder()
+	{
+		Destroy();
+	}
+
+	void ParallelDrawRecorder::Initialize(uint32_t workerCount, uint32_t minChunkPackets)
+	{
+		Destroy();
+		if (workerCount == 0)
+		{
+			workerCount = GetDefaultDrawRecordWorkerCount();
+		}
+		m_workerCount = workerCount < DRAW_RECORD_MAX_WORKERS ? workerCount : DRAW_RECORD_MAX_WORKERS;
+		m_minChunkPackets = minChunkPackets;
+		if (m_workerCount > 1)
+		{
+			m_jobPool.Initialize(m_workerCount);
+		}
+	}
+
+	void ParallelDrawRecorder::Destroy()
+	{
+		m_jobPool.Destroy();
+		m_workerCount = 1;
+	}
+
+	uint32_t ParallelDrawRecorder::Record(uint32_t packetCount, const DrawChunkFunction& recordChunk)
+	{
+		PUG_PROFILE_FUNCTION();
+		const uint32_t chunkCount = SplitDrawChunks(packetCount, GetMaxChunkCount(), m_minChunkPackets, m_chunks);
+		if (chunkCount == 1 || m_workerCount == 1)
+		{//not worth waking the workers, worker 0 is idle while the calling thread records
+			for (uint32_t i = 0; i < chunkCount; ++i)
+			{
+				recordChunk(i, m_chunks[i], 0);
+			}
+			return chunkCount;
+		}
+		m_jobPool.Run(chunkCount, [&](uint32_t jobIndex, uint32_t workerIndex)
+		{
+			PUG_PROFILE_SCOPE("RecordDrawChunk");
+			recordChunk(jobIndex, m_chunks[jobIndex], workerIndex);
+		});
+		return chunkCount;
+	}
+
+}
+}
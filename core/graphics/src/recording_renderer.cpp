@@ -0,0 +1,136 @@
+#include "recording_renderer.h"
+#include "hash.h"
+
+#include <cstdio>
+
+namespace pug {
+namespace graphics {
+
+	RenderCommand& RecordingRenderer::AddCommand(ERenderCommand type, uint32_t id, PUG_RESULT result)
+	{
+		m_commands.push_back(RenderCommand());
+		RenderCommand& command = m_commands.back();
+		command.type = type;
+		command.frame = (uint32_t)GetStats().frameCount;
+		command.id = id;
+		command.result = result;
+		return command;
+	}
+
+	void RecordingRenderer::Draw()
+	{
+		AddCommand(RenderCommand_Present, RENDERER_INVALID_ID, PUG_RESULT_OK);
+		NullRenderer::Draw();
+	}
+
+	void RecordingRenderer::Destroy()
+	{
+		NullRenderer::Destroy();
+		m_commands.clear();
+		m_commands.shrink_to_fit();
+	}
+
+	PUG_RESULT RecordingRenderer::CreateVertexBuffer(const void* vertexData, uint32_t vertexStride, uint32_t vertexCount, uint32_t& out_vertexBuffer)
+	{
+		const PUG_RESULT result = NullRenderer::CreateVertexBuffer(vertexData, vertexStride, vertexCount, out_vertexBuffer);
+		RenderCommand& command = AddCommand(RenderCommand_CreateVertexBuffer, out_vertexBuffer, result);
+		command.stride = vertexStride;
+		command.count = vertexCount;
+		command.dataSize = (uint64_t)vertexStride * vertexCount;
+		command.dataHash = vertexData != nullptr ? utility::HashBuffer64(vertexData, (size_t)command.dataSize) : 0;
+		return result;
+	}
+
+	PUG_RESULT RecordingRenderer::CreateIndexBuffer(const uint32_t* indexData, uint32_t indexCount, uint32_t& out_indexBuffer)
+	{
+		const PUG_RESULT result = NullRenderer::CreateIndexBuffer(indexData, indexCount, out_indexBuffer);
+		RenderCommand& command = AddCommand(RenderCommand_CreateIndexBuffer, out_indexBuffer, result);
+		command.stride = sizeof(uint32_t);
+		command.count = indexCount;
+		command.dataSize = (uint64_t)sizeof(uint32_t) * indexCount;
+		command.dataHash = indexData != nullptr ? utility::HashBuffer64(indexData, (size_t)command.dataSize) : 0;
+		return result;
+	}
+
+	PUG_RESULT RecordingRenderer::CreateTexture(const TextureDesc& desc, const uint8_t* textureData, uint64_t dataSize, uint32_t& out_texture)
+	{
+		const PUG_RESULT result = NullRenderer::CreateTexture(desc, textureData, dataSize, out_texture);
+		RenderCommand& command = AddCommand(RenderCommand_CreateTexture, out_texture, result);
+		command.stride = desc.width;
+		command.count = desc.height;
+		command.format = desc.format;
+		command.mipCount = desc.mipCount;
+		command.dataSize = dataSize;
+		command.dataHash = textureData != nullptr ? utility::HashBuffer64(textureData, (size_t)dataSize) : 0;
+		return result;
+	}
+
+	bool RecordingRenderer::DestroyVertexBuffer(uint32_t vertexBuffer)
+	{
+		const bool destroyed = NullRenderer::DestroyVertexBuffer(vertexBuffer);
+		AddCommand(RenderCommand_DestroyVertexBuffer, vertexBuffer, destroyed ? PUG_RESULT_OK : PUG_RESULT_GRAPHICS_ERROR);
+		return destroyed;
+	}
+
+	bool RecordingRenderer::DestroyIndexBuffer(uint32_t indexBuffer)
+	{
+		const bool destroyed = NullRenderer::DestroyIndexBuffer(indexBuffer);
+		AddCommand(RenderCommand_DestroyIndexBuffer, indexBuffer, destroyed ? PUG_RESULT_OK : PUG_RESULT_GRAPHICS_ERROR);
+		return destroyed;
+	}
+
+	bool RecordingRenderer::DestroyTexture(uint32_t texture)
+	{
+		const bool destroyed = NullRenderer::DestroyTexture(texture);
+		AddCommand(RenderCommand_DestroyTexture, texture, destroyed ? PUG_RESULT_OK : PUG_RESULT_GRAPHICS_ERROR);
+		return destroyed;
+	}
+
+	void RecordingRenderer::Submit(const DrawCall& drawCall)
+	{
+		RenderCommand& command = AddCommand(RenderCommand_Draw, RENDERER_INVALID_ID, IsValidDraw(drawCall) ? PUG_RESULT_OK : PUG_RESULT_GRAPHICS_ERROR);
+		command.draw = drawCall;
+		NullRenderer::Submit(drawCall);
+	}
+
+	const char* GetRenderCommandName(ERenderCommand type)
+	{
+		static const char* commandNames[] = {
+			"CreateVertexBuffer", "CreateIndexBuffer", "CreateTexture",
+			"DestroyVertexBuffer", "DestroyIndexBuffer", "DestroyTexture",
+			"Draw", "Present"
+		};
+		static_assert(sizeof(commandNames) / sizeof(commandNames[0]) == RenderCommand_Count, "Every render command needs a name");
+		return type < RenderCommand_Count ? commandNames[type] : "Unknown";
+	}
+
+	void FormatRenderCommand(const RenderCommand& command, char* out_text, size_t textSize)
+	{
+		const char* status = command.result == PUG_RESULT_OK ? "" : " FAILED";
+		switch (command.type)
+		{
+		case RenderCommand_CreateVertexBuffer:
+		case RenderCommand_CreateIndexBuffer:
+			snprintf(out_text, textSize, "%u %s id %08x stride %u count %u hash %016llx%s", command.frame, GetRenderCommandName(command.type),
+				command.id, command.stride, command.count, (unsigned long long)command.dataHash, status);
+			break;
+		case RenderCommand_CreateTexture:
+			snprintf(out_text, textSize, "%u %s id %08x %ux%u format %u mips %u size %llu hash %016llx%s", command.frame, GetRenderCommandName(command.type),
+				command.id, command.stride, command.count, command.format, command.mipCount, (unsigned long long)command.dataSize, (unsigned long long)command.dataHash, status);
+			break;
+		case RenderCommand_Draw:
+			snprintf(out_text, textSize, "%u %s vb %08x ib %08x texture %08x indices %u start %u base %d pipeline %u key %016llx%s", command.frame, GetRenderCommandName(command.type),
+				command.draw.vertexBuffer, command.draw.indexBuffer, command.draw.texture, command.draw.indexCount, command.draw.startIndex, command.draw.baseVertex,
+				command.draw.pipeline, (unsigned long long)command.draw.sortKey, status);
+			break;
+		case RenderCommand_Present:
+			snprintf(out_text, textSize, "%u %s", command.frame, GetRenderCommandName(command.type));
+			break;
+		default:
+			snprintf(out_text, textSize, "%u %s id %08x%s", command.frame, GetRenderCommandName(command.type), command.id, status);
+			break;
+		}
+	}
+
+}
+}
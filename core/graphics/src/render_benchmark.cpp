@@ -0,0 +1,207 @@
+#include "render_benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace pug {
+namespace graphics {
+
+	static uint32_t NextRandom(uint32_t& state)
+	{//xorshift32, the same packets every run
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	static double GetElapsedMs(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	static double GetMedian(std::vector<double>& samples)
+	{
+		std::sort(samples.begin(), samples.end());
+		return samples[samples.size() / 2];
+	}
+
+	static void GenerateDrawPackets(uint32_t packetCount, std::vector<DrawCall>& out_packets)
+	{
+		out_packets.resize(packetCount);
+		uint32_t randomState = 0x9E3779B9;
+		for (DrawCall& drawCall : out_packets)
+		{
+			//a material always uses the same pipeline and texture, like it would with real assets
+			const uint32_t layer = NextRandom(randomState) % DRAW_BENCHMARK_LAYER_COUNT;
+			const uint32_t material = NextRandom(randomState) % DRAW_BENCHMARK_MATERIAL_COUNT;
+			const uint32_t mesh = NextRandom(randomState) % DRAW_BENCHMARK_MESH_COUNT;
+			const float depth = (NextRandom(randomState) & 0xFFFFFF) / (float)0xFFFFFF;
+			drawCall.vertexBuffer = mesh + 1;
+			drawCall.indexBuffer = mesh + 1;
+			drawCall.texture = material + 1;
+			drawCall.indexCount = 36;
+			drawCall.startIndex = 0;
+			drawCall.baseVertex = 0;
+			drawCall.pipeline = material % DRAW_BENCHMARK_PIPELINE_COUNT;
+			drawCall.sortKey = MakeDrawSortKey(layer, drawCall.pipeline, material, depth, layer == DRAW_BENCHMARK_LAYER_COUNT - 1);
+		}
+	}
+
+	//stands in for an api command list, every call is encoded into a few words
+	struct EncodingDrawWriter
+	{
+		std::vector<uint32_t>* commands;
+
+		void SetPipeline(uint32_t pipeline) { commands->push_back(1); commands->push_back(pipeline); }
+		void SetVertexBuffer(uint32_t vertexBuffer) { commands->push_back(2); commands->push_back(vertexBuffer); }
+		void SetIndexBuffer(uint32_t indexBuffer) { commands->push_back(3); commands->push_back(indexBuffer); }
+		void SetTexture(uint32_t texture) { commands->push_back(4); commands->push_back(texture); }
+		void DrawIndexed(const DrawCall& drawCall)
+		{
+			commands->push_back(5);
+			commands->push_back(drawCall.indexCount);
+			commands->push_back(drawCall.startIndex);
+			commands->push_back((uint32_t)drawCall.baseVertex);
+		}
+	};
+
+	DrawQueueBenchmarkResult RunDrawQueueBenchmark(uint32_t packetCount, uint32_t iterationCount)
+	{
+		DrawQueueBenchmarkResult result = {};
+		result.packetCount = packetCount;
+		result.iterationCount = iterationCount > 0 ? iterationCount : 1;
+
+		std::vector<DrawCall> packets;
+		GenerateDrawPackets(packetCount, packets);
+
+		DrawQueue queue;
+		queue.Reserve(packetCount);
+		for (const DrawCall& drawCall : packets)
+		{
+			queue.Submit(drawCall);
+		}
+		NullDrawWriter writer;
+		TranslateDrawPackets(queue, 0, queue.GetCount(), writer, result.unsorted);
+
+		std::vector<double> submitSamples, radixSortSamples, stdSortSamples, translateSamples;
+		std::vector<uint64_t> keys(packetCount);
+		for (uint32_t iteration = 0; iteration < result.iterationCount; ++iteration)
+		{
+			queue.Clear();
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			for (const DrawCall& drawCall : packets)
+			{
+				queue.Submit(drawCall);
+			}
+			submitSamples.push_back(GetElapsedMs(start));
+
+			start = std::chrono::steady_clock::now();
+			queue.Sort();
+			radixSortSamples.push_back(GetElapsedMs(start));
+
+			result.sorted = DrawTranslationStats();
+			start = std::chrono::steady_clock::now();
+			TranslateDrawPackets(queue, 0, queue.GetCount(), writer, result.sorted);
+			translateSamples.push_back(GetElapsedMs(start));
+
+			for (uint32_t i = 0; i < packetCount; ++i)
+			{
+				keys[i] = packets[i].sortKey;
+			}
+			start = std::chrono::steady_clock::now();
+			std::stable_sort(keys.begin(), keys.end());
+			stdSortSamples.push_back(GetElapsedMs(start));
+		}
+		result.submitMs = GetMedian(submitSamples);
+		result.radixSortMs = GetMedian(radixSortSamples);
+		result.stdSortMs = GetMedian(stdSortSamples);
+		result.translateMs = GetMedian(translateSamples);
+		return result;
+	}
+
+	ParallelRecordBenchmarkResult RunParallelRecordBenchmark(uint32_t packetCount, uint32_t iterationCount, uint32_t workerCount)
+	{
+		ParallelRecordBenchmarkResult result = {};
+		result.packetCount = packetCount;
+		result.iterationCount = iterationCount > 0 ? iterationCount : 1;
+
+		std::vector<DrawCall> packets;
+		GenerateDrawPackets(packetCount, packets);
+		DrawQueue queue;
+		queue.Reserve(packetCount);
+		for (const DrawCall& drawCall : packets)
+		{
+			queue.Submit(drawCall);
+		}
+		queue.Sort();
+
+		ParallelDrawRecorder recorder;
+		recorder.Initialize(workerCount);
+		result.workerCount = recorder.GetWorkerCount();
+
+		std::vector<uint32_t> chunkCommands[DRAW_RECORD_MAX_CHUNKS];
+		DrawTranslationStats chunkStats[DRAW_RECORD_MAX_CHUNKS];
+		const DrawChunkFunction recordChunk = [&](uint32_t chunkIndex, const DrawChunk& chunk, uint32_t workerIndex)
+		{
+			chunkCommands[chunkIndex].clear();
+			chunkStats[chunkIndex] = DrawTranslationStats();
+			EncodingDrawWriter writer = { &chunkCommands[chunkIndex] };
+			TranslateDrawPackets(queue, chunk.begin, chunk.end, writer, chunkStats[chunkIndex]);
+		};
+
+		//the first round only grows the command buffers
+		const DrawChunk wholeQueue = { 0, queue.GetCount() };
+		recordChunk(0, wholeQueue, 0);
+		recorder.Record(queue.GetCount(), recordChunk);
+
+		std::vector<double> singleThreadSamples, parallelSamples;
+		for (uint32_t iteration = 0; iteration < result.iterationCount; ++iteration)
+		{
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			recordChunk(0, wholeQueue, 0);
+			singleThreadSamples.push_back(GetElapsedMs(start));
+			result.singleThread = chunkStats[0];
+
+			start = std::chrono::steady_clock::now();
+			result.chunkCount = recorder.Record(queue.GetCount(), recordChunk);
+			parallelSamples.push_back(GetElapsedMs(start));
+		}
+		result.parallel = DrawTranslationStats();
+		for (uint32_t i = 0; i < result.chunkCount; ++i)
+		{
+			AddDrawTranslationStats(chunkStats[i], result.parallel);
+		}
+		recorder.Destroy();
+
+		result.singleThreadMs = GetMedian(singleThreadSamples);
+		result.parallelMs = GetMedian(parallelSamples);
+		return result;
+	}
+
+	void FormatDrawQueueBenchmark(const DrawQueueBenchmarkResult& result, char* out_text, size_t textSize)
+	{
+		snprintf(out_text, textSize,
+			"Draw queue, %u packets, median of %u: submit %.3fms radix sort %.3fms (std::stable_sort %.3fms) translate %.3fms\n"
+			"State changes unsorted: pipeline %u vertex buffer %u index buffer %u texture %u\n"
+			"State changes sorted:   pipeline %u vertex buffer %u index buffer %u texture %u",
+			result.packetCount, result.iterationCount, result.submitMs, result.radixSortMs, result.stdSortMs, result.translateMs,
+			result.unsorted.pipelineChanges, result.unsorted.vertexBufferChanges, result.unsorted.indexBufferChanges, result.unsorted.textureChanges,
+			result.sorted.pipelineChanges, result.sorted.vertexBufferChanges, result.sorted.indexBufferChanges, result.sorted.textureChanges);
+	}
+
+	void FormatParallelRecordBenchmark(const ParallelRecordBenchmarkResult& result, char* out_text, size_t textSize)
+	{
+		snprintf(out_text, textSize,
+			"Draw recording, %u packets, median of %u: 1 thread %.3fms, %u threads in %u chunks %.3fms (%.2fx)\n"
+			"State changes 1 thread: pipeline %u vertex buffer %u index buffer %u texture %u\n"
+			"State changes chunked:  pipeline %u vertex buffer %u index buffer %u texture %u",
+			result.packetCount, result.iterationCount, result.singleThreadMs, result.workerCount, result.chunkCount, result.parallelMs,
+			result.parallelMs > 0.0 ? result.singleThreadMs / result.parallelMs : 0.0,
+			result.singleThread.pipelineChanges, result.singleThread.vertexBufferChanges, result.singleThread.indexBufferChanges, result.singleThread.textureChanges,
+			result.parallel.pipelineChanges, result.parallel.vertexBufferChanges, result.parallel.indexBufferChanges, result.parallel.textureChanges);
+	}
+
+}
+}
@@ -9,7 +9,7 @@
 #ifdef _DEBUG
 #define PUG_TRY(func)	PUG_MULTI_LINE_MACRO_START																																		\
 						PUG_RESULT pug_try_res = func;																																		\
-						if(pug_try_res != PUG_RESULT_OK){pug::log::Warning(#func " failed with code: %d.\n" "File: " __FILE__ "\n" "Line: %d", pug_try_res, (unsigned)(__LINE__));}			\
+						if(pug_try_res != PUG_RESULT_OK){PUG_WARNING(#func " failed with code: %d.\n" "File: " __FILE__ "\n" "Line: %d", pug_try_res, (unsigned)(__LINE__));}			\
 						PUG_MULTI_LINE_MACRO_END
 #else
 #define PUG_TRY(func) func;
@@ -2,16 +2,100 @@
 #include "logger.h"
 #include "window.h"
 #include "dx12_renderer.h"
+#include "null_renderer.h"
+#include "render_benchmark.h"
+#include "frame_stats.h"
+#include "profiler.h"
 #include "vmath\vmath.h"
 
+#include <cstring>
+#include <cstdlib>
+
 using namespace pug;
 using namespace pug::graphics;
 
-int main()
+#define FRAME_STATS_REPORT_INTERVAL 600//frames, about 10 seconds at 60 hz
+#define DRAW_BENCHMARK_ITERATIONS 50
+
+//ends the capture started for -profile and writes it as a Chrome trace
+static void WriteProfile(const char* profileFilePath)
+{
+	if (profileFilePath == nullptr)
+	{
+		return;
+	}
+	utility::EndProfileCapture();
+	if (utility::WriteChromeTrace(profileFilePath))
+	{
+		log::Info("Wrote profile to %s, %d events dropped", profileFilePath, (uint32_t)utility::GetProfilerDroppedEventCount());
+	}
+	else
+	{
+		log::Error("Failed to write profile to %s!", profileFilePath);
+	}
+}
+
+int main(int argc, char* argv[])
 {
 	log::StartLog("x64/Debug", log::BreakLevel_Warning);
 
-	Window* window = Window::Create("MY_WINDOW_NAME", vmath::Int2(800, 640));
+	const char* frameStatsFilePath = nullptr;//-framestats <file.csv> writes every report to a csv file as well
+	bool headless = false;//-headless runs the main loop without a window or gpu, on the null renderer
+	uint64_t frameLimit = 0;//-frames <count> quits after that many frames, 0 runs until the process is closed
+	uint32_t benchmarkPackets = 0;//-benchmark <packets> times the draw queue and draw recording on the cpu and quits
+	uint32_t recordWorkers = 0;//-recordworkers <count> for the benchmark and the headless renderer, 0 picks the default
+	const char* profileFilePath = nullptr;//-profile <trace.json> captures the whole run, open it in chrome://tracing or ui.perfetto.dev
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!strcmp(argv[i], "-framestats") && i + 1 < argc)
+		{
+			frameStatsFilePath = argv[++i];
+		}
+		else if (!strcmp(argv[i], "-headless"))
+		{
+			headless = true;
+		}
+		else if (!strcmp(argv[i], "-frames") && i + 1 < argc)
+		{
+			frameLimit = strtoull(argv[++i], nullptr, 10);
+		}
+		else if (!strcmp(argv[i], "-benchmark") && i + 1 < argc)
+		{
+			benchmarkPackets = (uint32_t)strtoul(argv[++i], nullptr, 10);
+		}
+		else if (!strcmp(argv[i], "-recordworkers") && i + 1 < argc)
+		{
+			recordWorkers = (uint32_t)strtoul(argv[++i], nullptr, 10);
+		}
+		else if (!strcmp(argv[i], "-profile") && i + 1 < argc)
+		{
+			profileFilePath = argv[++i];
+		}
+	}
+	if (profileFilePath != nullptr)
+	{
+		utility::SetProfilerThreadName("main");
+		utility::BeginProfileCapture();
+	}
+	if (benchmarkPackets > 0)
+	{
+		char benchmarkText[1024];
+		FormatDrawQueueBenchmark(RunDrawQueueBenchmark(benchmarkPackets, DRAW_BENCHMARK_ITERATIONS), benchmarkText, sizeof(benchmarkText));
+		log::Info("%s", benchmarkText);
+		FormatParallelRecordBenchmark(RunParallelRecordBenchmark(benchmarkPackets, DRAW_BENCHMARK_ITERATIONS, recordWorkers), benchmarkText, sizeof(benchmarkText));
+		log::Info("%s", benchmarkText);
+		WriteProfile(profileFilePath);
+		log::EndLog();
+
+		return 0;
+	}
+	if (!utility::StartFrameStats(FRAME_STATS_REPORT_INTERVAL, frameStatsFilePath))
+	{
+		log::Warning("Failed to open %s, frame statistics are only logged", frameStatsFilePath);
+		utility::StartFrameStats(FRAME_STATS_REPORT_INTERVAL, nullptr);
+	}
+
+	Window* window = headless ? Window::CreateHeadless(vmath::Int2(800, 640)) : Window::Create("MY_WINDOW_NAME", vmath::Int2(800, 640));
 	if (!window)
 	{
 		log::Error("Error initializing window.");
@@ -20,7 +104,7 @@ int main()
 		return 0;
 	}
 
-	DX12Renderer* renderer = new DX12Renderer();
+	IRenderer* renderer = headless ? (IRenderer*)new NullRenderer(recordWorkers) : (IRenderer*)new DX12Renderer();
 	if (!PUG_SUCCEEDED(renderer->Initialize(window)))
 	{
 		log::Error("Error initializing the renderer.");
@@ -33,13 +117,26 @@ int main()
 	}
 
 	// Main loop
-	while (true)
+	for (uint64_t frame = 0; frameLimit == 0 || frame < frameLimit; ++frame)
 	{
-		window->DispatchMessages();
+		utility::BeginFrameTiming();
+		{
+			utility::FramePhaseScope phaseScope(utility::FramePhase_MessagePump);
+			window->DispatchMessages();
+		}
 		renderer->Draw();
+		if (utility::EndFrameTiming())
+		{
+			char reportText[1024];
+			utility::FormatFrameStatsReport(utility::GetFrameStatsReport(), reportText, sizeof(reportText));
+			log::Info("%s", reportText);
+		}
 	}
 
+	utility::StopFrameStats();
 	renderer->Destroy();
 	window->Destroy();
+	WriteProfile(profileFilePath);
+	log::EndLog();
 	return 0;
 }
@@ -1,9 +1,15 @@
 #pragma once
 #include "vorpal_result_codes.h"
 #include "vorpal_typedef.h"
+#include "asset_processor/asset_types.h"
+#include "utility/const_hash.h"
 
 #include <experimental\filesystem>
 
+//id of an asset path known at compile time, PUG_ASSET_ID("mesh/crate.fbx") hashes the path while compiling
+//so the AssetID overloads below skip all path and string handling once the asset is loaded
+#define PUG_ASSET_ID(relativeAssetPath) (vpl::resource::AssetID{ PUG_CONST_HASH128(relativeAssetPath), relativeAssetPath })
+
 namespace vpl{
 
 namespace graphics{
@@ -19,18 +25,79 @@ namespace resource{
 		char guid[20];
 		uint32_t id;
 		uint32_t type;
-		float padding;
+		uint32_t next;//index of the next loaded entry with the same guid, INVALID_ID terminates the chain
 	};//32 bytes, hmmm alignment *drool*
 
+	struct AssetID
+	{
+		pug::utility::Hash128 hash;//what version 3 libraries store as guid
+		const char* relativeAssetPath;//only read to load the asset or for libraries that still use sha1 guids
+	};
+
+	typedef uint32_t AssetLoadHandle;
+
+	enum class EAssetLoadStatus : uint32_t
+	{
+		Unknown = 0,//invalid handle, or the request finished long ago and its slot was reused
+		Pending,
+		Loaded,
+		Failed,
+	};
+
+	//called from UpdateAssetLibrarian on the main thread
+	typedef void(*AssetLoadCallback)(AssetLoadHandle handle, EAssetLoadStatus status, void* userData);
 
 	RESULT InitAssetLibrarian();
 	RESULT ClearAssetLibrarian();
 
 	RESULT LoadAsset(
 		std::experimental::filesystem::path relativeAssetPath);//pass by copy
+	RESULT LoadAsset(
+		const AssetID& assetID);
+	//frees the asset once nothing references it anymore, the keep alive budget is ignored
+	RESULT UnloadAsset(
+		const std::experimental::filesystem::path& relativeAssetPath);
 	RESULT UnloadAsset(
+		const AssetID& assetID);
+	//number of unreferenced assets kept loaded, least recently released assets are freed first
+	//0 frees assets as soon as their last reference is released
+	RESULT SetAssetKeepAliveBudget(
+		const uint32_t maxUnreferencedAssets);
+	//bytes of vertex, index and texture data a type may keep resident, 0 is unlimited
+	//loads evict unreferenced assets of the type, least recently used first, including loaded assets that were never acquired
+	RESULT SetAssetResidencyBudget(
+		const vpl::EAssetType type,
+		const uint64_t budgetBytes);
+	RESULT GetAssetResidency(
+		const vpl::EAssetType type,
+		uint64_t& out_residentBytes,
+		uint64_t& out_budgetBytes);
+	uint32_t GetAssetReferenceCount(
 		const std::experimental::filesystem::path& relativeAssetPath);
+	uint32_t GetAssetReferenceCount(
+		const AssetID& assetID);
 
+	//queue an asset to be read and decoded on the streaming threads, higher priorities are loaded first
+	//requests for an asset that is already in flight return the handle of that request
+	RESULT LoadAssetAsync(
+		std::experimental::filesystem::path relativeAssetPath,//pass by copy
+		const uint32_t priority,
+		AssetLoadHandle& out_handle,
+		AssetLoadCallback callback = nullptr,
+		void* userData = nullptr);
+	RESULT LoadAssetAsync(
+		const AssetID& assetID,
+		const uint32_t priority,
+		AssetLoadHandle& out_handle,
+		AssetLoadCallback callback = nullptr,
+		void* userData = nullptr);
+	EAssetLoadStatus GetAssetLoadStatus(
+		const AssetLoadHandle handle);
+	//call once per frame, creates the gpu resources for decoded assets until the budget is used up
+	RESULT UpdateAssetLibrarian(
+		const uint32_t finalizeBudgetMicroseconds);
+
+	//every Get takes a reference on the asset that has to be given back with the matching Release
 	RESULT GetMeshAsset(
 		const std::experimental::filesystem::path& relativeAssetPath,
 		vpl::graphics::Mesh* out_meshes,
@@ -38,16 +105,30 @@ namespace resource{
 		vpl::graphics::Transform* out_meshOffsets,
 		const uint32_t maxMeshCount,
 		uint32_t& out_meshCount);
+	RESULT GetMeshAsset(
+		const AssetID& assetID,
+		vpl::graphics::Mesh* out_meshes,
+		vpl::graphics::Material* out_materials,
+		vpl::graphics::Transform* out_meshOffsets,
+		const uint32_t maxMeshCount,
+		uint32_t& out_meshCount);
 	RESULT GetMeshAsset(
 		const std::experimental::filesystem::path& relativeAssetPath, 
 		vpl::graphics::Mesh& out_result,
 		vpl::graphics::Material& out_material);
+	RESULT GetMeshAsset(
+		const AssetID& assetID,
+		vpl::graphics::Mesh& out_result,
+		vpl::graphics::Material& out_material);
 	RESULT ReleaseMeshAsset(
 		vpl::graphics::Mesh& meshAsset);
 
 	RESULT GetTextureAsset(
 		const std::experimental::filesystem::path& relativeAssetPath,
 		vpl::resource::TextureAssetID& out_result);
+	RESULT GetTextureAsset(
+		const AssetID& assetID,
+		vpl::resource::TextureAssetID& out_result);
 	RESULT DereferenceTextureAssetID(
 		const vpl::resource::TextureAssetID textureAssetID,
 		vpl::graphics::TextureID& out_result);
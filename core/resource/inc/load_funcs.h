@@ -11,12 +11,13 @@ namespace resource{
 
 	//struct so we can return the data needed from the LoadMesh function
 	//and parse it safely in the asset librarian
+	//texture paths point into the string table of the loaded file, nullptr if the material has no such texture
 	struct RawMeshMaterial
 	{
-		std::experimental::filesystem::path diffuseTexturePath;//albedo
-		std::experimental::filesystem::path specularTexturePath;//roughness
-		std::experimental::filesystem::path normalTexturePath;//normal or bump
-		std::experimental::filesystem::path emissiveTexturePath;//emissive
+		const char* diffuseTexturePath;//albedo
+		const char* specularTexturePath;//roughness
+		const char* normalTexturePath;//normal or bump
+		const char* emissiveTexturePath;//emissive
 
 		vmath::Vector4 ambient;
 		vmath::Vector4 diffuse;
@@ -24,15 +25,11 @@ namespace resource{
 		vmath::Vector4 emissive;
 	};
 
-	struct SceneNode
-	{
-		vmath::Matrix4 transform;//offset
-		uint32_t materialIndex;
-		uint32_t meshIndex;
-	};
-
+	//reads a cooked .pmesh file (see asset_processor/mesh_format.h) into a single allocation
+	//out_data owns it, every other output points into it and is freed with UnloadMesh(out_data)
 	RESULT LoadMesh(
 		const std::experimental::filesystem::path& path,
+		uint8_t*& out_data,
 		vpl::graphics::Vertex**& out_vertices,
 		uint32_t*& out_vertexCount,
 		uint32_t**& out_indices,
@@ -40,12 +37,7 @@ namespace resource{
 		vpl::resource::RawMeshMaterial*& out_rawMaterials,
 		uint32_t& out_meshCount);
 	RESULT UnloadMesh(
-		vpl::graphics::Vertex** vertices,
-		uint32_t* vertexCounts,
-		uint32_t** indices,
-		uint32_t* indexCounts,
-		RawMeshMaterial* rawMaterials,
-		const uint32_t meshCount);
+		uint8_t* data);
 	
 	RESULT LoadDDSTexture(
 		const std::experimental::filesystem::path& path,
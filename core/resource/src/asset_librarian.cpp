@@ -9,12 +9,24 @@
 
 #include "logger/logger.h"
 #include "utility/hash.h"
+#include "utility/hash_index.h"
+#include "utility/mapped_file.h"
+#include "utility/slot_allocator.h"
 #include "utility/path.h"
+#include "utility/profiler.h"
+#include "utility/allocator.h"
 #include "asset_processor/asset_types.h"
+#include "asset_processor/library_format.h"
 
 #include <cassert>
 #include <experimental/filesystem>
-#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+#include <chrono>
 
 using namespace std::experimental::filesystem;
 using namespace std;
@@ -26,19 +38,12 @@ using namespace vpl;
 
 #define MAX_ASSETS 2048
 
-#define ASSET_ENTRY_AVAILABLE(i) (g_loadedAssetEntries[i].type == 0)
-#define MESH_INDEX_AVAILABLE(i) ((g_meshes[i].vertices == INVALID_ID) && (g_meshes[i].indices == INVALID_ID))
-#define TEXTURE_INDEX_AVAILABLE(i) ((g_textures[i] == INVALID_ID))
-#define MATERIAL_INDEX_AVAILABLE(i) ((g_materials[i].isInitialized == 0))
-#define MESH_VALID(m) ((m.vertices != INVALID_ID) && (m.indices != INVALID_ID))
+#define ASSET_STREAMING_THREAD_COUNT 2
+#define ASSET_REQUEST_SLOT_BITS 8
+#define MAX_ASSET_REQUESTS (1 << ASSET_REQUEST_SLOT_BITS)
+#define ASSET_REQUEST_SLOT(handle) ((handle) & (MAX_ASSET_REQUESTS - 1))
 
-//entries written by the asset cook tool
-struct LibraryAssetEntry
-{
-	char assetGUID[SHA1_HASH_BYTES];//20 bytes
-	uint32_t type;
-	char extension[8];
-};//32 bytes, hmmm alignment *drool*
+#define MESH_VALID(m) ((m.vertices != INVALID_ID) && (m.indices != INVALID_ID))
 
 static bool isInitialized = false;
 static /*VPL_ALIGN(16)*/ Material g_materials[MAX_ASSETS];
@@ -52,11 +57,143 @@ static /*VPL_ALIGN(16)*/ TextureID g_textures[MAX_ASSETS];
 static /*VPL_ALIGN(32)*/ Asset g_loadedAssetEntries[MAX_ASSETS * ((uint32_t)EAssetType::NumAssetTypes - 1)];
 //static uint32_t g_loadedAssetCount;
 //
-static /*VPL_ALIGN(32)*/ LibraryAssetEntry g_assetLibrary[MAX_ASSETS];
+//slots of the tables above, every id stored in an Asset or handed out is a generational handle from these
+static pug::utility::SlotAllocator g_assetEntrySlots;
+static pug::utility::SlotAllocator g_meshSlots;
+static pug::utility::SlotAllocator g_textureSlots;
+static pug::utility::SlotAllocator g_materialSlots;
+//
+//points straight into the mapped library file, entries are never copied
+static const LibraryAssetEntry* g_assetLibrary;
 static uint32_t g_assetLibraryEntriesCount;
+static pug::utility::MappedFile g_assetLibraryFile;
+//version 2 libraries are sorted and searched through the fanout table in the mapped header,
+//version 1 libraries fall back to a hash index (guid -> index into g_assetLibrary) built at startup
+static const LibraryFileHeader* g_assetLibraryHeader;
+static pug::utility::HashIndex g_libraryIndex;
+//decides how paths are turned into guids, libraries cooked before version 3 use sha1
+static uint32_t g_assetLibraryVersion;
+//guid -> handle of the first entry of the loaded asset chain in g_loadedAssetEntries
+static pug::utility::HashIndex g_loadedAssetIndex;
+//
+struct AssetResidency
+{
+	uint32_t referenceCount;
+	uint32_t unloadRequested;//freed as soon as the last reference is released
+	uint32_t isCached;//unreferenced and kept alive in the lru list
+	uint32_t lruPrev;//more recently released
+	uint32_t lruNext;//less recently released
+	EAssetType type;//type of the first entry, decides which budget the asset counts against
+	uint64_t residentBytes;//vertex, index and texture data uploaded for the whole chain
+	uint64_t lastUsed;//g_residencyClock when the asset was last loaded, requested or released
+};
+//indexed by the slot of the first entry of a loaded asset chain
+static AssetResidency g_assetResidency[VPL_COUNT_OF(g_loadedAssetEntries)];
+//first entry of the asset chain that owns a mesh or texture, to find the asset from the handles we give out
+static uint32_t g_meshOwners[MAX_ASSETS];
+static uint32_t g_textureOwners[MAX_ASSETS];
+//meshes are handed out by value, ReleaseMeshAsset finds the mesh slot through its vertex buffer
+static std::unordered_map<VertexBufferID, uint32_t> g_meshSlotsByVertexBuffer;
+//textures referenced by a material, diffuse, specular, normal, emissive
+static TextureAssetID g_materialTextures[MAX_ASSETS][4];
+//unreferenced assets, most recently released first
+static uint32_t g_lruHead;
+static uint32_t g_lruTail;
+static uint32_t g_lruCount;
+static uint32_t g_keepAliveBudget;
+//bytes of gpu data per asset type, a budget of 0 is unlimited
+static uint64_t g_residentBytes[(uint32_t)EAssetType::NumAssetTypes];
+static uint64_t g_residencyBudgets[(uint32_t)EAssetType::NumAssetTypes];
+//orders unreferenced assets for eviction, assets used at or after g_syncImportStamp belong to the mesh being imported
+static uint64_t g_residencyClock;
+static uint64_t g_syncImportStamp = UINT64_MAX;
 //
 static path g_currPath;
 
+//async loading, requests are issued and finalized on the main thread,
+//the streaming threads only read and decode files
+enum class ERequestState : uint32_t
+{
+	Free = 0,
+	Queued,//waiting for a streaming thread
+	Decoding,//owned by a streaming thread
+	Decoded,//waiting to be finalized on the main thread
+	WaitingForDependencies,//mesh uploaded, waiting for its textures
+	Done,//kept around so the handle can still be queried, recycled when the pool runs out
+};
+
+struct TextureLoadData
+{
+	uint8_t* data;
+	uint8_t* textureData;
+	uint64_t dataSize;
+	DDS_HEADER header;
+};
+
+struct MeshLoadData
+{
+	uint8_t* data;
+	Vertex** vertices;
+	uint32_t* vertexCount;
+	uint32_t** indices;
+	uint32_t* indexCount;
+	RawMeshMaterial* rawMaterials;
+	uint32_t meshCount;
+};
+
+struct AssetLoadCallbackEntry
+{
+	AssetLoadCallback callback;
+	void* userData;
+};
+
+struct AssetLoadRequest
+{
+	char guid[LIBRARY_GUID_BYTES];
+	AssetLoadHandle handle;
+	uint32_t priority;
+	EAssetType type;
+	ERequestState state;//guarded by g_streamingLock, the streaming threads check it for stale queue entries
+	RESULT result;
+	EAssetLoadStatus status;
+	path relativeAssetPath;
+	path absoluteCookedAssetPath;
+	TextureLoadData texture;
+	MeshLoadData mesh;
+	vector<uint32_t> meshIndices;
+	vector<AssetLoadHandle> dependencies;
+	vector<AssetLoadCallbackEntry> callbacks;
+	uint64_t dependencyStamp;//main thread only, g_residencyClock when the dependencies were requested, 0 when not waiting
+};
+
+struct AssetQueueItem
+{
+	uint32_t priority;
+	AssetLoadHandle handle;//lower handles were issued first
+
+	bool operator<(const AssetQueueItem& other) const
+	{//highest priority first, first come first served within a priority
+		return priority != other.priority ? priority < other.priority : (handle >> ASSET_REQUEST_SLOT_BITS) > (other.handle >> ASSET_REQUEST_SLOT_BITS);
+	}
+};
+
+static AssetLoadRequest g_requests[MAX_ASSET_REQUESTS];
+static uint32_t g_requestSequence;
+//guid -> slot of the request that is loading it, dedupes requests for assets in flight
+static pug::utility::HashIndex g_pendingRequestIndex;
+static priority_queue<AssetQueueItem> g_decodeQueue;
+static priority_queue<AssetQueueItem> g_finalizeQueue;
+static mutex g_streamingLock;
+static condition_variable g_streamingCondition;
+static bool g_streamingShutdown;
+static thread g_streamingThreads[ASSET_STREAMING_THREAD_COUNT];
+
+//the fixed tables above are counted as resource memory while the librarian is initialized
+static const int64_t g_staticTableBytes =
+	sizeof(g_materials) + sizeof(g_meshOffsets) + sizeof(g_meshes) + sizeof(g_textures) +
+	sizeof(g_loadedAssetEntries) + sizeof(g_assetResidency) + sizeof(g_meshOwners) + sizeof(g_textureOwners) +
+	sizeof(g_materialTextures) + sizeof(g_requests);
+
 EAssetType ConvertType(uint32_t type)
 {
 	switch (type)
@@ -72,75 +209,297 @@ void DeleteEntry(uint32_t index)
 
 }
 
-uint32_t FindAvailableAssetEntryIndex()
+//the guid of a path relative to the library folder, matching what the cooker wrote into the mapped library
+//Hash128 ids are taken over '/' separated paths so they match PUG_ASSET_ID, sha1 guids over the native path
+void ComputeAssetGUID(const path& relativeAssetPath, char* out_guid)
 {
-	uint32_t index = 0;
-	for (uint32_t i = 0; i < VPL_COUNT_OF(g_loadedAssetEntries); ++i)
+	if (g_assetLibraryVersion >= LIBRARY_HASH128_GUID_VERSION)
 	{
-		if (i != INVALID_ID && ASSET_ENTRY_AVAILABLE(i))
-		{
-			index = i;
-			break;
-		}
+		const string pathString = relativeAssetPath.generic_string();
+		pug::utility::WriteHash128(pug::utility::HashBuffer128(pathString.data(), pathString.size()), out_guid, LIBRARY_GUID_BYTES);
+	}
+	else
+	{
+		SHA1(relativeAssetPath.string(), out_guid, LIBRARY_GUID_BYTES);
+	}
+}
+
+//precomputed ids only need the path for libraries cooked with sha1 guids
+void ComputeAssetGUID(const AssetID& assetID, char* out_guid)
+{
+	if (g_assetLibraryVersion >= LIBRARY_HASH128_GUID_VERSION)
+	{
+		pug::utility::WriteHash128(assetID.hash, out_guid, LIBRARY_GUID_BYTES);
+	}
+	else
+	{
+		ComputeAssetGUID(path(assetID.relativeAssetPath), out_guid);
 	}
-	return index;
 }
 
 uint32_t FindAssetEntryIndexWithHash(const char* hash, size_t hashSize)
 {
+	VPL_ASSERT(hashSize == LIBRARY_GUID_BYTES, "Asset guids are expected to be library guids!");
+	if (g_assetLibraryHeader != nullptr)
+	{
+		return FindLibraryEntry(*g_assetLibraryHeader, g_assetLibrary, hash);
+	}
 	uint32_t foundIndex = -1;
-	for (int32_t i = 0; (uint32_t)i < g_assetLibraryEntriesCount; ++i)
+	g_libraryIndex.Find(hash, foundIndex);
+	return foundIndex;
+}
+
+uint32_t FindLoadedAssetEntryIndex(const char* hash)
+{
+	uint32_t head = INVALID_ID;
+	g_loadedAssetIndex.Find(hash, head);
+	return head;
+}
+
+//append a filled in entry to the chain of loaded entries that share its guid,
+//appending keeps the entries in import order so meshes and materials stay paired
+//returns the first entry of the chain
+uint32_t LinkLoadedAssetEntry(uint32_t assetIndex)
+{
+	Asset& entry = g_loadedAssetEntries[SLOT_INDEX(assetIndex)];
+	entry.next = INVALID_ID;
+
+	const uint32_t head = FindLoadedAssetEntryIndex(entry.guid);
+	if (head == INVALID_ID)
 	{
-		if (memcmp(g_assetLibrary[i].assetGUID, hash, sizeof(hash)) == 0)
-		{//entry found
-			foundIndex = i;
-			break;
-		}
+		g_loadedAssetIndex.Insert(entry.guid, assetIndex);
+		g_assetResidency[SLOT_INDEX(assetIndex)] = {};
+		g_assetResidency[SLOT_INDEX(assetIndex)].lastUsed = ++g_residencyClock;
+		return assetIndex;
 	}
+	uint32_t curr = head;
+	while (g_loadedAssetEntries[SLOT_INDEX(curr)].next != INVALID_ID)
+	{
+		curr = g_loadedAssetEntries[SLOT_INDEX(curr)].next;
+	}
+	g_loadedAssetEntries[SLOT_INDEX(curr)].next = assetIndex;
+	return head;
+}
 
-	return foundIndex;
+RESULT DestroyMeshData(Mesh& mesh)
+{
+	if (MESH_VALID(mesh))
+	{
+		VPL_TRY(graphics::DestroyVertexBuffer(mesh.vertices));
+		VPL_TRY(graphics::DestroyIndexBuffer(mesh.indices));
+		mesh.vertices = INVALID_ID;
+		mesh.indices = INVALID_ID;
+		mesh.vertexCount = 0;
+		mesh.indexCount = 0;
+		return RESULT_OK;
+	}
+	return RESULT_INVALID_ARGUMENTS;
 }
 
-uint32_t FindMeshIndex()
+void FreeMeshSlot(uint32_t mesh)
 {
-	uint32_t index = 0;
-	for (uint32_t i = 0; i < MAX_ASSETS; ++i)
+	if (MESH_VALID(g_meshes[SLOT_INDEX(mesh)]))
+	{
+		g_meshSlotsByVertexBuffer.erase(g_meshes[SLOT_INDEX(mesh)].vertices);
+	}
+	DestroyMeshData(g_meshes[SLOT_INDEX(mesh)]);
+	g_meshSlots.Free(mesh);
+}
+
+RESULT DestroyTextureData(TextureAssetID textureAsset)
+{
+	if (g_textures[SLOT_INDEX(textureAsset)] != INVALID_ID)
+	{
+		VPL_TRY(graphics::DestroyTexture(g_textures[SLOT_INDEX(textureAsset)]));
+		g_textures[SLOT_INDEX(textureAsset)] = INVALID_ID;
+		return RESULT_OK;
+	}
+	return RESULT_INVALID_ARGUMENTS;
+}
+
+void RemoveFromLRU(uint32_t head)
+{
+	AssetResidency& residency = g_assetResidency[SLOT_INDEX(head)];
+	if (residency.lruPrev != INVALID_ID)
+	{
+		g_assetResidency[SLOT_INDEX(residency.lruPrev)].lruNext = residency.lruNext;
+	}
+	else
+	{
+		g_lruHead = residency.lruNext;
+	}
+	if (residency.lruNext != INVALID_ID)
+	{
+		g_assetResidency[SLOT_INDEX(residency.lruNext)].lruPrev = residency.lruPrev;
+	}
+	else
+	{
+		g_lruTail = residency.lruPrev;
+	}
+	residency.lruPrev = INVALID_ID;
+	residency.lruNext = INVALID_ID;
+	residency.isCached = 0;
+	--g_lruCount;
+}
+
+void PushFrontLRU(uint32_t head)
+{
+	AssetResidency& residency = g_assetResidency[SLOT_INDEX(head)];
+	residency.lruPrev = INVALID_ID;
+	residency.lruNext = g_lruHead;
+	if (g_lruHead != INVALID_ID)
+	{
+		g_assetResidency[SLOT_INDEX(g_lruHead)].lruPrev = head;
+	}
+	else
+	{
+		g_lruTail = head;
+	}
+	g_lruHead = head;
+	residency.isCached = 1;
+	++g_lruCount;
+}
+
+void ReleaseAssetReference(uint32_t head);
+
+//free the cpu and gpu data of every entry in the chain, references held by the asset are released
+void FreeLoadedAsset(uint32_t head)
+{
+	if (g_assetResidency[SLOT_INDEX(head)].isCached)
+	{
+		RemoveFromLRU(head);
+	}
+	g_residentBytes[(uint32_t)g_assetResidency[SLOT_INDEX(head)].type] -= g_assetResidency[SLOT_INDEX(head)].residentBytes;
+	g_assetResidency[SLOT_INDEX(head)] = {};
+	g_loadedAssetIndex.Remove(g_loadedAssetEntries[SLOT_INDEX(head)].guid);
+
+	uint32_t curr = head;
+	while (curr != INVALID_ID)
 	{
-		if (i != INVALID_ID && MESH_INDEX_AVAILABLE(i))
+		Asset& entry = g_loadedAssetEntries[SLOT_INDEX(curr)];
+		if (entry.type == (uint32_t)EAssetType::Mesh)
 		{
-			index = i;
-			break;
+			g_meshOwners[SLOT_INDEX(entry.id)] = INVALID_ID;
+			FreeMeshSlot(entry.id);
+		}
+		else if (entry.type == (uint32_t)EAssetType::Texture)
+		{
+			g_textureOwners[SLOT_INDEX(entry.id)] = INVALID_ID;
+			DestroyTextureData(entry.id);
+			g_textureSlots.Free(entry.id);
 		}
+		else if (entry.type == (uint32_t)EAssetType::Material)
+		{
+			g_materials[SLOT_INDEX(entry.id)].isInitialized = 0;
+			g_materialSlots.Free(entry.id);
+			for (TextureAssetID& texture : g_materialTextures[SLOT_INDEX(entry.id)])
+			{
+				if (texture != INVALID_ID && g_textureOwners[SLOT_INDEX(texture)] != INVALID_ID)
+				{
+					ReleaseAssetReference(g_textureOwners[SLOT_INDEX(texture)]);
+				}
+				texture = INVALID_ID;
+			}
+		}
+		g_assetEntrySlots.Free(curr);
+		curr = entry.next;
+		entry = {};
 	}
-	return index;
 }
 
-uint32_t FindTextureIndex()
+void AddResidentBytes(uint32_t head, EAssetType type, uint64_t bytes)
+{
+	AssetResidency& residency = g_assetResidency[SLOT_INDEX(head)];
+	residency.type = type;
+	residency.residentBytes += bytes;
+	g_residentBytes[(uint32_t)type] += bytes;
+}
+
+//assets used at or after the returned stamp are waited on by a mesh import and must stay loaded
+uint64_t GetEvictionStamp()
 {
-	uint32_t index = 0;
-	for (uint32_t i = 0; i < VPL_COUNT_OF(g_textures); ++i)
+	uint64_t stamp = g_syncImportStamp;
+	for (const AssetLoadRequest& request : g_requests)
 	{
-		if (i != INVALID_ID && TEXTURE_INDEX_AVAILABLE(i))
+		if (request.dependencyStamp != 0 && request.dependencyStamp < stamp)
 		{
-			index = i;
-			break;
+			stamp = request.dependencyStamp;
 		}
 	}
-	return index;
+	return stamp;
 }
 
-uint32_t FindMaterialIndex()
+//evict unreferenced assets of the same type, least recently used first, until the new data fits the budget
+//this includes assets that were loaded but never acquired, a load that still does not fit goes over budget
+void MakeRoomForAsset(EAssetType type, uint64_t bytes)
 {
-	uint32_t index = 0;
-	for (uint32_t i = 0; i < VPL_COUNT_OF(g_materials); ++i)
+	const uint64_t budget = g_residencyBudgets[(uint32_t)type];
+	if (budget == 0)
 	{
-		if (i != INVALID_ID && MATERIAL_INDEX_AVAILABLE(i))
+		return;
+	}
+	const uint64_t evictionStamp = GetEvictionStamp();
+	while (g_residentBytes[(uint32_t)type] + bytes > budget)
+	{//only runs when over budget, a scan of the residency table is fine here
+		uint32_t victim = INVALID_ID;
+		uint64_t victimLastUsed = evictionStamp;
+		for (uint32_t i = 0; i < VPL_COUNT_OF(g_assetResidency); ++i)
 		{
-			index = i;
-			break;
+			const AssetResidency& residency = g_assetResidency[i];
+			if (residency.residentBytes != 0 && residency.type == type && residency.referenceCount == 0 && residency.lastUsed < victimLastUsed)
+			{
+				victim = i;
+				victimLastUsed = residency.lastUsed;
+			}
+		}
+		if (victim == INVALID_ID)
+		{
+			Warning("Asset residency budget for type %d exceeded, %d bytes resident", (uint32_t)type, g_residentBytes[(uint32_t)type] + bytes);
+			return;
 		}
+		//the residency table is indexed by slot, the index has the full handle of the first entry
+		uint32_t head = INVALID_ID;
+		g_loadedAssetIndex.Find(g_loadedAssetEntries[victim].guid, head);
+		VPL_ASSERT(head != INVALID_ID && SLOT_INDEX(head) == victim, "Resident asset is not in the loaded asset index!");
+		FreeLoadedAsset(head);
+	}
+}
+
+//a load or request of an asset that is already loaded counts as a use
+void TouchLoadedAsset(uint32_t head)
+{
+	g_assetResidency[SLOT_INDEX(head)].lastUsed = ++g_residencyClock;
+}
+
+void AcquireAssetReference(uint32_t head)
+{
+	AssetResidency& residency = g_assetResidency[SLOT_INDEX(head)];
+	if (residency.isCached)
+	{
+		RemoveFromLRU(head);
+	}
+	++residency.referenceCount;
+}
+
+void ReleaseAssetReference(uint32_t head)
+{
+	AssetResidency& residency = g_assetResidency[SLOT_INDEX(head)];
+	VPL_ASSERT(residency.referenceCount > 0, "Released an asset that is not referenced!");
+	if (residency.referenceCount == 0 || --residency.referenceCount > 0)
+	{
+		return;
+	}
+	residency.lastUsed = ++g_residencyClock;
+	if (residency.unloadRequested || g_keepAliveBudget == 0)
+	{
+		FreeLoadedAsset(head);
+		return;
+	}
+	PushFrontLRU(head);
+	while (g_lruCount > g_keepAliveBudget)
+	{
+		FreeLoadedAsset(g_lruTail);
 	}
-	return index;
 }
 
 /*
@@ -174,8 +533,8 @@ uint32_t ScanForAssetInDefaultPaths(std::experimental::filesystem::path& relativ
 	if (exists(fallbackPath))
 	{
 		path hashString = "textures" / relativeAssetPath.filename();
-		char fallbackHash[SHA1_HASH_BYTES];
-		utility::SHA1(hashString.string(), fallbackHash, sizeof(fallbackHash));
+		char fallbackHash[LIBRARY_GUID_BYTES];
+		ComputeAssetGUID(hashString, fallbackHash);
 		libraryEntryIndex = FindAssetEntryIndexWithHash(fallbackHash, sizeof(fallbackHash));
 		if (libraryEntryIndex != -1)
 		{//modify the string
@@ -194,8 +553,8 @@ uint32_t ScanForAssetInDefaultPaths(std::experimental::filesystem::path& relativ
 			if (fileNameStem == relativeAssetPathStem)
 			{//if stems match we still have to determine if the asset is of the correct type
 				path foundFallbackPath = "textures/" / curr.path().filename();
-				char fallbackHash[SHA1_HASH_BYTES];
-				utility::SHA1(foundFallbackPath.string(), fallbackHash, sizeof(fallbackHash));
+				char fallbackHash[LIBRARY_GUID_BYTES];
+				ComputeAssetGUID(foundFallbackPath, fallbackHash);
 				libraryEntryIndex = FindAssetEntryIndexWithHash(fallbackHash, sizeof(fallbackHash));
 				if (libraryEntryIndex != -1)
 				{//modify the string
@@ -213,36 +572,43 @@ uint32_t ScanForAssetInDefaultPaths(std::experimental::filesystem::path& relativ
 	return libraryEntryIndex;
 }
 
-RESULT ImportTextureAsset(const std::experimental::filesystem::path& absoluteCookedAssetPath, const char* hash, size_t hashSize)
+RESULT FinalizeTextureAsset(const TextureLoadData& texture, const char* hash, size_t hashSize)
 {
-	uint32_t assetIndex = FindAvailableAssetEntryIndex();
-	Asset& entry = g_loadedAssetEntries[assetIndex];
-	uint32_t index = FindTextureIndex();
+	uint32_t assetIndex = g_assetEntrySlots.Allocate();
+	if (assetIndex == INVALID_ID)
+	{
+		return RESULT_ARRAY_FULL;
+	}
+	Asset& entry = g_loadedAssetEntries[SLOT_INDEX(assetIndex)];
+	uint32_t index = g_textureSlots.Allocate();
 	if (index != INVALID_ID)
 	{
-		uint8_t* data = nullptr;
-		uint8_t* textureData = nullptr;
-		DDS_HEADER header = {};
-		uint64_t dataSize = 0;
-		VPL_TRY(LoadDDSTexture(absoluteCookedAssetPath, data, textureData, dataSize, header));
-		if (data != nullptr)
+		MakeRoomForAsset(EAssetType::Texture, texture.dataSize);
+		if (texture.data != nullptr)
 		{
 			TextureID result = INVALID_ID;
-			VPL_TRY(CreateTextureFromDDS(textureData, dataSize, header, result));
+			PUG_PROFILE_SCOPE("CreateTextureFromDDS");
+			RESULT createResult = CreateTextureFromDDS(texture.textureData, texture.dataSize, texture.header, result);
+			if (createResult != RESULT_OK)
+			{
+				g_textureSlots.Free(index);
+				g_assetEntrySlots.Free(assetIndex);
+				return createResult;
+			}
 			if (result != INVALID_ID)
 			{
-				g_textures[index] = result;
+				g_textures[SLOT_INDEX(index)] = result;
 			}
 		}
 		else
 		{
 			Error("Failed to load texture data!");
 		}
-		VPL_TRY(UnloadTexture(data))
 	}
 	else
 	{
 		Error("No more room in texture array!");
+		g_assetEntrySlots.Free(assetIndex);
 		return RESULT_ARRAY_FULL;
 	}
 
@@ -252,115 +618,154 @@ RESULT ImportTextureAsset(const std::experimental::filesystem::path& absoluteCoo
 	entry.id = index;
 	//write type to AssetEntry
 	entry.type = (uint32_t)EAssetType::Texture;
+	g_textureOwners[SLOT_INDEX(index)] = LinkLoadedAssetEntry(assetIndex);
+	if (g_textures[SLOT_INDEX(index)] != INVALID_ID)
+	{
+		AddResidentBytes(g_textureOwners[SLOT_INDEX(index)], EAssetType::Texture, texture.dataSize);
+	}
 	//++g_loadedAssetCount;
 
 	return RESULT_OK;
 }
 
-RESULT ImportMeshAsset(const std::experimental::filesystem::path& absoluteCookedAssetPath, const char* hash, size_t hashSize, const std::experimental::filesystem::path& relativeCookedAssetPath = "")
+RESULT ImportTextureAsset(const std::experimental::filesystem::path& absoluteCookedAssetPath, const char* hash, size_t hashSize)
 {
-	//load raw data from file
-	Vertex** vertices = nullptr;
-	uint32_t** indices = nullptr;
-	uint32_t* vertexCount = 0;
-	uint32_t* indexCount = 0;
-	uint32_t meshCount = 0;
-	RawMeshMaterial* rawMaterials = nullptr;
-	VPL_TRY(LoadMesh(absoluteCookedAssetPath, vertices, vertexCount, indices, indexCount, rawMaterials, meshCount));
-	//import mesh data
-	for (uint32_t i = 0; i < meshCount; ++i)
+	TextureLoadData texture = {};
+	VPL_TRY(LoadDDSTexture(absoluteCookedAssetPath, texture.data, texture.textureData, texture.dataSize, texture.header));
+	RESULT result = FinalizeTextureAsset(texture, hash, hashSize);
+	VPL_TRY(UnloadTexture(texture.data));
+	return result;
+}
+
+//texture paths in mesh files are relative to the mesh
+path MakeMaterialTexturePath(const path& relativeCookedAssetPath, const path& texturePath)
+{
+	return MakeRelativeCanonical(relativeCookedAssetPath.parent_path() / texturePath);
+}
+
+void GetMaterialTexturePaths(const RawMeshMaterial& rawMaterial, const char* out_paths[4])
+{
+	out_paths[0] = rawMaterial.diffuseTexturePath;
+	out_paths[1] = rawMaterial.specularTexturePath;
+	out_paths[2] = rawMaterial.normalTexturePath;
+	out_paths[3] = rawMaterial.emissiveTexturePath;
+}
+
+uint64_t GetMeshBytes(const Mesh& mesh)
+{
+	return (uint64_t)mesh.vertexCount * sizeof(Vertex) + (uint64_t)mesh.indexCount * sizeof(uint32_t);
+}
+
+//upload the vertex and index data to the gpu, the mesh is not visible to GetMeshAsset until it is linked
+//out_meshIndices receives every allocated mesh slot, also on failure, so the caller can free them
+RESULT UploadMeshData(const MeshLoadData& mesh, vector<uint32_t>& out_meshIndices)
+{
+	uint64_t meshBytes = 0;
+	for (uint32_t i = 0; i < mesh.meshCount; ++i)
 	{
-		uint32_t assetIndex = FindAvailableAssetEntryIndex();
-		if (assetIndex != INVALID_ID)
-		{
-			Asset& entry = g_loadedAssetEntries[assetIndex];
+		meshBytes += (uint64_t)mesh.vertexCount[i] * sizeof(Vertex) + (uint64_t)mesh.indexCount[i] * sizeof(uint32_t);
+	}
+	MakeRoomForAsset(EAssetType::Mesh, meshBytes);
 
-			uint32_t index = FindMeshIndex();
-			if (vertices[i] != nullptr && indices[i] != nullptr)
-			{
-				
-				if (index != INVALID_ID)
-				{
-					//upload to the gpu
-					VertexBufferID vb = INVALID_ID;
-					IndexBufferID ib = INVALID_ID;
-					VPL_TRY(CreateVertexBuffer(vertices[i], sizeof(vertices[i][0]), vertexCount[i], vb));
-					VPL_TRY(CreateIndexBuffer(indices[i], sizeof(indices[i][0]), indexCount[i], ib));
-					//if succes
-					if ((vb != INVALID_ID) && (ib != INVALID_ID))
-					{
-						//write result to mesh array
-						g_meshes[index].vertices = vb;
-						g_meshes[index].indices = ib;
-						g_meshes[index].vertexCount = vertexCount[i];
-						g_meshes[index].indexCount = indexCount[i];
-					}
-				}
-				else
-				{
-					Error("No more room in mesh array!");
-					return RESULT_ARRAY_FULL;
-				}
+	for (uint32_t i = 0; i < mesh.meshCount; ++i)
+	{
+		uint32_t index = g_meshSlots.Allocate();
+		if (index == INVALID_ID)
+		{
+			Error("No more room in mesh array!");
+			return RESULT_ARRAY_FULL;
+		}
+		out_meshIndices.push_back(index);
+		if (mesh.vertices[i] != nullptr && mesh.indices[i] != nullptr)
+		{
+			//upload to the gpu
+			VertexBufferID vb = INVALID_ID;
+			IndexBufferID ib = INVALID_ID;
+			VPL_TRY(CreateVertexBuffer(mesh.vertices[i], sizeof(mesh.vertices[i][0]), mesh.vertexCount[i], vb));
+			RESULT result = CreateIndexBuffer(mesh.indices[i], sizeof(mesh.indices[i][0]), mesh.indexCount[i], ib);
+			if (result != RESULT_OK)
+			{//the vertex buffer is not in the mesh table yet, freeing the slot would not destroy it
+				graphics::DestroyVertexBuffer(vb);
+				return result;
 			}
-			else
+			//if succes
+			if ((vb != INVALID_ID) && (ib != INVALID_ID))
 			{
-				Error("Failed to load mesh data, not uploaded to the GPU!");
+				//write result to mesh array
+				g_meshes[SLOT_INDEX(index)].vertices = vb;
+				g_meshes[SLOT_INDEX(index)].indices = ib;
+				g_meshes[SLOT_INDEX(index)].vertexCount = mesh.vertexCount[i];
+				g_meshes[SLOT_INDEX(index)].indexCount = mesh.indexCount[i];
+				g_meshSlotsByVertexBuffer[vb] = index;
 			}
-			//write hash to AssetEntry
-			memcpy(entry.guid, hash, hashSize);
-			//write ID to AssetEntry
-			entry.id = index;
-			//write type to AssetEntry
-			entry.type = (uint32_t)EAssetType::Mesh;
-			//++g_loadedAssetCount;
 		}
 		else
+		{
+			Error("Failed to load mesh data, not uploaded to the GPU!");
+		}
+	}
+	return RESULT_OK;
+}
+
+//create the asset entries for uploaded meshes and their materials,
+//the textures referenced by the materials have to be loaded already
+RESULT LinkMeshAsset(const MeshLoadData& mesh, const vector<uint32_t>& meshIndices, const char* hash, size_t hashSize, const path& relativeCookedAssetPath)
+{
+	//import mesh data
+	for (uint32_t i = 0; i < (uint32_t)meshIndices.size(); ++i)
+	{
+		uint32_t assetIndex = g_assetEntrySlots.Allocate();
+		if (assetIndex == INVALID_ID)
 		{
 			return RESULT_ARRAY_FULL;
 		}
+		Asset& entry = g_loadedAssetEntries[SLOT_INDEX(assetIndex)];
+		//write hash to AssetEntry
+		memcpy(entry.guid, hash, hashSize);
+		//write ID to AssetEntry
+		entry.id = meshIndices[i];
+		//write type to AssetEntry
+		entry.type = (uint32_t)EAssetType::Mesh;
+		const uint32_t meshSlot = SLOT_INDEX(meshIndices[i]);
+		g_meshOwners[meshSlot] = LinkLoadedAssetEntry(assetIndex);
+		AddResidentBytes(g_meshOwners[meshSlot], EAssetType::Mesh, GetMeshBytes(g_meshes[meshSlot]));
+		//++g_loadedAssetCount;
 	}
 	//import material data
-	for (uint32_t i = 0; i < meshCount; ++i)
+	for (uint32_t i = 0; i < mesh.meshCount; ++i)
 	{
-		uint32_t assetIndex = FindAvailableAssetEntryIndex();
+		uint32_t assetIndex = g_assetEntrySlots.Allocate();
 		if (assetIndex != INVALID_ID)
 		{
-			Asset& entry = g_loadedAssetEntries[assetIndex];
-			entry.type = (uint32_t)EAssetType::Material;
-			uint32_t index = FindMaterialIndex();
-
-			TextureID diffuse = 0;
-			TextureID specular = 0;
-			TextureID normal = 0;
-			TextureID emissive = 0;
-			if (rawMaterials[i].diffuseTexturePath.string().length() > 0)
-			{
-				const std::experimental::filesystem::path texturePath = MakeRelativeCanonical(relativeCookedAssetPath.parent_path() / rawMaterials[i].diffuseTexturePath);
-				VPL_TRY(LoadAsset(texturePath));
-				VPL_TRY(GetTextureAsset(texturePath, diffuse));
-			}
-			if (rawMaterials[i].specularTexturePath.string().length() > 0)
-			{
-				const std::experimental::filesystem::path texturePath = MakeRelativeCanonical(relativeCookedAssetPath.parent_path() / rawMaterials[i].specularTexturePath);
-				VPL_TRY(LoadAsset(texturePath));
-				VPL_TRY(GetTextureAsset(texturePath, specular));
-			}
-			if (rawMaterials[i].normalTexturePath.string().length() > 0)
+			Asset& entry = g_loadedAssetEntries[SLOT_INDEX(assetIndex)];
+			uint32_t index = g_materialSlots.Allocate();
+			if (index == INVALID_ID)
 			{
-				const std::experimental::filesystem::path texturePath = MakeRelativeCanonical(relativeCookedAssetPath.parent_path() / rawMaterials[i].normalTexturePath);
-				VPL_TRY(LoadAsset(texturePath));
-				VPL_TRY(GetTextureAsset(texturePath, normal));
+				Error("No more room in material array!");
+				g_assetEntrySlots.Free(assetIndex);
+				return RESULT_ARRAY_FULL;
 			}
-			if (rawMaterials[i].emissiveTexturePath.string().length() > 0)
+
+			const char* texturePaths[4];
+			GetMaterialTexturePaths(mesh.rawMaterials[i], texturePaths);
+			//the material holds a reference to its textures until the mesh asset is freed
+			TextureID textures[4] = {};//diffuse, specular, normal, emissive
+			for (uint32_t t = 0; t < VPL_COUNT_OF(textures); ++t)
 			{
-				const std::experimental::filesystem::path texturePath = MakeRelativeCanonical(relativeCookedAssetPath.parent_path() / rawMaterials[i].emissiveTexturePath);
-				VPL_TRY(LoadAsset(texturePath));
-				VPL_TRY(GetTextureAsset(texturePath, emissive));
+				TextureAssetID& textureAsset = g_materialTextures[SLOT_INDEX(index)][t];
+				textureAsset = INVALID_ID;
+				if (texturePaths[t] != nullptr)
+				{//a texture that failed to load leaves the slot empty
+					if (GetTextureAsset(MakeMaterialTexturePath(relativeCookedAssetPath, texturePaths[t]), textureAsset) == RESULT_OK)
+					{
+						DereferenceTextureAssetID(textureAsset, textures[t]);
+					}
+				}
 			}
 
-			Material* mat = &g_materials[index];
-			mat->diffuse = diffuse;
-			mat->normal = normal;
+			Material* mat = &g_materials[SLOT_INDEX(index)];
+			mat->diffuse = textures[0];
+			mat->normal = textures[2];
 			mat->isInitialized = 1;
 
 			//write hash to AssetEntry
@@ -369,93 +774,371 @@ RESULT ImportMeshAsset(const std::experimental::filesystem::path& absoluteCooked
 			entry.id = index;
 			//write type to AssetEntry
 			entry.type = (uint32_t)EAssetType::Material;
+			LinkLoadedAssetEntry(assetIndex);
 			//++g_loadedAssetCount;
 		}
 	}
 	//import positional data
 
-
-	//delete cpu data
-	VPL_TRY(UnloadMesh(vertices, vertexCount, indices, indexCount, rawMaterials, meshCount));
-	
-
 	return RESULT_OK;
 }
 
-RESULT vpl::resource::InitAssetLibrarian()
+//undo a mesh import that failed after UploadMeshData, frees the entries LinkMeshAsset already linked under the guid
+//with their material slots and texture references, then every mesh slot that was not linked yet
+void DiscardMeshImport(const char* hash, const vector<uint32_t>& meshIndices)
 {
-	isInitialized = true;
-	g_currPath = current_path();
+	const uint32_t head = FindLoadedAssetEntryIndex(hash);
+	if (head != INVALID_ID)
+	{
+		FreeLoadedAsset(head);
+	}
+	for (uint32_t meshIndex : meshIndices)
+	{
+		if (g_meshSlots.IsValid(meshIndex))
+		{//linked slots were freed with their entry above
+			FreeMeshSlot(meshIndex);
+		}
+	}
+}
 
-	//look for library folder in "executable folder/../library"
-	path libraryPath = canonical(g_currPath / "../library/");
+RESULT ImportMeshAsset(const std::experimental::filesystem::path& absoluteCookedAssetPath, const char* hash, size_t hashSize, const std::experimental::filesystem::path& relativeCookedAssetPath = "")
+{
+	//load raw data from file
+	MeshLoadData mesh = {};
+	VPL_TRY(LoadMesh(absoluteCookedAssetPath, mesh.data, mesh.vertices, mesh.vertexCount, mesh.indices, mesh.indexCount, mesh.rawMaterials, mesh.meshCount));
 
-	uint32_t numEntries = 0;
-	uint32_t entrySize = 0;
-	//import library from file
-	if (exists(libraryPath))
+	//load the textures before the materials that reference them,
+	//they are unreferenced until LinkMeshAsset so keep them from being evicted while the rest loads
+	const uint64_t previousImportStamp = g_syncImportStamp;
+	g_syncImportStamp = min(previousImportStamp, g_residencyClock + 1);
+	RESULT result = RESULT_OK;
+	for (uint32_t i = 0; i < mesh.meshCount && result == RESULT_OK; ++i)
 	{
-		fstream libraryFileStream;
-		libraryFileStream.open(libraryPath / "asset_library.mal", fstream::in | fstream::binary);
-		if (!libraryFileStream.is_open())
-		{
-			Error("Failed to open library file!");
-			return RESULT_FAILED_TO_OPEN_FILE;
-		}
-		if (!libraryFileStream.read((char*)&numEntries, sizeof(uint32_t)))
-		{
-			Error("Failed to read library file header for entry size!\n");
-			return RESULT_FAILED_TO_READ_FILE;
-		}
-		if (!libraryFileStream.read((char*)&entrySize, sizeof(uint32_t)))
+		const char* texturePaths[4];
+		GetMaterialTexturePaths(mesh.rawMaterials[i], texturePaths);
+		for (uint32_t t = 0; t < 4 && result == RESULT_OK; ++t)
 		{
-			Error("Failed to read library file header for entry count!\n");
-			return RESULT_FAILED_TO_READ_FILE;
-		}
-		VPL_ASSERT(numEntries < MAX_ASSETS, "The number of entries in the mal file exceeds our maximum allowed asset count!");
-		if (!libraryFileStream.read((char*)g_assetLibrary, numEntries * entrySize))
-		{
-			Error("Failed to read asset entries from library file !\n");
+			if (texturePaths[t] != nullptr)
+			{
+				result = LoadAsset(MakeMaterialTexturePath(relativeCookedAssetPath, texturePaths[t]));
+			}
 		}
 	}
-	else
+
+	vector<uint32_t> meshIndices;
+	if (result == RESULT_OK)
 	{
-		Error("directory %s does not exist!", libraryPath.string().c_str());
-		return RESULT_LIBRARY_DIRECTORY_NOT_FOUND;
+		result = UploadMeshData(mesh, meshIndices);
+	}
+	if (result == RESULT_OK)
+	{
+		result = LinkMeshAsset(mesh, meshIndices, hash, hashSize, relativeCookedAssetPath);
+	}
+	g_syncImportStamp = previousImportStamp;
+	if (result != RESULT_OK)
+	{
+		DiscardMeshImport(hash, meshIndices);
 	}
 
-	g_assetLibraryEntriesCount = numEntries;
-	Info("Finished importing asset library from %s", libraryPath.string().c_str());
-	return RESULT_OK;
+	//delete cpu data
+	VPL_TRY(UnloadMesh(mesh.data));
+
+	return result;
 }
 
-RESULT vpl::resource::ClearAssetLibrarian()
+//runs on the streaming threads, only touches the request it owns
+void DecodeRequest(AssetLoadRequest& request)
 {
-	isInitialized = false;
-	for (uint32_t i = 0; i < MAX_ASSETS; ++i)
-	{//unload loaded meshes
-		///<TODO>
-		ReleaseMeshAsset(g_meshes[i]);
-		ReleaseTextureAsset(g_textures[i]);
+	if (request.type == EAssetType::Mesh)
+	{
+		MeshLoadData& mesh = request.mesh;
+		request.result = LoadMesh(request.absoluteCookedAssetPath, mesh.data, mesh.vertices, mesh.vertexCount, mesh.indices, mesh.indexCount, mesh.rawMaterials, mesh.meshCount);
+	}
+	else if (request.type == EAssetType::Texture)
+	{
+		TextureLoadData& texture = request.texture;
+		request.result = LoadDDSTexture(request.absoluteCookedAssetPath, texture.data, texture.textureData, texture.dataSize, texture.header);
+	}
+	else
+	{
+		request.result = RESULT_INVALID_ARGUMENTS;
 	}
-	
-	VPL_ZERO_MEM(g_loadedAssetEntries);
-	//g_loadedAssetCount = 0;
-	VPL_ZERO_MEM(g_assetLibrary);
-	g_assetLibraryEntriesCount = 0;
-	VPL_ZERO_MEM(g_meshes);
-
-	return RESULT_OK;
 }
 
-RESULT vpl::resource::LoadAsset(std::experimental::filesystem::path relativeAssetPath)
+void StreamingThread()
 {
-	VPL_ASSERT(isInitialized, "Asset librarian is not initialized!");
+	for (;;)
+	{
+		AssetLoadRequest* request = nullptr;
+		{
+			unique_lock<mutex> lock(g_streamingLock);
+			g_streamingCondition.wait(lock, [] { return g_streamingShutdown || !g_decodeQueue.empty(); });
+			if (g_streamingShutdown)
+			{
+				return;
+			}
+			AssetQueueItem item = g_decodeQueue.top();
+			g_decodeQueue.pop();
+			request = &g_requests[ASSET_REQUEST_SLOT(item.handle)];
+			if (request->handle != item.handle || request->state != ERequestState::Queued)
+			{//stale entry left behind by a priority bump
+				continue;
+			}
+			request->state = ERequestState::Decoding;
+		}
+
+		DecodeRequest(*request);
+
+		lock_guard<mutex> lock(g_streamingLock);
+		request->state = ERequestState::Decoded;
+		g_finalizeQueue.push({ request->priority, request->handle });
+	}
+}
+
+void StartStreamingThreads()
+{
+	g_streamingShutdown = false;
+	g_requestSequence = 0;
+	g_pendingRequestIndex.Initialize(MAX_ASSET_REQUESTS);
+	for (uint32_t i = 0; i < ASSET_STREAMING_THREAD_COUNT; ++i)
+	{
+		g_streamingThreads[i] = thread(StreamingThread);
+	}
+}
+
+void FreeRequestData(AssetLoadRequest& request)
+{
+	if (request.mesh.data != nullptr)
+	{
+		UnloadMesh(request.mesh.data);
+	}
+	if (request.texture.data != nullptr)
+	{
+		UnloadTexture(request.texture.data);
+	}
+	request.mesh = {};
+	request.texture = {};
+}
+
+void StopStreamingThreads()
+{
+	{
+		lock_guard<mutex> lock(g_streamingLock);
+		g_streamingShutdown = true;
+	}
+	g_streamingCondition.notify_all();
+	for (uint32_t i = 0; i < ASSET_STREAMING_THREAD_COUNT; ++i)
+	{
+		if (g_streamingThreads[i].joinable())
+		{
+			g_streamingThreads[i].join();
+		}
+	}
+
+	//drop everything that was still in flight, gpu resources are released with the tables
+	for (uint32_t i = 0; i < MAX_ASSET_REQUESTS; ++i)
+	{
+		FreeRequestData(g_requests[i]);
+		g_requests[i] = AssetLoadRequest();
+	}
+	g_decodeQueue = priority_queue<AssetQueueItem>();
+	g_finalizeQueue = priority_queue<AssetQueueItem>();
+	g_pendingRequestIndex.Destroy();
+}
+
+//version 1, unsorted entries, build a hash index over them once so lookups are constant time
+RESULT MapLegacyLibrary(uint32_t& out_numEntries)
+{
+	if (g_assetLibraryFile.size < sizeof(LibraryFileHeaderV1))
+	{
+		Error("Library file is too small to contain a header!");
+		return RESULT_FAILED_TO_READ_FILE;
+	}
+
+	LibraryFileHeaderV1 header;
+	memcpy(&header, g_assetLibraryFile.data, sizeof(header));
+	if (header.entrySize != sizeof(LibraryAssetEntry))
+	{
+		Error("Library file entry size %d does not match the expected entry size %d!", header.entrySize, (uint32_t)sizeof(LibraryAssetEntry));
+		return RESULT_FAILED_TO_READ_FILE;
+	}
+	if (g_assetLibraryFile.size < sizeof(LibraryFileHeaderV1) + (uint64_t)header.entryCount * header.entrySize)
+	{
+		Error("Library file is truncated, expected %d entries!", header.entryCount);
+		return RESULT_FAILED_TO_READ_FILE;
+	}
+
+	g_assetLibrary = (const LibraryAssetEntry*)(g_assetLibraryFile.data + sizeof(LibraryFileHeaderV1));
+	g_assetLibraryHeader = nullptr;
+
+	g_libraryIndex.Initialize(header.entryCount);
+	for (uint32_t i = 0; i < header.entryCount; ++i)
+	{
+		if (!g_libraryIndex.Insert(g_assetLibrary[i].assetGUID, i))
+		{
+			Warning("Duplicate guid found in library file at entry %d", i);
+		}
+	}
+
+	Warning("Library file uses the unsorted version 1 format, re-cook the library to skip building the lookup index at startup");
+	g_assetLibraryVersion = 1;
+	out_numEntries = header.entryCount;
+	return RESULT_OK;
+}
+
+//version 2 and 3, sorted entries with a fanout table, searched in place without any startup work
+RESULT MapSortedLibrary(uint32_t& out_numEntries)
+{
+	if (g_assetLibraryFile.size < sizeof(LibraryFileHeader))
+	{
+		Error("Library file is too small to contain a header!");
+		return RESULT_FAILED_TO_READ_FILE;
+	}
+
+	const LibraryFileHeader* header = (const LibraryFileHeader*)g_assetLibraryFile.data;
+	if (header->version < 2 || header->version > LIBRARY_FILE_VERSION)
+	{
+		Error("Unsupported library file version %d!", header->version);
+		return RESULT_FAILED_TO_READ_FILE;
+	}
+	if (header->entrySize != sizeof(LibraryAssetEntry))
+	{
+		Error("Library file entry size %d does not match the expected entry size %d!", header->entrySize, (uint32_t)sizeof(LibraryAssetEntry));
+		return RESULT_FAILED_TO_READ_FILE;
+	}
+	if (g_assetLibraryFile.size < sizeof(LibraryFileHeader) + (uint64_t)header->entryCount * header->entrySize)
+	{
+		Error("Library file is truncated, expected %d entries!", header->entryCount);
+		return RESULT_FAILED_TO_READ_FILE;
+	}
+	for (uint32_t i = 1; i < LIBRARY_FANOUT_SIZE; ++i)
+	{
+		if (header->fanout[i] < header->fanout[i - 1])
+		{
+			Error("Library file fanout table is corrupt!");
+			return RESULT_FAILED_TO_READ_FILE;
+		}
+	}
+	if (header->fanout[LIBRARY_FANOUT_SIZE - 1] != header->entryCount)
+	{
+		Error("Library file fanout table does not match the entry count!");
+		return RESULT_FAILED_TO_READ_FILE;
+	}
+
+	if (header->version < LIBRARY_HASH128_GUID_VERSION)
+	{
+		Warning("Library file version %d uses sha1 guids, re-cook the library for faster asset lookups", header->version);
+	}
+
+	g_assetLibraryHeader = header;
+	g_assetLibraryVersion = header->version;
+	g_assetLibrary = (const LibraryAssetEntry*)(g_assetLibraryFile.data + sizeof(LibraryFileHeader));
+	out_numEntries = header->entryCount;
+	return RESULT_OK;
+}
+
+RESULT vpl::resource::InitAssetLibrarian()
+{
+	isInitialized = true;
+	g_currPath = current_path();
+
+	//look for library folder in "executable folder/../library"
+	path libraryPath = canonical(g_currPath / "../library/");
+
+	uint32_t numEntries = 0;
+	//map the library file, the entries are used in place
+	if (exists(libraryPath))
+	{
+		path libraryFilePath = libraryPath / "asset_library.mal";
+		if (!pug::utility::MapFile(libraryFilePath.string().c_str(), g_assetLibraryFile))
+		{
+			Error("Failed to open library file!");
+			return RESULT_FAILED_TO_OPEN_FILE;
+		}
+		uint32_t magic = 0;
+		if (g_assetLibraryFile.size >= sizeof(magic))
+		{
+			memcpy(&magic, g_assetLibraryFile.data, sizeof(magic));
+		}
+		RESULT result = (magic == LIBRARY_FILE_MAGIC) ? MapSortedLibrary(numEntries) : MapLegacyLibrary(numEntries);
+		if (result != RESULT_OK)
+		{
+			pug::utility::UnmapFile(g_assetLibraryFile);
+			g_assetLibrary = nullptr;
+			g_assetLibraryHeader = nullptr;
+			return result;
+		}
+	}
+	else
+	{
+		Error("directory %s does not exist!", libraryPath.string().c_str());
+		return RESULT_LIBRARY_DIRECTORY_NOT_FOUND;
+	}
+
+	g_assetLibraryEntriesCount = numEntries;
+
+	g_loadedAssetIndex.Initialize(MAX_ASSETS);
+	g_assetEntrySlots.Initialize(VPL_COUNT_OF(g_loadedAssetEntries));
+	g_meshSlots.Initialize(MAX_ASSETS);
+	g_meshSlotsByVertexBuffer.reserve(MAX_ASSETS);
+	g_textureSlots.Initialize(MAX_ASSETS);
+	g_materialSlots.Initialize(MAX_ASSETS);
+	pug::utility::TrackMemory(pug::utility::MemoryTag_Resource, g_staticTableBytes);
+	StartStreamingThreads();
+
+	Info("Finished importing asset library from %s", libraryPath.string().c_str());
+	return RESULT_OK;
+}
+
+RESULT vpl::resource::ClearAssetLibrarian()
+{
+	isInitialized = false;
+	StopStreamingThreads();
+	for (uint32_t i = 0; i < MAX_ASSETS; ++i)
+	{//unload loaded meshes, references do not matter anymore
+		DestroyMeshData(g_meshes[i]);
+		DestroyTextureData(i);
+	}
+	g_meshSlotsByVertexBuffer.clear();
+	g_assetEntrySlots.Destroy();
+	g_meshSlots.Destroy();
+	g_textureSlots.Destroy();
+	g_materialSlots.Destroy();
+	pug::utility::TrackMemory(pug::utility::MemoryTag_Resource, -g_staticTableBytes);
 	
-	//find the asset in the library file
-	char hash[SHA1_HASH_BYTES];
-	utility::SHA1(relativeAssetPath.string(), hash, sizeof(hash));
-	int32_t libraryEntryIndex = FindAssetEntryIndexWithHash(hash, sizeof(hash));
+	VPL_ZERO_MEM(g_loadedAssetEntries);
+	VPL_ZERO_MEM(g_assetResidency);
+	VPL_ZERO_MEM(g_meshOwners);
+	VPL_ZERO_MEM(g_textureOwners);
+	VPL_ZERO_MEM(g_materialTextures);
+	VPL_ZERO_MEM(g_materials);
+	VPL_ZERO_MEM(g_residentBytes);
+	g_lruHead = INVALID_ID;
+	g_lruTail = INVALID_ID;
+	g_lruCount = 0;
+	g_residencyClock = 0;
+	//g_loadedAssetCount = 0;
+	pug::utility::UnmapFile(g_assetLibraryFile);
+	g_assetLibrary = nullptr;
+	g_assetLibraryHeader = nullptr;
+	g_assetLibraryVersion = 0;
+	g_assetLibraryEntriesCount = 0;
+	g_libraryIndex.Destroy();
+	g_loadedAssetIndex.Destroy();
+	VPL_ZERO_MEM(g_meshes);
+
+	return RESULT_OK;
+}
+
+//find the library entry for an asset, falls back to the default directories,
+//relativeAssetPath is changed to the fallback path if the asset is found there
+RESULT ResolveAsset(
+	path& relativeAssetPath,
+	const char* hash,
+	EAssetType& out_type,
+	path& out_absoluteCookedAssetPath)
+{
+	int32_t libraryEntryIndex = FindAssetEntryIndexWithHash(hash, LIBRARY_GUID_BYTES);
 	if (libraryEntryIndex == -1)
 	{
 		//fallback, check default directories
@@ -472,10 +1155,32 @@ RESULT vpl::resource::LoadAsset(std::experimental::filesystem::path relativeAsse
 	}
 
 	//determine type from library entry
-	EAssetType type = ConvertType(g_assetLibrary[libraryEntryIndex].type);
+	out_type = ConvertType(g_assetLibrary[libraryEntryIndex].type);
 	//construct absolute cooked asset path
-	path absoluteCookedAssetPath = canonical(g_currPath / "/../library/" / relativeAssetPath);
-	absoluteCookedAssetPath.replace_extension(g_assetLibrary[libraryEntryIndex].extension);
+	out_absoluteCookedAssetPath = canonical(g_currPath / "/../library/" / relativeAssetPath);
+	const char* extension = g_assetLibrary[libraryEntryIndex].extension;
+	out_absoluteCookedAssetPath.replace_extension(string(extension, strnlen(extension, sizeof(LibraryAssetEntry::extension))));//not null terminated when all 8 bytes are used
+	return RESULT_OK;
+}
+
+RESULT vpl::resource::LoadAsset(std::experimental::filesystem::path relativeAssetPath)
+{
+	PUG_PROFILE_SCOPE("LoadAsset");
+	VPL_ASSERT(isInitialized, "Asset librarian is not initialized!");
+	
+	//find the asset in the library file
+	char hash[LIBRARY_GUID_BYTES];
+	ComputeAssetGUID(relativeAssetPath, hash);
+	const uint32_t head = FindLoadedAssetEntryIndex(hash);
+	if (head != INVALID_ID)
+	{//already loaded
+		TouchLoadedAsset(head);
+		return RESULT_OK;
+	}
+	EAssetType type = EAssetType::Unknown;
+	path absoluteCookedAssetPath;
+	VPL_TRY(ResolveAsset(relativeAssetPath, hash, type, absoluteCookedAssetPath));
+
 	//load asset using correct loader
 	if (type == EAssetType::Mesh)
 	{
@@ -497,65 +1202,455 @@ RESULT vpl::resource::LoadAsset(std::experimental::filesystem::path relativeAsse
 	return RESULT_OK;
 }
 
+RESULT vpl::resource::LoadAsset(const AssetID& assetID)
+{
+	VPL_ASSERT(isInitialized, "Asset librarian is not initialized!");
+
+	char hash[LIBRARY_GUID_BYTES];
+	ComputeAssetGUID(assetID, hash);
+	const uint32_t head = FindLoadedAssetEntryIndex(hash);
+	if (head != INVALID_ID)
+	{//already loaded, no path handling
+		TouchLoadedAsset(head);
+		return RESULT_OK;
+	}
+	return LoadAsset(path(assetID.relativeAssetPath));
+}
+
+//main thread only, prefers free slots and recycles the oldest finished request otherwise
+AssetLoadRequest* AllocateRequest()
+{
+	lock_guard<mutex> lock(g_streamingLock);
+	AssetLoadRequest* oldestDone = nullptr;
+	for (uint32_t i = 0; i < MAX_ASSET_REQUESTS; ++i)
+	{
+		AssetLoadRequest& request = g_requests[i];
+		if (request.state == ERequestState::Free)
+		{
+			oldestDone = &request;
+			break;
+		}
+		if (request.state == ERequestState::Done &&
+			(oldestDone == nullptr || request.handle >> ASSET_REQUEST_SLOT_BITS < oldestDone->handle >> ASSET_REQUEST_SLOT_BITS))
+		{
+			oldestDone = &request;
+		}
+	}
+	if (oldestDone == nullptr)
+	{
+		return nullptr;
+	}
+
+	const uint32_t slot = (uint32_t)(oldestDone - g_requests);
+	*oldestDone = AssetLoadRequest();
+	g_requestSequence = (g_requestSequence + 1) & (0xFFFFFFFF >> ASSET_REQUEST_SLOT_BITS);
+	if (g_requestSequence == 0)
+	{//handle 0 is reserved for invalid handles
+		g_requestSequence = 1;
+	}
+	oldestDone->handle = (g_requestSequence << ASSET_REQUEST_SLOT_BITS) | slot;
+	return oldestDone;
+}
+
+void SetRequestState(AssetLoadRequest& request, ERequestState state)
+{
+	lock_guard<mutex> lock(g_streamingLock);
+	request.state = state;
+}
+
+void CompleteRequest(AssetLoadRequest& request, EAssetLoadStatus status)
+{
+	if (request.status == EAssetLoadStatus::Pending)
+	{//requests that finish without going through the queues were never registered
+		g_pendingRequestIndex.Remove(request.guid);
+	}
+	FreeRequestData(request);
+	request.status = status;
+	SetRequestState(request, ERequestState::Done);
+	request.dependencies.clear();
+	request.meshIndices.clear();
+	request.dependencyStamp = 0;
+
+	//copy, callbacks are allowed to issue new requests
+	vector<AssetLoadCallbackEntry> callbacks;
+	callbacks.swap(request.callbacks);
+	const AssetLoadHandle handle = request.handle;
+	for (const AssetLoadCallbackEntry& entry : callbacks)
+	{
+		entry.callback(handle, status, entry.userData);
+	}
+}
+
+RESULT vpl::resource::LoadAssetAsync(
+	std::experimental::filesystem::path relativeAssetPath,
+	const uint32_t priority,
+	AssetLoadHandle& out_handle,
+	AssetLoadCallback callback,
+	void* userData)
+{
+	VPL_ASSERT(isInitialized, "Asset librarian is not initialized!");
+	out_handle = INVALID_ID;
+
+	char hash[LIBRARY_GUID_BYTES];
+	ComputeAssetGUID(relativeAssetPath, hash);
+
+	uint32_t slot = INVALID_ID;
+	if (g_pendingRequestIndex.Find(hash, slot))
+	{//already in flight, attach to the existing request
+		AssetLoadRequest& request = g_requests[slot];
+		if (callback != nullptr)
+		{
+			request.callbacks.push_back({ callback, userData });
+		}
+		lock_guard<mutex> lock(g_streamingLock);
+		if (request.state == ERequestState::Queued && priority > request.priority)
+		{//the old queue entry is skipped by the streaming threads
+			request.priority = priority;
+			g_decodeQueue.push({ priority, request.handle });
+			g_streamingCondition.notify_one();
+		}
+		out_handle = request.handle;
+		return RESULT_OK;
+	}
+
+	AssetLoadRequest* request = AllocateRequest();
+	if (request == nullptr)
+	{
+		Error("Too many asset requests in flight!");
+		return RESULT_ARRAY_FULL;
+	}
+	memcpy(request->guid, hash, sizeof(hash));
+	request->priority = priority;
+	if (callback != nullptr)
+	{
+		request->callbacks.push_back({ callback, userData });
+	}
+	out_handle = request->handle;
+
+	const uint32_t head = FindLoadedAssetEntryIndex(hash);
+	if (head != INVALID_ID)
+	{//already loaded, the callback still fires from UpdateAssetLibrarian
+		TouchLoadedAsset(head);
+		request->status = EAssetLoadStatus::Loaded;
+		lock_guard<mutex> lock(g_streamingLock);
+		request->state = ERequestState::Decoded;
+		g_finalizeQueue.push({ priority, request->handle });
+		return RESULT_OK;
+	}
+
+	RESULT result = ResolveAsset(relativeAssetPath, hash, request->type, request->absoluteCookedAssetPath);
+	if (result != RESULT_OK)
+	{
+		CompleteRequest(*request, EAssetLoadStatus::Failed);
+		return result;
+	}
+	request->relativeAssetPath = relativeAssetPath;
+	request->status = EAssetLoadStatus::Pending;
+	g_pendingRequestIndex.Insert(hash, ASSET_REQUEST_SLOT(request->handle));
+
+	{
+		lock_guard<mutex> lock(g_streamingLock);
+		request->state = ERequestState::Queued;
+		g_decodeQueue.push({ priority, request->handle });
+	}
+	g_streamingCondition.notify_one();
+	return RESULT_OK;
+}
+
+RESULT vpl::resource::LoadAssetAsync(
+	const AssetID& assetID,
+	const uint32_t priority,
+	AssetLoadHandle& out_handle,
+	AssetLoadCallback callback,
+	void* userData)
+{//requests go through the path anyway, the cooked file is found by it
+	return LoadAssetAsync(path(assetID.relativeAssetPath), priority, out_handle, callback, userData);
+}
+
+EAssetLoadStatus vpl::resource::GetAssetLoadStatus(
+	const AssetLoadHandle handle)
+{
+	const AssetLoadRequest& request = g_requests[ASSET_REQUEST_SLOT(handle)];
+	if (handle == INVALID_ID || request.handle != handle)
+	{
+		return EAssetLoadStatus::Unknown;
+	}
+	return request.status;
+}
+
+//second half of a mesh load, once every texture request has finished
+void FinishMeshRequest(AssetLoadRequest& request)
+{
+	if (FindLoadedAssetEntryIndex(request.guid) != INVALID_ID)
+	{//loaded synchronously in the meantime
+		for (uint32_t meshIndex : request.meshIndices)
+		{
+			FreeMeshSlot(meshIndex);
+		}
+		CompleteRequest(request, EAssetLoadStatus::Loaded);
+		return;
+	}
+	RESULT result = LinkMeshAsset(request.mesh, request.meshIndices, request.guid, sizeof(request.guid), request.relativeAssetPath);
+	if (result != RESULT_OK)
+	{
+		DiscardMeshImport(request.guid, request.meshIndices);
+	}
+	CompleteRequest(request, result == RESULT_OK ? EAssetLoadStatus::Loaded : EAssetLoadStatus::Failed);
+}
+
+void FinalizeRequest(AssetLoadRequest& request)
+{
+	if (request.status != EAssetLoadStatus::Pending)
+	{//was already loaded when it was requested
+		CompleteRequest(request, request.status);
+		return;
+	}
+	if (request.result != RESULT_OK)
+	{
+		Error("Failed to load asset %s", request.absoluteCookedAssetPath.string().c_str());
+		CompleteRequest(request, EAssetLoadStatus::Failed);
+		return;
+	}
+	if (FindLoadedAssetEntryIndex(request.guid) != INVALID_ID)
+	{//loaded synchronously in the meantime
+		CompleteRequest(request, EAssetLoadStatus::Loaded);
+		return;
+	}
+
+	if (request.type == EAssetType::Texture)
+	{
+		RESULT result = FinalizeTextureAsset(request.texture, request.guid, sizeof(request.guid));
+		CompleteRequest(request, result == RESULT_OK ? EAssetLoadStatus::Loaded : EAssetLoadStatus::Failed);
+		return;
+	}
+
+	if (UploadMeshData(request.mesh, request.meshIndices) != RESULT_OK)
+	{
+		DiscardMeshImport(request.guid, request.meshIndices);
+		CompleteRequest(request, EAssetLoadStatus::Failed);
+		return;
+	}
+	//stream the textures instead of loading them inline, the materials are created once they are in,
+	//textures used from here on are kept loaded until the request is done
+	request.dependencyStamp = g_residencyClock + 1;
+	for (uint32_t i = 0; i < request.mesh.meshCount; ++i)
+	{
+		const char* texturePaths[4];
+		GetMaterialTexturePaths(request.mesh.rawMaterials[i], texturePaths);
+		for (uint32_t t = 0; t < 4; ++t)
+		{
+			if (texturePaths[t] != nullptr)
+			{
+				AssetLoadHandle dependency = INVALID_ID;
+				LoadAssetAsync(MakeMaterialTexturePath(request.relativeAssetPath, texturePaths[t]), request.priority, dependency);
+				if (dependency != INVALID_ID)
+				{
+					request.dependencies.push_back(dependency);
+				}
+			}
+		}
+	}
+	SetRequestState(request, ERequestState::WaitingForDependencies);
+}
+
+RESULT vpl::resource::UpdateAssetLibrarian(
+	const uint32_t finalizeBudgetMicroseconds)
+{
+	VPL_ASSERT(isInitialized, "Asset librarian is not initialized!");
+	const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	//meshes waiting on textures are cheap to check, do it first so they do not starve
+	uint32_t waitingRequests[MAX_ASSET_REQUESTS];
+	uint32_t waitingRequestCount = 0;
+	{
+		lock_guard<mutex> lock(g_streamingLock);
+		for (uint32_t i = 0; i < MAX_ASSET_REQUESTS; ++i)
+		{
+			if (g_requests[i].state == ERequestState::WaitingForDependencies)
+			{
+				waitingRequests[waitingRequestCount++] = i;
+			}
+		}
+	}
+	for (uint32_t i = 0; i < waitingRequestCount; ++i)
+	{
+		AssetLoadRequest& request = g_requests[waitingRequests[i]];
+		bool dependenciesDone = true;
+		for (AssetLoadHandle dependency : request.dependencies)
+		{//a recycled handle reports Unknown, only finished requests are recycled
+			if (GetAssetLoadStatus(dependency) == EAssetLoadStatus::Pending)
+			{
+				dependenciesDone = false;
+				break;
+			}
+		}
+		if (dependenciesDone)
+		{
+			FinishMeshRequest(request);
+		}
+	}
+
+	//always finalize at least one request so loads make progress with a tiny budget
+	do
+	{
+		AssetQueueItem item;
+		{
+			lock_guard<mutex> lock(g_streamingLock);
+			if (g_finalizeQueue.empty())
+			{
+				break;
+			}
+			item = g_finalizeQueue.top();
+			g_finalizeQueue.pop();
+		}
+		FinalizeRequest(g_requests[ASSET_REQUEST_SLOT(item.handle)]);
+	} while (chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count() < finalizeBudgetMicroseconds);
+
+	return RESULT_OK;
+}
+
+RESULT UnloadAssetWithGUID(const char* hash, const char* assetName)
+{
+	VPL_ASSERT(isInitialized, "Asset librarian is not initialized!");
+
+	uint32_t head = FindLoadedAssetEntryIndex(hash);
+	if (head == INVALID_ID)
+	{
+		Warning("Asset %s is not loaded", assetName);
+		return RESULT_ASSET_NOT_LOADED;
+	}
+	if (g_assetResidency[SLOT_INDEX(head)].referenceCount > 0)
+	{//still in use, freed when the last reference is released
+		g_assetResidency[SLOT_INDEX(head)].unloadRequested = 1;
+		return RESULT_OK;
+	}
+	FreeLoadedAsset(head);
+
+	return RESULT_OK;
+}
+
 RESULT vpl::resource::UnloadAsset(
 	const path& relativeAssetPath)
 {
-	VPL_ASSERT(isInitialized, "Asset librarian is not initialized!");
+	char hash[LIBRARY_GUID_BYTES] = {};
+	ComputeAssetGUID(relativeAssetPath, hash);
+	return UnloadAssetWithGUID(hash, relativeAssetPath.string().c_str());
+}
+
+RESULT vpl::resource::UnloadAsset(
+	const AssetID& assetID)
+{
+	char hash[LIBRARY_GUID_BYTES] = {};
+	ComputeAssetGUID(assetID, hash);
+	return UnloadAssetWithGUID(hash, assetID.relativeAssetPath);
+}
+
+RESULT vpl::resource::SetAssetKeepAliveBudget(
+	const uint32_t maxUnreferencedAssets)
+{
+	g_keepAliveBudget = maxUnreferencedAssets;
+	while (g_lruCount > g_keepAliveBudget)
+	{
+		FreeLoadedAsset(g_lruTail);
+	}
 	return RESULT_OK;
 }
 
-RESULT vpl::resource::GetMeshAsset(
-	const path& relativeAssetPath,
+RESULT vpl::resource::SetAssetResidencyBudget(
+	const EAssetType type,
+	const uint64_t budgetBytes)
+{
+	if ((uint32_t)type >= (uint32_t)EAssetType::NumAssetTypes)
+	{
+		return RESULT_INVALID_ARGUMENTS;
+	}
+	g_residencyBudgets[(uint32_t)type] = budgetBytes;
+	MakeRoomForAsset(type, 0);
+	return RESULT_OK;
+}
+
+RESULT vpl::resource::GetAssetResidency(
+	const EAssetType type,
+	uint64_t& out_residentBytes,
+	uint64_t& out_budgetBytes)
+{
+	if ((uint32_t)type >= (uint32_t)EAssetType::NumAssetTypes)
+	{
+		return RESULT_INVALID_ARGUMENTS;
+	}
+	out_residentBytes = g_residentBytes[(uint32_t)type];
+	out_budgetBytes = g_residencyBudgets[(uint32_t)type];
+	return RESULT_OK;
+}
+
+uint32_t GetAssetReferenceCountWithGUID(const char* hash)
+{
+	uint32_t head = FindLoadedAssetEntryIndex(hash);
+	return head == INVALID_ID ? 0 : g_assetResidency[SLOT_INDEX(head)].referenceCount;
+}
+
+uint32_t vpl::resource::GetAssetReferenceCount(
+	const std::experimental::filesystem::path& relativeAssetPath)
+{
+	char hash[LIBRARY_GUID_BYTES] = {};
+	ComputeAssetGUID(relativeAssetPath, hash);
+	return GetAssetReferenceCountWithGUID(hash);
+}
+
+uint32_t vpl::resource::GetAssetReferenceCount(
+	const AssetID& assetID)
+{
+	char hash[LIBRARY_GUID_BYTES] = {};
+	ComputeAssetGUID(assetID, hash);
+	return GetAssetReferenceCountWithGUID(hash);
+}
+
+RESULT GetMeshAssetsWithGUID(
+	const char* hash,
+	const char* assetName,
 	Mesh* out_meshes,
 	Material* out_materials,
-	Transform* out_meshOffsets,
 	uint32_t maxMeshCount,
 	uint32_t& out_meshCount)
 {
-	char hash[SHA1_HASH_BYTES] = {};
-	SHA1(relativeAssetPath.string(), hash, sizeof(hash));
-
 	uint32_t assetFound = 0;
 	uint32_t meshCounter = 0;
 	uint32_t materialCounter = 0;
 	uint32_t transformCounter = 0;
 	
 
-	//no early out, we can have multiple meshes and assets with the same hash
-	for (uint32_t i = 1; i < VPL_COUNT_OF(g_loadedAssetEntries); ++i)
+	//walk the chain, we can have multiple meshes and assets with the same hash
+	for (uint32_t i = FindLoadedAssetEntryIndex(hash); i != INVALID_ID; i = g_loadedAssetEntries[SLOT_INDEX(i)].next)
 	{
-		if (memcmp(hash, g_loadedAssetEntries[i].guid, sizeof(hash)) == 0)
+		assetFound = 1;
+		if (g_loadedAssetEntries[SLOT_INDEX(i)].type == (uint32_t)EAssetType::Mesh)
 		{
-			assetFound = 1;
-			if (g_loadedAssetEntries[i].type == (uint32_t)EAssetType::Mesh)
+			if (meshCounter >= maxMeshCount)
 			{
-				out_meshes[meshCounter] = g_meshes[g_loadedAssetEntries[i].id];
-				++meshCounter;
-				if (meshCounter > maxMeshCount)
-				{
-					return RESULT_ARRAY_FULL;
-				}
+				return RESULT_ARRAY_FULL;
 			}
-			else if (g_loadedAssetEntries[i].type == (uint32_t)EAssetType::Material)
+			out_meshes[meshCounter] = g_meshes[SLOT_INDEX(g_loadedAssetEntries[SLOT_INDEX(i)].id)];
+			++meshCounter;
+		}
+		else if (g_loadedAssetEntries[SLOT_INDEX(i)].type == (uint32_t)EAssetType::Material)
+		{
+			if (materialCounter >= maxMeshCount)
 			{
-				out_materials[materialCounter] = g_materials[g_loadedAssetEntries[i].id];
-				++materialCounter;
-				if (materialCounter > maxMeshCount)
-				{
-					return RESULT_ARRAY_FULL;
-				}
+				return RESULT_ARRAY_FULL;
 			}
+			out_materials[materialCounter] = g_materials[SLOT_INDEX(g_loadedAssetEntries[SLOT_INDEX(i)].id)];
+			++materialCounter;
 		}
 	}
 
 	if (meshCounter != materialCounter)
 	{
-		Warning("Not all loaded meshes from file %s had materials assigned to them", relativeAssetPath.string().c_str());
+		Warning("Not all loaded meshes from file %s had materials assigned to them", assetName);
 	}
 
 	if (assetFound == 0)
 	{
-		Error("Asset %s was not found", relativeAssetPath.string().c_str());
+		Error("Asset %s was not found", assetName);
 	}
 
 	if (meshCounter == 0)
@@ -564,95 +1659,181 @@ RESULT vpl::resource::GetMeshAsset(
 		return RESULT_UNKNOWN;
 	}
 
+	//every mesh handed out holds a reference, release each of them with ReleaseMeshAsset
+	const uint32_t head = FindLoadedAssetEntryIndex(hash);
+	for (uint32_t i = 0; i < meshCounter; ++i)
+	{
+		AcquireAssetReference(head);
+	}
 	out_meshCount = meshCounter;
 	return RESULT_OK;
 }
 
 RESULT vpl::resource::GetMeshAsset(
-	const path& relativeAssetPath, 
+	const path& relativeAssetPath,
+	Mesh* out_meshes,
+	Material* out_materials,
+	Transform* out_meshOffsets,
+	uint32_t maxMeshCount,
+	uint32_t& out_meshCount)
+{
+	char hash[LIBRARY_GUID_BYTES] = {};
+	ComputeAssetGUID(relativeAssetPath, hash);
+	return GetMeshAssetsWithGUID(hash, relativeAssetPath.string().c_str(), out_meshes, out_materials, maxMeshCount, out_meshCount);
+}
+
+RESULT vpl::resource::GetMeshAsset(
+	const AssetID& assetID,
+	Mesh* out_meshes,
+	Material* out_materials,
+	Transform* out_meshOffsets,
+	uint32_t maxMeshCount,
+	uint32_t& out_meshCount)
+{
+	char hash[LIBRARY_GUID_BYTES] = {};
+	ComputeAssetGUID(assetID, hash);
+	return GetMeshAssetsWithGUID(hash, assetID.relativeAssetPath, out_meshes, out_materials, maxMeshCount, out_meshCount);
+}
+
+RESULT GetMeshAssetWithGUID(
+	const char* hash,
+	const char* assetName,
 	vpl::graphics::Mesh& out_result,
 	vpl::graphics::Material& out_material)
 {
 	out_result = {};
-	char hash[SHA1_HASH_BYTES] = {};
-	SHA1(relativeAssetPath.string(), hash, sizeof(hash));
-
-	for (uint32_t i = 0; i < VPL_COUNT_OF(g_loadedAssetEntries); ++i)
+	out_material = {};
+	//the chain holds every mesh and then their materials in the same order, so the first mesh pairs with the first material
+	//the mesh and material tables have their own free lists, their slots do not line up
+	uint32_t meshIndex = INVALID_ID;
+	uint32_t materialIndex = INVALID_ID;
+	for (uint32_t i = FindLoadedAssetEntryIndex(hash); i != INVALID_ID; i = g_loadedAssetEntries[SLOT_INDEX(i)].next)
 	{
-		if (memcmp(hash, g_loadedAssetEntries[i + 1].guid, sizeof(hash)) == 0 &&
-			g_loadedAssetEntries[i + 1].type == (uint32_t)EAssetType::Mesh)
-		{//found loaded asset
-			uint32_t meshIndex = g_loadedAssetEntries[i + 1].id;
-			out_result = g_meshes[meshIndex];
-			out_material = g_materials[meshIndex];
-			return RESULT_OK;
+		const Asset& entry = g_loadedAssetEntries[SLOT_INDEX(i)];
+		if (entry.type == (uint32_t)EAssetType::Mesh && meshIndex == INVALID_ID)
+		{
+			meshIndex = entry.id;
+		}
+		else if (entry.type == (uint32_t)EAssetType::Material && materialIndex == INVALID_ID)
+		{
+			materialIndex = entry.id;
 		}
 	}
-	Error("Loaded asset not found! path: %s", relativeAssetPath.string().c_str());
-	return RESULT_ASSET_NOT_LOADED;
+	if (meshIndex == INVALID_ID)
+	{
+		Error("Loaded asset not found! path: %s", assetName);
+		return RESULT_ASSET_NOT_LOADED;
+	}
+	out_result = g_meshes[SLOT_INDEX(meshIndex)];
+	if (materialIndex != INVALID_ID)
+	{
+		out_material = g_materials[SLOT_INDEX(materialIndex)];
+	}
+	else
+	{
+		Warning("Mesh from file %s has no material assigned to it", assetName);
+	}
+	AcquireAssetReference(g_meshOwners[SLOT_INDEX(meshIndex)]);
+	return RESULT_OK;
+}
+
+RESULT vpl::resource::GetMeshAsset(
+	const path& relativeAssetPath, 
+	vpl::graphics::Mesh& out_result,
+	vpl::graphics::Material& out_material)
+{
+	char hash[LIBRARY_GUID_BYTES] = {};
+	ComputeAssetGUID(relativeAssetPath, hash);
+	return GetMeshAssetWithGUID(hash, relativeAssetPath.string().c_str(), out_result, out_material);
+}
+
+RESULT vpl::resource::GetMeshAsset(
+	const AssetID& assetID,
+	vpl::graphics::Mesh& out_result,
+	vpl::graphics::Material& out_material)
+{
+	char hash[LIBRARY_GUID_BYTES] = {};
+	ComputeAssetGUID(assetID, hash);
+	return GetMeshAssetWithGUID(hash, assetID.relativeAssetPath, out_result, out_material);
 }
 
 RESULT vpl::resource::ReleaseMeshAsset(
 	vpl::graphics::Mesh& meshAsset)
 {
-	if (MESH_VALID(meshAsset))
+	if (!MESH_VALID(meshAsset))
 	{
-		VPL_TRY(graphics::DestroyVertexBuffer(meshAsset.vertices));
-		VPL_TRY(graphics::DestroyIndexBuffer(meshAsset.indices));
-		meshAsset.vertices = INVALID_ID;
-		meshAsset.indices = INVALID_ID;
-		meshAsset.vertexCount = 0;
-		meshAsset.indexCount = 0;
-		return RESULT_OK;
+		return RESULT_INVALID_ARGUMENTS;
 	}
-	else
+	auto found = g_meshSlotsByVertexBuffer.find(meshAsset.vertices);
+	if (found == g_meshSlotsByVertexBuffer.end() || !g_meshSlots.IsValid(found->second) || g_meshOwners[SLOT_INDEX(found->second)] == INVALID_ID)
 	{
-		return RESULT_INVALID_ARGUMENTS;
+		return RESULT_ASSET_NOT_LOADED;
 	}
+	ReleaseAssetReference(g_meshOwners[SLOT_INDEX(found->second)]);
+	meshAsset = {};
+	return RESULT_OK;
 }
 
-RESULT vpl::resource::GetTextureAsset(
-	const path& relativeAssetPath,
+RESULT GetTextureAssetWithGUID(
+	const char* hash,
+	const char* assetName,
 	TextureAssetID& out_result)
 {
 	out_result = {};
-	char hash[SHA1_HASH_BYTES] = {};
-	SHA1(relativeAssetPath.string(), hash, sizeof(hash));
-
-	for (uint32_t i = 0; i < VPL_COUNT_OF(g_loadedAssetEntries); ++i)
+	for (uint32_t i = FindLoadedAssetEntryIndex(hash); i != INVALID_ID; i = g_loadedAssetEntries[SLOT_INDEX(i)].next)
 	{
-		if (memcmp(hash, g_loadedAssetEntries[i + 1].guid, sizeof(hash)) == 0 && 
-			g_loadedAssetEntries[i + 1].type == (uint32_t)EAssetType::Texture)
+		if (g_loadedAssetEntries[SLOT_INDEX(i)].type == (uint32_t)EAssetType::Texture)
 		{//found loaded asset
-			uint32_t texureAssetIndex = g_loadedAssetEntries[i + 1].id;
-			out_result = g_textures[texureAssetIndex];
+			uint32_t texureAssetIndex = g_loadedAssetEntries[SLOT_INDEX(i)].id;
+			out_result = texureAssetIndex;
+			AcquireAssetReference(g_textureOwners[SLOT_INDEX(texureAssetIndex)]);
 			return RESULT_OK;
 		}
 	}
 	//asset not found in asset library, attempting absolute path fall back
 	
-	Warning("Loaded asset not found! path: %s", relativeAssetPath.string().c_str());
+	Warning("Loaded asset not found! path: %s", assetName);
 	return RESULT_ASSET_NOT_LOADED;
 }
 
+RESULT vpl::resource::GetTextureAsset(
+	const path& relativeAssetPath,
+	TextureAssetID& out_result)
+{
+	char hash[LIBRARY_GUID_BYTES] = {};
+	ComputeAssetGUID(relativeAssetPath, hash);
+	return GetTextureAssetWithGUID(hash, relativeAssetPath.string().c_str(), out_result);
+}
+
+RESULT vpl::resource::GetTextureAsset(
+	const AssetID& assetID,
+	TextureAssetID& out_result)
+{
+	char hash[LIBRARY_GUID_BYTES] = {};
+	ComputeAssetGUID(assetID, hash);
+	return GetTextureAssetWithGUID(hash, assetID.relativeAssetPath, out_result);
+}
+
 RESULT vpl::resource::DereferenceTextureAssetID(
 	const vpl::resource::TextureAssetID textureAssetID,
 	vpl::graphics::TextureID& out_result)
 {
-	return g_textures[textureAssetID];
+	if (!g_textureSlots.IsValid(textureAssetID))
+	{//stale or invalid handle
+		return RESULT_INVALID_ARGUMENTS;
+	}
+	out_result = g_textures[SLOT_INDEX(textureAssetID)];
+	return RESULT_OK;
 }
 
 RESULT vpl::resource::ReleaseTextureAsset(
 	vpl::resource::TextureAssetID& textureAsset)
 {
-	if (g_textures[textureAsset] != INVALID_ID)
-	{
-		VPL_TRY(graphics::DestroyTexture(g_textures[textureAsset]));
-		g_textures[textureAsset] = INVALID_ID;
-		return RESULT_OK;
-	}
-	else
+	if (!g_textureSlots.IsValid(textureAsset) || g_textureOwners[SLOT_INDEX(textureAsset)] == INVALID_ID)
 	{
 		return RESULT_INVALID_ARGUMENTS;
 	}
-}
\ No newline at end of file
+	ReleaseAssetReference(g_textureOwners[SLOT_INDEX(textureAsset)]);
+	textureAsset = INVALID_ID;
+	return RESULT_OK;
+}
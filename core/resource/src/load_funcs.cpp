@@ -3,14 +3,18 @@
 #include "mesh.h"
 
 #include "logger/logger.h"
+#include "utility/profiler.h"
+#include "utility/allocator.h"
+
+#include "asset_processor/mesh_format.h"
 
 #include <experimental/filesystem>
 #include <fstream>
-#include "assimp/Importer.hpp"
-#include "assimp/scene.h"
+#include <cstring>
+#include <new>
+#include <type_traits>
 
 #define INVALID_ID 0
-#define VERTICES_PER_FACE 3
 
 using namespace vpl;
 using namespace vpl::resource;
@@ -18,32 +22,112 @@ using namespace vpl::graphics;
 using namespace vpl::log;
 using namespace std::experimental::filesystem;
 using namespace std;
-using namespace Assimp;
 using namespace vmath;
 
-void ParseSceneGraph(const aiNode* current, const Matrix4& currentMatrix, const aiScene* scene, vector<SceneNode>& out_result)
+//count elements starting at offset end at or before end, written so that corrupt offsets and counts can not overflow
+static bool IsRangeInBounds(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t end)
+{
+	return offset <= end && count <= (end - offset) / elementSize;
+}
+
+//the tables and streams are used in place, so every section has to start at an aligned offset
+static bool IsMeshFileAligned(uint64_t offset)
 {
-	uint32_t numChildren = current->mNumChildren;
-	for (uint32_t i = 0; i < numChildren; ++i)
+	return (offset & (MESH_FILE_ALIGNMENT - 1)) == 0;
+}
+
+static RESULT ValidateMeshFile(const uint8_t* data, uint64_t dataSize)
+{
+	const MeshFileHeader& header = *(const MeshFileHeader*)data;
+	if (header.magic != MESH_FILE_MAGIC)
+	{
+		Error("Invalid mesh file, magic number not present!");
+		return RESULT_INVALID_ARGUMENTS;
+	}
+	if (header.version != MESH_FILE_VERSION)
+	{
+		Error("Mesh file version %u is not supported, expected version %u! Recook the asset.", header.version, MESH_FILE_VERSION);
+		return RESULT_INVALID_ARGUMENTS;
+	}
+	if (!IsMeshFileAligned(header.submeshTableOffset) ||
+		!IsMeshFileAligned(header.materialTableOffset) ||
+		!IsMeshFileAligned(header.stringTableOffset) ||
+		!IsMeshFileAligned(header.vertexDataOffset) ||
+		!IsMeshFileAligned(header.indexDataOffset))
+	{
+		Error("Invalid mesh file, section offsets are not aligned!");
+		return RESULT_INVALID_ARGUMENTS;
+	}
+	if (header.fileSize != dataSize ||
+		!IsRangeInBounds(header.submeshTableOffset, header.submeshCount, sizeof(MeshFileSubmesh), dataSize) ||
+		!IsRangeInBounds(header.materialTableOffset, header.materialCount, sizeof(MeshFileMaterial), dataSize) ||
+		header.stringTableOffset > header.vertexDataOffset ||
+		header.vertexDataOffset > header.indexDataOffset ||
+		header.indexDataOffset > dataSize)
 	{
-		aiNode* currChild = current->mChildren[i];
-		const Matrix4 nodeMatrix = (*(Matrix4*)&currChild->mTransformation) * currentMatrix;
-		ParseSceneGraph(currChild, currentMatrix, scene, out_result);
+		Error("Invalid mesh file, section offsets are out of bounds!");
+		return RESULT_INVALID_ARGUMENTS;
 	}
 
-	for (uint32_t i = 0; i < current->mNumMeshes; ++i)
+	const MeshFileSubmesh* submeshes = (const MeshFileSubmesh*)(data + header.submeshTableOffset);
+	for (uint32_t i = 0; i < header.submeshCount; ++i)
 	{
-		SceneNode node;
-		node.transform = currentMatrix;
-		node.meshIndex = current->mMeshes[i];
-		node.materialIndex = scene->mMeshes[current->mMeshes[i]]->mMaterialIndex;
-		out_result.push_back(node);
+		const MeshFileSubmesh& submesh = submeshes[i];
+		if (submesh.vertexOffset < header.vertexDataOffset ||
+			!IsMeshFileAligned(submesh.vertexOffset) ||
+			!IsRangeInBounds(submesh.vertexOffset, submesh.vertexCount, sizeof(MeshFileVertex), header.indexDataOffset) ||
+			submesh.indexOffset < header.indexDataOffset ||
+			!IsMeshFileAligned(submesh.indexOffset) ||
+			!IsRangeInBounds(submesh.indexOffset, submesh.indexCount, sizeof(uint32_t), dataSize) ||
+			submesh.materialIndex >= header.materialCount)
+		{
+			Error("Invalid mesh file, submesh %u is out of bounds!", i);
+			return RESULT_INVALID_ARGUMENTS;
+		}
 	}
 
+	const MeshFileMaterial* materials = (const MeshFileMaterial*)(data + header.materialTableOffset);
+	const uint64_t stringTableSize = header.vertexDataOffset - header.stringTableOffset;
+	for (uint32_t i = 0; i < header.materialCount; ++i)
+	{
+		for (uint32_t t = 0; t < MeshTextureSlot_Count; ++t)
+		{
+			const uint32_t offset = materials[i].texturePaths[t];
+			if (offset != MESH_FILE_NO_TEXTURE &&
+				(offset >= stringTableSize || memchr(data + header.stringTableOffset + offset, 0, (size_t)(stringTableSize - offset)) == nullptr))
+			{
+				Error("Invalid mesh file, texture path of material %u is out of bounds!", i);
+				return RESULT_INVALID_ARGUMENTS;
+			}
+		}
+	}
+	return RESULT_OK;
+}
+
+static const char* GetTexturePath(const char* stringTable, uint32_t offset)
+{
+	if (offset == MESH_FILE_NO_TEXTURE)
+	{
+		return nullptr;
+	}
+	return stringTable + offset;
+}
+
+//the per submesh tables handed out by LoadMesh, placed behind the file data in the same allocation
+static uint64_t GetMeshTablesSize(uint32_t submeshCount)
+{
+	uint64_t size = 0;
+	size = MESH_FILE_ALIGN(size + sizeof(Vertex*) * submeshCount);
+	size = MESH_FILE_ALIGN(size + sizeof(uint32_t) * submeshCount);
+	size = MESH_FILE_ALIGN(size + sizeof(uint32_t*) * submeshCount);
+	size = MESH_FILE_ALIGN(size + sizeof(uint32_t) * submeshCount);
+	size = MESH_FILE_ALIGN(size + sizeof(RawMeshMaterial) * submeshCount);
+	return size;
 }
 
 RESULT vpl::resource::LoadMesh(
 	const path& meshPath,
+	uint8_t*& out_data,
 	Vertex**& out_vertices,
 	uint32_t*& out_vertexCount,
 	uint32_t**& out_indices,
@@ -51,234 +135,129 @@ RESULT vpl::resource::LoadMesh(
 	RawMeshMaterial*& out_rawMaterials,
 	uint32_t& out_meshCount)
 {
-	if (!exists(meshPath))
+	PUG_PROFILE_SCOPE("LoadMesh");
+	static_assert(sizeof(Vertex) == sizeof(MeshFileVertex), "The cooked vertex stream is used in place, layouts have to match");
+	static_assert(std::is_trivially_destructible<RawMeshMaterial>::value, "Raw materials live in the load arena and are never destructed");
+
+	if (!exists(meshPath) || is_directory(meshPath))
 	{
 		Error("File does not exist!");
 		return RESULT_FILE_DOES_NOT_EXIST;
 	}
 
-	Importer importer;
-	const aiScene* scene = importer.ReadFile(meshPath.string(), 0);
-	if (scene == nullptr)
+	uint64_t fileSize = file_size(meshPath);
+	if (fileSize < sizeof(MeshFileHeader))
 	{
-		return RESULT_FAILED_TO_READ_FILE;
+		Error("File is to small, can not contain a valid mesh file");
+		return RESULT_INVALID_ARGUMENTS;
 	}
 
-	//VPL_ASSERT(scene->mNumMeshes == 1, "We only support mesh files with 1 mesh!");
-
-	//Vertex** verticesArray = (Vertex**)_aligned_malloc(sizeof(Vertex*) * scene->mNumMeshes, 32);
-	//uint32_t* vertexCountArray = (uint32_t*)_aligned_malloc(sizeof(uint32_t) * scene->mNumMeshes, 32);
-	//uint32_t** indicesArray = (uint32_t**)_aligned_malloc(sizeof(uint32_t*) * scene->mNumMeshes, 32);
-	//uint32_t* indexCountArray = (uint32_t*)_aligned_malloc(sizeof(uint32_t) * scene->mNumMeshes, 32);
-
-	//temp stack allocations
-	Vertex** tmpVerticesArray = (Vertex**)_malloca(sizeof(Vertex*) * scene->mNumMeshes);
-	uint32_t* tmpVertexCountArray = (uint32_t*)_malloca(sizeof(uint32_t) * scene->mNumMeshes);
-	uint32_t** tmpIndicesArray = (uint32_t**)_malloca(sizeof(uint32_t*) * scene->mNumMeshes);
-	uint32_t* tmpIndexCountArray = (uint32_t*)_malloca(sizeof(uint32_t) * scene->mNumMeshes);
-
-	memset(tmpVerticesArray, 0, sizeof(Vertex*) * scene->mNumMeshes);
-	memset(tmpVertexCountArray, 0, sizeof(uint32_t) * scene->mNumMeshes);
-	memset(tmpIndicesArray, 0, sizeof(uint32_t*) * scene->mNumMeshes);
-	memset(tmpIndexCountArray, 0, sizeof(uint32_t) * scene->mNumMeshes);
-
-	for (uint32_t i = 0; i < scene->mNumMeshes; ++i)
+	fstream meshFile;
+	meshFile.open(meshPath, fstream::in | fstream::binary);
+	if (!meshFile.is_open())
 	{
-		aiMesh* mesh = scene->mMeshes[i];
-		Vertex* vertices = (Vertex*)_aligned_malloc(sizeof(Vertex) * mesh->mNumVertices, 32);
-		uint32_t* indices = (uint32_t*)_aligned_malloc(sizeof(uint32_t) * mesh->mNumFaces * VERTICES_PER_FACE, 32);//all meshes are triangulated
-
-		uint32_t meshHasUVs = (mesh->GetNumUVChannels() >= 1 && mesh->mNumUVComponents[0] >= 2);
-
-		//VPL_ASSERT(mesh->GetNumUVChannels() >= 1, "We only support meshes that has atleast 1 uv channel");
-		//VPL_ASSERT(mesh->mNumUVComponents[0] >= 2, "We only support meshes with atleast 2 uv coordinates");
-		for (uint32_t i = 0; i < mesh->mNumVertices; ++i)
-		{
-			Vector3 pos = Vector3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
-			Vector3 normal = Vector3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
-			Vector2 uv = Vector2(0);
-			if (meshHasUVs)
-			{
-				uv = Vector2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
-			}
-
-			Vector3 tangent = Vector3(0);
-			if (mesh->HasTangentsAndBitangents())
-			{//prevent reading from empty tangent array
-				tangent = Vector3(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z);
-			}
-
-			vertices[i] =
-			{
-				pos,
-				normal,
-				tangent,
-				uv,
-			};
-		}
-
-		for (uint32_t i = 0; i < mesh->mNumFaces; ++i)
-		{
-			indices[i * VERTICES_PER_FACE + 0] = mesh->mFaces[i].mIndices[0];
-			indices[i * VERTICES_PER_FACE + 1] = mesh->mFaces[i].mIndices[1];
-			indices[i * VERTICES_PER_FACE + 2] = mesh->mFaces[i].mIndices[2];
-		}
-
-		tmpVerticesArray[i] = vertices;
-		tmpIndicesArray[i] = indices;
-		tmpVertexCountArray[i] = mesh->mNumVertices;
-		tmpIndexCountArray[i] = mesh->mNumFaces * VERTICES_PER_FACE;
+		Error("Failed to open mesh file %s!", meshPath.string().c_str());
+		return RESULT_FAILED_TO_READ_FILE;
 	}
 
-	RawMeshMaterial* tmpRawMaterialArray = (RawMeshMaterial*)_malloca(sizeof(RawMeshMaterial) * scene->mNumMaterials);//allocate enough to generate all materials in the file, will filter later
+	//peek at the header to size the arena, everything LoadMesh hands out lives in one allocation
+	MeshFileHeader header = {};
+	if ((uint64_t)meshFile.read((char*)&header, sizeof(header)).gcount() != sizeof(header))
+	{
+		return RESULT_FAILED_TO_READ_FILE;
+	}
+	if (header.fileSize != fileSize || (uint64_t)header.submeshCount * sizeof(MeshFileSubmesh) > fileSize)
+	{
+		Error("Invalid mesh file, header does not match the file!");
+		return RESULT_INVALID_ARGUMENTS;
+	}
+	const uint64_t tablesOffset = MESH_FILE_ALIGN(fileSize);
+	const uint64_t arenaSize = tablesOffset + GetMeshTablesSize(header.submeshCount);
 
-	for (uint32_t i = 0; i < scene->mNumMaterials; ++i)
+	uint8_t* data = (uint8_t*)pug::utility::Allocate(arenaSize, MESH_FILE_ALIGNMENT, pug::utility::MemoryTag_Resource);
+	if (data == nullptr)
 	{
-		aiMaterial* material = scene->mMaterials[i];
-
-		aiColor3D diffuse, ambient, emissive, specular;
-		float shininess, opacity, shininessStrength;
-
-		material->Get(AI_MATKEY_COLOR_DIFFUSE, diffuse);
-		material->Get(AI_MATKEY_COLOR_AMBIENT, ambient);
-		material->Get(AI_MATKEY_COLOR_SPECULAR, specular);
-		material->Get(AI_MATKEY_COLOR_EMISSIVE, emissive);
-		material->Get(AI_MATKEY_SHININESS, shininess);
-		material->Get(AI_MATKEY_OPACITY, opacity);
-		material->Get(AI_MATKEY_SHININESS_STRENGTH, shininessStrength);
-
-		tmpRawMaterialArray[i].ambient = Vector4(1.0f);
-		tmpRawMaterialArray[i].diffuse = Vector4(diffuse.r, diffuse.g, diffuse.b, 1.0f);
-		tmpRawMaterialArray[i].specular = Vector4(specular.r, specular.g, specular.b, 1.0f) * Vector4(shininessStrength, shininessStrength, shininessStrength, 1.0f);
-		tmpRawMaterialArray[i].emissive = Vector4(emissive.r, emissive.g, emissive.b, 1.0f);
-
-		new (&tmpRawMaterialArray[i].diffuseTexturePath) path();
-		new (&tmpRawMaterialArray[i].specularTexturePath) path();
-		new (&tmpRawMaterialArray[i].normalTexturePath) path();
-		new (&tmpRawMaterialArray[i].emissiveTexturePath) path();
-
-		aiString texturePath;
-		for (size_t tt = (size_t)(aiTextureType_DIFFUSE); tt < (size_t)(aiTextureType_UNKNOWN); ++tt)
-		{
-			for (size_t t = 0; t < material->GetTextureCount((aiTextureType)tt); ++t)
-			{
-				material->GetTexture((aiTextureType)tt, (unsigned int)t, &texturePath);
-				switch (tt)
-				{
-				case (size_t)aiTextureType_DIFFUSE:
-					tmpRawMaterialArray[i].diffuseTexturePath = texturePath.C_Str();
-					tmpRawMaterialArray[i].diffuse = Vector4(1);
-					break;
-				case (size_t)aiTextureType_SPECULAR:
-					tmpRawMaterialArray[i].specularTexturePath = texturePath.C_Str();
-					tmpRawMaterialArray[i].specular = Vector4(1);
-					break;
-				case (size_t)aiTextureType_NORMALS:
-				case (size_t)aiTextureType_HEIGHT:
-					tmpRawMaterialArray[i].normalTexturePath = texturePath.C_Str();
-					break;
-				case (size_t)aiTextureType_EMISSIVE:
-					tmpRawMaterialArray[i].emissiveTexturePath = texturePath.C_Str();
-					tmpRawMaterialArray[i].emissive = Vector4(1);
-					break;
-				case (size_t)aiTextureType_AMBIENT:
-					//log::Info("Loading of ambient maps is not supported!");
-					break;
-				default:
-					log::Warning("Unsupported texture type! path: %s", texturePath.C_Str());
-					break;
-				}
-			}
-		}
+		Error("Out of memory, failed to allocate %u bytes for mesh file %s!", (uint32_t)arenaSize, meshPath.string().c_str());
+		return RESULT_FAILED_TO_READ_FILE;
+	}
+	memcpy(data, &header, sizeof(header));
+	const uint64_t bytesToRead = fileSize - sizeof(header);
+	uint64_t bytesRead = (uint64_t)meshFile.read((char*)data + sizeof(header), bytesToRead).gcount();
+	if (bytesRead != bytesToRead)
+	{
+		pug::utility::Free(data);
+		return RESULT_FAILED_TO_READ_FILE;
 	}
 
-	//SceneNode* tmpSceneNodes = (SceneNode*)alloca(sizeof(SceneNode*) * scene->mNumMeshes);
-	vector<SceneNode> tmpSceneNodes;
-	Matrix4 rootTransform = Matrix4();
-	ParseSceneGraph(scene->mRootNode, rootTransform, scene, tmpSceneNodes);
+	RESULT result = ValidateMeshFile(data, fileSize);
+	if (result != RESULT_OK)
+	{
+		pug::utility::Free(data);
+		return result;
+	}
 
-	//put temp arrays in final arrays
-	Vertex** verticesArray = new Vertex*[scene->mNumMeshes];
-	uint32_t* vertexCountArray = new uint32_t[scene->mNumMeshes];
-	uint32_t** indicesArray = new uint32_t*[scene->mNumMeshes];
-	uint32_t* indexCountArray = new uint32_t[scene->mNumMeshes];
+	const MeshFileSubmesh* submeshes = (const MeshFileSubmesh*)(data + header.submeshTableOffset);
+	const MeshFileMaterial* materials = (const MeshFileMaterial*)(data + header.materialTableOffset);
+	const char* stringTable = (const char*)(data + header.stringTableOffset);
 
-	if (scene->mNumMaterials > scene->mNumMeshes)
+	if (header.materialCount > header.submeshCount)
 	{
 		Warning("More materials than meshes were loaded from file!");
 	}
-	RawMeshMaterial* rawMaterialArray = new RawMeshMaterial[scene->mNumMeshes];//create a material for each meshes, there should not be more materials than meshes!
 
-																			   //loop over all meshes
-	for (uint32_t i = 0; i < scene->mNumMeshes; ++i)
+	//carve the tables out of the arena, same order as GetMeshTablesSize
+	uint64_t offset = tablesOffset;
+	Vertex** verticesArray = (Vertex**)(data + offset);
+	offset = MESH_FILE_ALIGN(offset + sizeof(Vertex*) * header.submeshCount);
+	uint32_t* vertexCountArray = (uint32_t*)(data + offset);
+	offset = MESH_FILE_ALIGN(offset + sizeof(uint32_t) * header.submeshCount);
+	uint32_t** indicesArray = (uint32_t**)(data + offset);
+	offset = MESH_FILE_ALIGN(offset + sizeof(uint32_t*) * header.submeshCount);
+	uint32_t* indexCountArray = (uint32_t*)(data + offset);
+	offset = MESH_FILE_ALIGN(offset + sizeof(uint32_t) * header.submeshCount);
+	RawMeshMaterial* rawMaterialArray = (RawMeshMaterial*)(data + offset);//create a material for each meshes, there should not be more materials than meshes!
+
+	for (uint32_t i = 0; i < header.submeshCount; ++i)
 	{
-		uint32_t meshIndex = tmpSceneNodes[i].meshIndex;
-		verticesArray[meshIndex] = tmpVerticesArray[i];
-		vertexCountArray[meshIndex] = tmpVertexCountArray[i];
-		indicesArray[meshIndex] = tmpIndicesArray[i];
-		indexCountArray[meshIndex] = tmpIndexCountArray[i];
-
-		uint32_t materialIndex = tmpSceneNodes[i].materialIndex;
-		VPL_ASSERT(materialIndex < scene->mNumMaterials, "Reading out of bounds");
-
-		rawMaterialArray[i].diffuse = tmpRawMaterialArray[materialIndex].diffuse;
-		rawMaterialArray[i].ambient = tmpRawMaterialArray[materialIndex].ambient;
-		rawMaterialArray[i].specular = tmpRawMaterialArray[materialIndex].specular;
-		rawMaterialArray[i].emissive = tmpRawMaterialArray[materialIndex].emissive;
-
-		rawMaterialArray[i].diffuseTexturePath = tmpRawMaterialArray[materialIndex].diffuseTexturePath;
-		rawMaterialArray[i].emissiveTexturePath = tmpRawMaterialArray[materialIndex].emissiveTexturePath;
-		rawMaterialArray[i].normalTexturePath = tmpRawMaterialArray[materialIndex].normalTexturePath;
-		rawMaterialArray[i].specularTexturePath = tmpRawMaterialArray[materialIndex].specularTexturePath;
+		const MeshFileSubmesh& submesh = submeshes[i];
+		verticesArray[i] = (Vertex*)(data + submesh.vertexOffset);
+		vertexCountArray[i] = submesh.vertexCount;
+		indicesArray[i] = (uint32_t*)(data + submesh.indexOffset);
+		indexCountArray[i] = submesh.indexCount;
+
+		const MeshFileMaterial& material = materials[submesh.materialIndex];
+		RawMeshMaterial* rawMaterial = new (&rawMaterialArray[i]) RawMeshMaterial();
+		rawMaterial->ambient = Vector4(material.ambient[0], material.ambient[1], material.ambient[2], material.ambient[3]);
+		rawMaterial->diffuse = Vector4(material.diffuse[0], material.diffuse[1], material.diffuse[2], material.diffuse[3]);
+		rawMaterial->specular = Vector4(material.specular[0], material.specular[1], material.specular[2], material.specular[3]);
+		rawMaterial->emissive = Vector4(material.emissive[0], material.emissive[1], material.emissive[2], material.emissive[3]);
+
+		rawMaterial->diffuseTexturePath = GetTexturePath(stringTable, material.texturePaths[MeshTextureSlot_Diffuse]);
+		rawMaterial->specularTexturePath = GetTexturePath(stringTable, material.texturePaths[MeshTextureSlot_Specular]);
+		rawMaterial->normalTexturePath = GetTexturePath(stringTable, material.texturePaths[MeshTextureSlot_Normal]);
+		rawMaterial->emissiveTexturePath = GetTexturePath(stringTable, material.texturePaths[MeshTextureSlot_Emissive]);
 	}
 
+	out_data = data;
 	out_vertices = verticesArray;
 	out_vertexCount = vertexCountArray;
 	out_indices = indicesArray;
 	out_indexCount = indexCountArray;
 	out_rawMaterials = rawMaterialArray;
-	out_meshCount = scene->mNumMeshes;
+	out_meshCount = header.submeshCount;
 
 	return RESULT_OK;
 }
 
 RESULT vpl::resource::UnloadMesh(
-	Vertex** vertices,
-	uint32_t* vertexCounts,
-	uint32_t** indices,
-	uint32_t* indexCounts,
-	RawMeshMaterial* rawMaterials,
-	const uint32_t meshCount)
+	uint8_t* data)
 {
-	for (uint32_t i = 0; i < meshCount; ++i)
-	{
-		if (vertices[i] != nullptr)
-		{
-			_aligned_free(vertices[i]);
-			vertexCounts[i] = 0;
-			vertices[i] = nullptr;
-		}
-		if (indices != nullptr)
-		{
-			_aligned_free(indices[i]);
-			indexCounts[i] = 0;
-			vertices[i] = nullptr;
-		}
-	}
-
-	if (rawMaterials != nullptr)
+	if (data != nullptr)
 	{
-		delete[] rawMaterials;
-		rawMaterials = nullptr;
+		pug::utility::Free(data);
+		return RESULT_OK;
 	}
-	delete[] vertices;
-	vertices = nullptr;
-	delete[] indices;
-	indices = nullptr;
-	delete[] vertexCounts;
-	delete[] indexCounts;
-
-	return RESULT_OK;
+	return RESULT_INVALID_ARGUMENTS;
 }
 
 RESULT vpl::resource::LoadDDSTexture(
@@ -305,11 +284,11 @@ RESULT vpl::resource::LoadDDSTexture(
 	fstream ddsFile;
 	ddsFile.open(path, fstream::in | fstream::binary);
 
-	out_data = (uint8_t*)_aligned_malloc(fileSize, 16);
+	out_data = (uint8_t*)pug::utility::Allocate(fileSize, 16, pug::utility::MemoryTag_Resource);
 	uint32_t bytesRead = (uint32_t)ddsFile.read((char*)out_data, (uint32_t)fileSize).gcount();
 	if (bytesRead != fileSize)
 	{
-		_aligned_free(out_data);
+		pug::utility::Free(out_data);
 		return RESULT_FAILED_TO_READ_FILE;
 	}
 
@@ -319,7 +298,7 @@ RESULT vpl::resource::LoadDDSTexture(
 	{
 		//memory leak!
 		Error("Invalid dds file, magic number not present!\n");
-		_aligned_free(out_data);
+		pug::utility::Free(out_data);
 		return RESULT_INVALID_ARGUMENTS;
 	}
 
@@ -330,7 +309,7 @@ RESULT vpl::resource::LoadDDSTexture(
 		hdr->ddspf.size != sizeof(DDS_PIXELFORMAT))
 	{
 		Error("Invalid dds file, invalid header size!\n");
-		_aligned_free(out_data);
+		pug::utility::Free(out_data);
 		return RESULT_INVALID_ARGUMENTS;
 	}
 
@@ -340,7 +319,7 @@ RESULT vpl::resource::LoadDDSTexture(
 	if ((hdr->ddspf.flags & DDS_FOURCC) && (VPL_MAKEFOURCC('D', 'X', '1', '0') == hdr->ddspf.fourCC))
 	{
 		Error("Invalid DDS file type!");
-		_aligned_free(out_data);
+		pug::utility::Free(out_data);
 		return RESULT_INVALID_ARGUMENTS;//we do not support DXT10
 	}
 
@@ -359,7 +338,7 @@ RESULT vpl::resource::UnloadTexture(
 {
 	if (data != nullptr)
 	{
-		_aligned_free(data);
+		pug::utility::Free(data);
 		return RESULT_OK;
 	}
 	return RESULT_INVALID_ARGUMENTS;
@@ -0,0 +1,285 @@
+#include "plog_format.h"
+#include "log_format.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace pug::log;
+
+const char* helpMessage =
+"Turns a binary log written with LogFileFormat_Binary back into text.\n"
+"Usage: log_decoder <log.plog> [output.txt]\n"
+"  without an output file the text is written to the console\n"
+;
+
+struct DecodedSite
+{
+	std::string format;
+	std::string file;
+	uint32_t level;
+	uint32_t line;
+};
+
+//bounds checked reads from a record payload
+struct PayloadReader
+{
+	const uint8_t* data;
+	size_t size;
+	size_t offset;
+
+	bool Read(void* out_value, size_t valueSize)
+	{
+		if (valueSize > size - offset)
+		{
+			return false;
+		}
+		memcpy(out_value, data + offset, valueSize);
+		offset += valueSize;
+		return true;
+	}
+};
+
+static FILE* OpenFile(const char* filePath, const char* mode)
+{
+	FILE* file = nullptr;
+#ifdef _MSC_VER
+	fopen_s(&file, filePath, mode);
+#else
+	file = fopen(filePath, mode);
+#endif
+	return file;
+}
+
+static const char* GetLevelName(uint32_t level)
+{
+	static const char* levelNames[] = { "Log", "Info", "Message", "Warning", "Error", "Assert" };
+	return level < sizeof(levelNames) / sizeof(levelNames[0]) ? levelNames[level] : "Unknown";
+}
+
+static void WriteLinePrefix(FILE* output, uint64_t timestamp, uint32_t level)
+{
+	fprintf(output, "[%6llu.%06llu] %-7s| ", (unsigned long long)(timestamp / 1000000), (unsigned long long)(timestamp % 1000000), GetLevelName(level));
+}
+
+//same text as the logger produces for the value, false once the record is used up
+static bool DecodeArgument(PayloadReader& reader, LogLine& line)
+{
+	uint8_t type;
+	if (!reader.Read(&type, sizeof(type)))
+	{
+		return false;
+	}
+	switch (type)
+	{
+	case PlogArgument_Int:
+	{
+		int64_t value;
+		if (!reader.Read(&value, sizeof(value))) return false;
+		AppendLogArgument(line, (long long)value);
+		return true;
+	}
+	case PlogArgument_UInt:
+	{
+		uint64_t value;
+		if (!reader.Read(&value, sizeof(value))) return false;
+		AppendLogArgument(line, (unsigned long long)value);
+		return true;
+	}
+	case PlogArgument_Float:
+	{
+		double value;
+		if (!reader.Read(&value, sizeof(value))) return false;
+		AppendLogArgument(line, value);
+		return true;
+	}
+	case PlogArgument_Char:
+	case PlogArgument_Bool:
+	{
+		uint8_t value;
+		if (!reader.Read(&value, sizeof(value))) return false;
+		if (type == PlogArgument_Bool)
+		{
+			AppendLogArgument(line, value != 0);
+		}
+		else
+		{
+			AppendLogArgument(line, (char)value);
+		}
+		return true;
+	}
+	case PlogArgument_Pointer:
+	{
+		uint64_t value;
+		if (!reader.Read(&value, sizeof(value))) return false;
+		AppendLogArgument(line, (const void*)(uintptr_t)value);
+		return true;
+	}
+	case PlogArgument_String:
+	{
+		uint32_t length;
+		if (!reader.Read(&length, sizeof(length)) || length > reader.size - reader.offset) return false;
+		AppendLogText(line, (const char*)reader.data + reader.offset, length);
+		reader.offset += length;
+		return true;
+	}
+	case PlogArgument_Null:
+		AppendLogArgument(line, nullptr);
+		return true;
+	default:
+		return false;
+	}
+}
+
+static void DecodeLine(const DecodedSite& site, PayloadReader& reader, LogLine& out_line)
+{
+	LogFormat format;
+	ParseLogFormat(site.format.c_str(), format);
+	out_line.length = 0;
+	out_line.truncated = false;
+	uint32_t textOffset = 0;
+	for (uint32_t i = 0; i < format.argumentCount; ++i)
+	{
+		AppendLogFormatText(out_line, format, textOffset, format.specifiers[i]);
+		if (!DecodeArgument(reader, out_line))
+		{//the argument did not fit into the record, keep the specifier
+			textOffset = format.specifiers[i];
+			break;
+		}
+		textOffset = format.specifiers[i] + 2;
+	}
+	AppendLogFormatText(out_line, format, textOffset, format.length);
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2 || !strcmp(argv[1], "help") || !strcmp(argv[1], "--help") || !strcmp(argv[1], "-h"))
+	{
+		printf("%s", helpMessage);
+		return 1;
+	}
+
+	FILE* input = OpenFile(argv[1], "rb");
+	if (input == nullptr)
+	{
+		printf("Failed to open %s!\n", argv[1]);
+		return 1;
+	}
+	std::vector<uint8_t> data;
+	uint8_t buffer[64 * 1024];
+	size_t readBytes;
+	while ((readBytes = fread(buffer, 1, sizeof(buffer), input)) > 0)
+	{
+		data.insert(data.end(), buffer, buffer + readBytes);
+	}
+	fclose(input);
+
+	PlogFileHeader fileHeader;
+	if (data.size() < sizeof(fileHeader))
+	{
+		printf("%s is not a binary log!\n", argv[1]);
+		return 1;
+	}
+	memcpy(&fileHeader, data.data(), sizeof(fileHeader));
+	if (fileHeader.magic != PLOG_FILE_MAGIC || fileHeader.version != PLOG_FILE_VERSION)
+	{
+		printf("%s is not a binary log or was written by a different version!\n", argv[1]);
+		return 1;
+	}
+
+	FILE* output = stdout;
+	if (argc > 2)
+	{
+		output = OpenFile(argv[2], "w");
+		if (output == nullptr)
+		{
+			printf("Failed to open %s for writing!\n", argv[2]);
+			return 1;
+		}
+	}
+
+	std::vector<DecodedSite> sites;
+	bool lineStart = true;//text records can end in the middle of a line when long text was split
+	size_t offset = sizeof(fileHeader);
+	uint64_t recordCount = 0;
+	while (data.size() - offset >= sizeof(PlogRecordHeader))
+	{
+		PlogRecordHeader header;
+		memcpy(&header, data.data() + offset, sizeof(header));
+		offset += sizeof(header);
+		if (header.size > data.size() - offset)
+		{
+			fprintf(stderr, "Record %llu is cut off, the log was not closed properly\n", (unsigned long long)recordCount);
+			break;
+		}
+		PayloadReader reader = { data.data() + offset, header.size, 0 };
+		offset += header.size;
+		++recordCount;
+
+		switch (header.type)
+		{
+		case PlogRecord_Site:
+		{
+			uint32_t fields[4];//id, level, line, format length
+			if (!reader.Read(fields, sizeof(fields)) || fields[0] == 0 || fields[3] > reader.size - reader.offset)
+			{
+				break;
+			}
+			if (sites.size() < fields[0])
+			{
+				sites.resize(fields[0]);
+			}
+			DecodedSite& site = sites[fields[0] - 1];
+			site.level = fields[1];
+			site.line = fields[2];
+			site.format.assign((const char*)reader.data + reader.offset, fields[3]);
+			reader.offset += fields[3];
+			site.file.assign((const char*)reader.data + reader.offset, reader.size - reader.offset);
+			break;
+		}
+		case PlogRecord_Line:
+		{
+			uint32_t siteID;
+			if (!reader.Read(&siteID, sizeof(siteID)) || siteID == 0 || siteID > sites.size())
+			{
+				fprintf(stderr, "Line record %llu refers to an unknown call site\n", (unsigned long long)recordCount);
+				break;
+			}
+			const DecodedSite& site = sites[siteID - 1];
+			LogLine line;
+			DecodeLine(site, reader, line);
+			WriteLinePrefix(output, header.timestamp, site.level);
+			fprintf(output, "%.*s\n", (int)line.length, line.text);
+			lineStart = true;
+			break;
+		}
+		case PlogRecord_Text:
+		{
+			uint32_t level;
+			if (!reader.Read(&level, sizeof(level)))
+			{
+				break;
+			}
+			const size_t length = reader.size - reader.offset;
+			if (lineStart)
+			{
+				WriteLinePrefix(output, header.timestamp, level);
+			}
+			fwrite(reader.data + reader.offset, 1, length, output);
+			lineStart = length > 0 && reader.data[reader.offset + length - 1] == '\n';
+			break;
+		}
+		default:
+			fprintf(stderr, "Skipped record %llu of unknown type %u\n", (unsigned long long)recordCount, header.type);
+			break;
+		}
+	}
+
+	if (output != stdout)
+	{
+		fclose(output);
+		printf("Decoded %llu records from %s\n", (unsigned long long)recordCount, argv[1]);
+	}
+	return 0;
+}
@@ -0,0 +1,156 @@
+#include "log_binary.h"
+
+using namespace pug::log;
+
+void pug::log::BeginLogRecord(LogRecord& record, EPlogRecordType type)
+{//size and timestamp are filled in when the record is written
+	PlogRecordHeader header = {};
+	header.type = type;
+	memcpy(record.data, &header, sizeof(header));
+	record.length = sizeof(header);
+	record.truncated = false;
+}
+
+bool pug::log::AppendLogRecordBytes(LogRecord& record, const void* data, size_t size)
+{
+	if (record.truncated || size > LOG_MAX_LINE_LENGTH - record.length)
+	{//everything after the first argument that does not fit is dropped, the decoder stops at the end of the record
+		record.truncated = true;
+		return false;
+	}
+	memcpy(record.data + record.length, data, size);
+	record.length += (uint32_t)size;
+	return true;
+}
+
+//tag and value in one append so a value is never split from its tag
+template<typename T>
+static void EncodeValue(LogRecord& record, EPlogArgumentType type, T value)
+{
+	uint8_t buffer[1 + sizeof(T)];
+	buffer[0] = type;
+	memcpy(buffer + 1, &value, sizeof(T));
+	AppendLogRecordBytes(record, buffer, sizeof(buffer));
+}
+
+static void EncodeString(LogRecord& record, const char* text, size_t length)
+{
+	uint8_t buffer[1 + sizeof(uint32_t)];
+	const size_t space = LOG_MAX_LINE_LENGTH - record.length;
+	if (record.truncated || space < sizeof(buffer))
+	{
+		record.truncated = true;
+		return;
+	}
+	if (length > space - sizeof(buffer))
+	{//long strings are cut, the line still decodes
+		length = space - sizeof(buffer);
+	}
+	const uint32_t storedLength = (uint32_t)length;
+	buffer[0] = PlogArgument_String;
+	memcpy(buffer + 1, &storedLength, sizeof(storedLength));
+	AppendLogRecordBytes(record, buffer, sizeof(buffer));
+	AppendLogRecordBytes(record, text, length);
+}
+
+void pug::log::EncodeLogArgument(LogRecord& record, const char* value)
+{
+	if (value == nullptr)
+	{
+		const uint8_t type = PlogArgument_Null;
+		AppendLogRecordBytes(record, &type, sizeof(type));
+		return;
+	}
+	EncodeString(record, value, strlen(value));
+}
+
+void pug::log::EncodeLogArgument(LogRecord& record, char* value)
+{
+	EncodeLogArgument(record, (const char*)value);
+}
+
+void pug::log::EncodeLogArgument(LogRecord& record, const std::string& value)
+{
+	EncodeString(record, value.c_str(), value.length());
+}
+
+void pug::log::EncodeLogArgument(LogRecord& record, const void* value)
+{
+	EncodeValue(record, PlogArgument_Pointer, (uint64_t)(uintptr_t)value);
+}
+
+void pug::log::EncodeLogArgument(LogRecord& record, std::nullptr_t)
+{
+	const uint8_t type = PlogArgument_Null;
+	AppendLogRecordBytes(record, &type, sizeof(type));
+}
+
+void pug::log::EncodeLogArgument(LogRecord& record, bool value)
+{
+	EncodeValue(record, PlogArgument_Bool, (uint8_t)(value ? 1 : 0));
+}
+
+void pug::log::EncodeLogArgument(LogRecord& record, char value)
+{
+	EncodeValue(record, PlogArgument_Char, value);
+}
+
+void pug::log::EncodeLogArgument(LogRecord& record, signed char value)
+{
+	EncodeValue(record, PlogArgument_Char, value);
+}
+
+void pug::log::EncodeLogArgument(LogRecord& record, unsigned char value)
+{
+	EncodeValue(record, PlogArgument_Char, value);
+}
+
+void pug::log::EncodeLogArgument(LogRecord& record, short value)
+{
+	EncodeValue(record, PlogArgument_Int, (int64_t)value);
+}
+
+void pug::log::EncodeLogArgument(LogRecord& record, unsigned short value)
+{
+	EncodeValue(record, PlogArgument_UInt, (uint64_t)value);
+}
+
+void pug::log::EncodeLogArgument(LogRecord& record, int value)
+{
+	EncodeValue(record, PlogArgument_Int, (int64_t)value);
+}
+
+void pug::log::EncodeLogArgument(LogRecord& record, unsigned int value)
+{
+	EncodeValue(record, PlogArgument_UInt, (uint64_t)value);
+}
+
+void pug::log::EncodeLogArgument(LogRecord& record, long value)
+{
+	EncodeValue(record, PlogArgument_Int, (int64_t)value);
+}
+
+void pug::log::EncodeLogArgument(LogRecord& record, unsigned long value)
+{
+	EncodeValue(record, PlogArgument_UInt, (uint64_t)value);
+}
+
+void pug::log::EncodeLogArgument(LogRecord& record, long long value)
+{
+	EncodeValue(record, PlogArgument_Int, (int64_t)value);
+}
+
+void pug::log::EncodeLogArgument(LogRecord& record, unsigned long long value)
+{
+	EncodeValue(record, PlogArgument_UInt, (uint64_t)value);
+}
+
+void pug::log::EncodeLogArgument(LogRecord& record, float value)
+{
+	EncodeValue(record, PlogArgument_Float, (double)value);
+}
+
+void pug::log::EncodeLogArgument(LogRecord& record, double value)
+{
+	EncodeValue(record, PlogArgument_Float, value);
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "log_format.h"
+#include "plog_format.h"
+#include <atomic>
+
+namespace pug{
+namespace log{
+
+	//one per PUG_LOG macro call site, the id is handed out on first use and is what the binary log refers to
+	struct LogSite
+	{
+		const LogFormat* format;
+		const char* file;
+		uint32_t line;
+		uint32_t level;
+		std::atomic<uint32_t> id;//0 until registered
+	};
+
+	uint32_t RegisterLogSite(LogSite& site);
+	inline uint32_t GetLogSiteID(LogSite& site)
+	{
+		const uint32_t id = site.id.load(std::memory_order_acquire);
+		return id != 0 ? id : RegisterLogSite(site);
+	}
+
+	//a binary record built on the stack, header included, arguments that do not fit are dropped
+	struct LogRecord
+	{
+		uint8_t data[LOG_MAX_LINE_LENGTH];
+		uint32_t length;
+		bool truncated;
+	};
+
+	void BeginLogRecord(LogRecord& record, EPlogRecordType type);
+	bool AppendLogRecordBytes(LogRecord& record, const void* data, size_t size);
+
+	void EncodeLogArgument(LogRecord& record, const char* value);
+	void EncodeLogArgument(LogRecord& record, char* value);
+	void EncodeLogArgument(LogRecord& record, const std::string& value);
+	void EncodeLogArgument(LogRecord& record, const void* value);
+	void EncodeLogArgument(LogRecord& record, std::nullptr_t);
+	void EncodeLogArgument(LogRecord& record, bool value);
+	void EncodeLogArgument(LogRecord& record, char value);
+	void EncodeLogArgument(LogRecord& record, signed char value);
+	void EncodeLogArgument(LogRecord& record, unsigned char value);
+	void EncodeLogArgument(LogRecord& record, short value);
+	void EncodeLogArgument(LogRecord& record, unsigned short value);
+	void EncodeLogArgument(LogRecord& record, int value);
+	void EncodeLogArgument(LogRecord& record, unsigned int value);
+	void EncodeLogArgument(LogRecord& record, long value);
+	void EncodeLogArgument(LogRecord& record, unsigned long value);
+	void EncodeLogArgument(LogRecord& record, long long value);
+	void EncodeLogArgument(LogRecord& record, unsigned long long value);
+	void EncodeLogArgument(LogRecord& record, float value);
+	void EncodeLogArgument(LogRecord& record, double value);
+
+	template<typename T>
+	typename std::enable_if<std::is_enum<T>::value>::type EncodeLogArgument(LogRecord& record, const T& value)
+	{
+		EncodeLogArgument(record, +static_cast<typename std::underlying_type<T>::type>(value));
+	}
+	//anything else is stored as the text it streams to, same as in the text log
+	template<typename T>
+	typename std::enable_if<!std::is_enum<T>::value>::type EncodeLogArgument(LogRecord& record, const T& value)
+	{
+		std::ostringstream buffer;
+		buffer << value;
+		EncodeLogArgument(record, buffer.str());
+	}
+
+	template<typename... Args>
+	void EncodeLogLine(LogRecord& record, uint32_t siteID, const Args&... args)
+	{
+		BeginLogRecord(record, PlogRecord_Line);
+		AppendLogRecordBytes(record, &siteID, sizeof(siteID));
+		const int expand[] = { 0, (EncodeLogArgument(record, args), 0)... };
+		(void)expand;
+	}
+
+}//pug::log
+}//pug
@@ -0,0 +1,186 @@
+#include "log_format.h"
+
+#include <cstdio>
+
+using namespace pug::log;
+
+void pug::log::ParseLogFormat(const char* format, LogFormat& out_format)
+{
+	out_format.text = format != nullptr ? format : "";
+	out_format.argumentCount = 0;
+	out_format.hasEscapes = false;
+	const char* c = out_format.text;
+	while (*c != 0)
+	{
+		if (*c == '%' && c[1] == '%')
+		{
+			out_format.hasEscapes = true;
+			c += 2;
+		}
+		else if (*c == '%' && c[1] != 0 && out_format.argumentCount < LOG_MAX_ARGUMENTS)
+		{
+			out_format.specifiers[out_format.argumentCount++] = (uint16_t)(c - out_format.text);
+			c += 2;
+		}
+		else
+		{
+			++c;
+		}
+	}
+	out_format.length = (uint32_t)(c - out_format.text);
+	for (uint32_t i = out_format.argumentCount; i < LOG_MAX_ARGUMENTS; ++i)
+	{
+		out_format.specifiers[i] = (uint16_t)out_format.length;
+	}
+}
+
+void pug::log::AppendLogText(LogLine& line, const char* text, size_t length)
+{
+	const size_t space = LOG_MAX_LINE_LENGTH - line.length;
+	if (length > space)
+	{
+		length = space;
+		line.truncated = true;
+	}
+	memcpy(line.text + line.length, text, length);
+	line.length += (uint32_t)length;
+}
+
+void pug::log::AppendLogFormatText(LogLine& line, const LogFormat& format, uint32_t begin, uint32_t end)
+{
+	if (begin >= end)
+	{
+		return;
+	}
+	if (!format.hasEscapes)
+	{
+		AppendLogText(line, format.text + begin, end - begin);
+		return;
+	}
+	//copy up to every "%%" and drop one of the two
+	const char* text = format.text + begin;
+	const char* textEnd = format.text + end;
+	while (text < textEnd)
+	{
+		const char* escape = (const char*)memchr(text, '%', textEnd - text);
+		if (escape == nullptr)
+		{
+			AppendLogText(line, text, textEnd - text);
+			break;
+		}
+		AppendLogText(line, text, escape + 1 - text);
+		text = escape + (escape + 1 < textEnd && escape[1] == '%' ? 2 : 1);
+	}
+}
+
+//snprintf into a small stack buffer, the numbers never come close to its size
+template<typename T>
+static void AppendLogNumber(LogLine& line, const char* format, T value)
+{
+	char buffer[32];
+	const int length = snprintf(buffer, sizeof(buffer), format, value);
+	if (length > 0)
+	{
+		AppendLogText(line, buffer, length < (int)sizeof(buffer) ? length : sizeof(buffer) - 1);
+	}
+}
+
+void pug::log::AppendLogArgument(LogLine& line, const char* value)
+{
+	if (value == nullptr)
+	{
+		AppendLogText(line, "(null)", 6);
+		return;
+	}
+	AppendLogText(line, value, strlen(value));
+}
+
+void pug::log::AppendLogArgument(LogLine& line, char* value)
+{
+	AppendLogArgument(line, (const char*)value);
+}
+
+void pug::log::AppendLogArgument(LogLine& line, const std::string& value)
+{
+	AppendLogText(line, value.c_str(), value.length());
+}
+
+void pug::log::AppendLogArgument(LogLine& line, const void* value)
+{
+	AppendLogNumber(line, "%p", value);
+}
+
+void pug::log::AppendLogArgument(LogLine& line, std::nullptr_t)
+{
+	AppendLogText(line, "(null)", 6);
+}
+
+void pug::log::AppendLogArgument(LogLine& line, bool value)
+{//same as streaming it
+	AppendLogText(line, value ? "1" : "0", 1);
+}
+
+void pug::log::AppendLogArgument(LogLine& line, char value)
+{
+	AppendLogText(line, &value, 1);
+}
+
+void pug::log::AppendLogArgument(LogLine& line, signed char value)
+{
+	AppendLogText(line, (const char*)&value, 1);
+}
+
+void pug::log::AppendLogArgument(LogLine& line, unsigned char value)
+{
+	AppendLogText(line, (const char*)&value, 1);
+}
+
+void pug::log::AppendLogArgument(LogLine& line, short value)
+{
+	AppendLogNumber(line, "%d", (int)value);
+}
+
+void pug::log::AppendLogArgument(LogLine& line, unsigned short value)
+{
+	AppendLogNumber(line, "%u", (unsigned int)value);
+}
+
+void pug::log::AppendLogArgument(LogLine& line, int value)
+{
+	AppendLogNumber(line, "%d", value);
+}
+
+void pug::log::AppendLogArgument(LogLine& line, unsigned int value)
+{
+	AppendLogNumber(line, "%u", value);
+}
+
+void pug::log::AppendLogArgument(LogLine& line, long value)
+{
+	AppendLogNumber(line, "%ld", value);
+}
+
+void pug::log::AppendLogArgument(LogLine& line, unsigned long value)
+{
+	AppendLogNumber(line, "%lu", value);
+}
+
+void pug::log::AppendLogArgument(LogLine& line, long long value)
+{
+	AppendLogNumber(line, "%lld", value);
+}
+
+void pug::log::AppendLogArgument(LogLine& line, unsigned long long value)
+{
+	AppendLogNumber(line, "%llu", value);
+}
+
+void pug::log::AppendLogArgument(LogLine& line, float value)
+{
+	AppendLogNumber(line, "%g", (double)value);
+}
+
+void pug::log::AppendLogArgument(LogLine& line, double value)
+{//%g matches the default precision of a stream
+	AppendLogNumber(line, "%g", value);
+}
@@ -0,0 +1,154 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <sstream>
+#include <type_traits>
+
+#define LOG_MAX_LINE_LENGTH 1024//longer lines are truncated, text without arguments is written as is
+#define LOG_MAX_ARGUMENTS 16
+
+namespace pug{
+namespace log{
+
+	//a whole log line, formatted on the stack and handed to the sinks in one piece
+	struct LogLine
+	{
+		char text[LOG_MAX_LINE_LENGTH + 1];//room for the line break
+		uint32_t length;
+		bool truncated;
+	};
+
+	//a format string split at its specifiers, a specifier is '%' followed by any character, "%%" is a literal '%'
+	struct LogFormat
+	{
+		const char* text;
+		uint32_t length;
+		uint32_t argumentCount;
+		bool hasEscapes;//contains "%%", the text between the specifiers has to be unescaped while copying
+		uint16_t specifiers[LOG_MAX_ARGUMENTS];//offset of every specifier, the length for unused ones
+	};
+
+	void ParseLogFormat(const char* format, LogFormat& out_format);
+
+	void AppendLogText(LogLine& line, const char* text, size_t length);
+	void AppendLogFormatText(LogLine& line, const LogFormat& format, uint32_t begin, uint32_t end);
+
+	void AppendLogArgument(LogLine& line, const char* value);
+	void AppendLogArgument(LogLine& line, char* value);
+	void AppendLogArgument(LogLine& line, const std::string& value);
+	void AppendLogArgument(LogLine& line, const void* value);
+	void AppendLogArgument(LogLine& line, std::nullptr_t);
+	void AppendLogArgument(LogLine& line, bool value);
+	void AppendLogArgument(LogLine& line, char value);
+	void AppendLogArgument(LogLine& line, signed char value);
+	void AppendLogArgument(LogLine& line, unsigned char value);
+	void AppendLogArgument(LogLine& line, short value);
+	void AppendLogArgument(LogLine& line, unsigned short value);
+	void AppendLogArgument(LogLine& line, int value);
+	void AppendLogArgument(LogLine& line, unsigned int value);
+	void AppendLogArgument(LogLine& line, long value);
+	void AppendLogArgument(LogLine& line, unsigned long value);
+	void AppendLogArgument(LogLine& line, long long value);
+	void AppendLogArgument(LogLine& line, unsigned long long value);
+	void AppendLogArgument(LogLine& line, float value);
+	void AppendLogArgument(LogLine& line, double value);
+
+	template<typename T>
+	typename std::enable_if<std::is_enum<T>::value>::type AppendLogArgument(LogLine& line, const T& value)
+	{//promoted so enums over chars print as numbers
+		AppendLogArgument(line, +static_cast<typename std::underlying_type<T>::type>(value));
+	}
+	//anything else that can be streamed, this is the only path that allocates
+	template<typename T>
+	typename std::enable_if<!std::is_enum<T>::value>::type AppendLogArgument(LogLine& line, const T& value)
+	{
+		std::ostringstream buffer;
+		buffer << value;
+		const std::string text = buffer.str();
+		AppendLogText(line, text.c_str(), text.length());
+	}
+
+	inline void FormatLogSegments(LogLine& line, const LogFormat& format, uint32_t, uint32_t textOffset)
+	{
+		AppendLogFormatText(line, format, textOffset, format.length);
+	}
+	template<typename T, typename... Args>
+	void FormatLogSegments(LogLine& line, const LogFormat& format, uint32_t index, uint32_t textOffset, const T& value, const Args&... args)
+	{
+		if (index >= format.argumentCount)
+		{//more arguments than specifiers, the rest is dropped
+			AppendLogFormatText(line, format, textOffset, format.length);
+			return;
+		}
+		const uint32_t specifier = format.specifiers[index];
+		AppendLogFormatText(line, format, textOffset, specifier);
+		AppendLogArgument(line, value);
+		FormatLogSegments(line, format, index + 1, specifier + 2, args...);
+	}
+
+	//fewer arguments than specifiers leave the remaining specifiers in the text
+	template<typename... Args>
+	void FormatLogLine(LogLine& line, const LogFormat& format, const Args&... args)
+	{
+		line.length = 0;
+		line.truncated = false;
+		FormatLogSegments(line, format, 0, 0, args...);
+	}
+
+	//compile time parsing for the PUG_LOG macros, single expression constexpr functions so the toolset takes them
+	//the recursion goes once per character, format strings should stay below a few hundred characters
+	constexpr uint32_t FindLogSpecifier(const char* format, uint32_t offset)
+	{//a trailing '%' is plain text
+		return format[offset] == 0 ? offset
+			: format[offset] != '%' ? FindLogSpecifier(format, offset + 1)
+			: format[offset + 1] == '%' ? FindLogSpecifier(format, offset + 2)
+			: format[offset + 1] == 0 ? offset + 1
+			: offset;
+	}
+	constexpr uint32_t FindNthLogSpecifierFrom(const char* format, uint32_t n, uint32_t specifier);
+	constexpr uint32_t FindNthLogSpecifier(const char* format, uint32_t n, uint32_t offset = 0)
+	{
+		return FindNthLogSpecifierFrom(format, n, FindLogSpecifier(format, offset));
+	}
+	constexpr uint32_t FindNthLogSpecifierFrom(const char* format, uint32_t n, uint32_t specifier)
+	{
+		return format[specifier] == 0 || n == 0 ? specifier : FindNthLogSpecifier(format, n - 1, specifier + 2);
+	}
+	constexpr uint32_t CountLogSpecifiersFrom(const char* format, uint32_t specifier);
+	constexpr uint32_t CountLogSpecifiers(const char* format, uint32_t offset = 0)
+	{
+		return CountLogSpecifiersFrom(format, FindLogSpecifier(format, offset));
+	}
+	constexpr uint32_t CountLogSpecifiersFrom(const char* format, uint32_t specifier)
+	{
+		return format[specifier] == 0 ? 0 : 1 + CountLogSpecifiers(format, specifier + 2);
+	}
+	constexpr bool HasLogEscapes(const char* format, uint32_t offset = 0)
+	{
+		return format[offset] == 0 ? false
+			: format[offset] == '%' && format[offset + 1] == '%' ? true
+			: format[offset] == '%' && format[offset + 1] != 0 ? HasLogEscapes(format, offset + 2)
+			: HasLogEscapes(format, offset + 1);
+	}
+
+	template<size_t N>
+	constexpr LogFormat MakeLogFormat(const char(&format)[N])
+	{
+		return LogFormat{ format, (uint32_t)(N - 1), CountLogSpecifiers(format), HasLogEscapes(format), {
+			(uint16_t)FindNthLogSpecifier(format, 0), (uint16_t)FindNthLogSpecifier(format, 1),
+			(uint16_t)FindNthLogSpecifier(format, 2), (uint16_t)FindNthLogSpecifier(format, 3),
+			(uint16_t)FindNthLogSpecifier(format, 4), (uint16_t)FindNthLogSpecifier(format, 5),
+			(uint16_t)FindNthLogSpecifier(format, 6), (uint16_t)FindNthLogSpecifier(format, 7),
+			(uint16_t)FindNthLogSpecifier(format, 8), (uint16_t)FindNthLogSpecifier(format, 9),
+			(uint16_t)FindNthLogSpecifier(format, 10), (uint16_t)FindNthLogSpecifier(format, 11),
+			(uint16_t)FindNthLogSpecifier(format, 12), (uint16_t)FindNthLogSpecifier(format, 13),
+			(uint16_t)FindNthLogSpecifier(format, 14), (uint16_t)FindNthLogSpecifier(format, 15) } };
+	}
+
+	//only used in unevaluated context to count the arguments of a log macro
+	template<typename... Args>
+	std::integral_constant<uint32_t, sizeof...(Args)> CountLogArguments(const Args&...);
+
+}//pug::log
+}//pug
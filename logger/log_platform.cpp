@@ -0,0 +1,188 @@
+#include "log_platform.h"
+
+#include <cstdio>
+#include <ctime>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <csignal>
+#include <unistd.h>
+#endif
+
+using namespace pug::log;
+
+void pug::log::GetWallClockString(char* out_string, size_t stringSize)
+{
+	const time_t now = time(nullptr);
+	tm utc = {};
+#ifdef _WIN32
+	gmtime_s(&utc, &now);
+#else
+	gmtime_r(&now, &utc);
+#endif
+	snprintf(out_string, stringSize, "%d/%d/%d - %d:%d:%d", utc.tm_mday, utc.tm_mon + 1, utc.tm_year + 1900, utc.tm_hour, utc.tm_min, utc.tm_sec);
+}
+
+#ifdef _WIN32
+
+static LogCrashCallback g_crashCallback;
+static LPTOP_LEVEL_EXCEPTION_FILTER g_previousExceptionFilter;
+
+static WORD QueryConsoleAttributes()
+{
+	CONSOLE_SCREEN_BUFFER_INFO csbi;
+	if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi))
+	{//not a console, light grey is what a new one starts with
+		return FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE;
+	}
+	return csbi.wAttributes;
+}
+
+//the colors the console had before the first change, queried once
+static WORD GetDefaultConsoleAttributes()
+{
+	static const WORD defaultAttributes = QueryConsoleAttributes();
+	return defaultAttributes;
+}
+
+void pug::log::SetConsoleColor(uint16_t color)
+{
+	GetDefaultConsoleAttributes();
+	fflush(stdout);//text printed before has to keep its color
+	SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), color);
+}
+
+void pug::log::ResetConsoleColor()
+{
+	fflush(stdout);
+	SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), GetDefaultConsoleAttributes());
+}
+
+static LONG WINAPI LogExceptionFilter(EXCEPTION_POINTERS* exceptionInfo)
+{
+	if (g_crashCallback != nullptr)
+	{
+		g_crashCallback();
+	}
+	return g_previousExceptionFilter != nullptr ? g_previousExceptionFilter(exceptionInfo) : EXCEPTION_CONTINUE_SEARCH;
+}
+
+void pug::log::InstallCrashHandler(LogCrashCallback callback)
+{
+	g_crashCallback = callback;
+	g_previousExceptionFilter = SetUnhandledExceptionFilter(LogExceptionFilter);
+}
+
+void pug::log::RemoveCrashHandler()
+{
+	SetUnhandledExceptionFilter(g_previousExceptionFilter);
+	g_crashCallback = nullptr;
+}
+
+void pug::log::BreakIntoDebugger()
+{
+	__debugbreak();
+}
+
+#else
+
+static const int g_crashSignals[] = { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT };
+#define LOG_CRASH_SIGNAL_COUNT (sizeof(g_crashSignals) / sizeof(g_crashSignals[0]))
+
+static LogCrashCallback g_crashCallback;
+static struct sigaction g_previousActions[LOG_CRASH_SIGNAL_COUNT];
+
+static bool IsConsoleTerminal()
+{
+	static const bool isTerminal = isatty(fileno(stdout)) != 0;
+	return isTerminal;
+}
+
+void pug::log::SetConsoleColor(uint16_t color)
+{
+	if (!IsConsoleTerminal())
+	{
+		return;
+	}
+	//Win32 attribute bits are blue 1, green 2, red 4 and intensity 8, ANSI orders them red 1, green 2, blue 4
+	const int ansiColor = ((color & 0x4) ? 1 : 0) | ((color & 0x2) ? 2 : 0) | ((color & 0x1) ? 4 : 0);
+	printf("\x1b[%dm", ((color & 0x8) ? 90 : 30) + ansiColor);
+}
+
+void pug::log::ResetConsoleColor()
+{
+	if (IsConsoleTerminal())
+	{
+		printf("\x1b[0m");
+	}
+}
+
+//best effort like on Windows, the callback is not async signal safe but the process is going down anyway
+static void LogSignalHandler(int signal)
+{
+	if (g_crashCallback != nullptr)
+	{
+		g_crashCallback();
+	}
+	for (uint32_t i = 0; i < LOG_CRASH_SIGNAL_COUNT; ++i)
+	{//hand the signal to whoever had it before
+		if (g_crashSignals[i] == signal)
+		{
+			sigaction(signal, &g_previousActions[i], nullptr);
+		}
+	}
+	raise(signal);
+}
+
+void pug::log::InstallCrashHandler(LogCrashCallback callback)
+{
+	g_crashCallback = callback;
+	struct sigaction action = {};
+	action.sa_handler = LogSignalHandler;
+	sigemptyset(&action.sa_mask);
+	for (uint32_t i = 0; i < LOG_CRASH_SIGNAL_COUNT; ++i)
+	{
+		sigaction(g_crashSignals[i], &action, &g_previousActions[i]);
+	}
+}
+
+void pug::log::RemoveCrashHandler()
+{
+	for (uint32_t i = 0; i < LOG_CRASH_SIGNAL_COUNT; ++i)
+	{
+		sigaction(g_crashSignals[i], &g_previousActions[i], nullptr);
+	}
+	g_crashCallback = nullptr;
+}
+
+//linux reports the pid of an attached debugger in /proc, 0 when there is none
+static bool IsDebuggerAttached()
+{
+	FILE* status = fopen("/proc/self/status", "r");
+	if (status == nullptr)
+	{
+		return false;
+	}
+	char line[256];
+	int tracerPid = 0;
+	while (fgets(line, sizeof(line), status) != nullptr)
+	{
+		if (sscanf(line, "TracerPid: %d", &tracerPid) == 1)
+		{
+			break;
+		}
+	}
+	fclose(status);
+	return tracerPid != 0;
+}
+
+void pug::log::BreakIntoDebugger()
+{//SIGTRAP is not a crash signal, without a debugger it would kill the process before the log is flushed
+	if (IsDebuggerAttached())
+	{
+		raise(SIGTRAP);
+	}
+}
+
+#endif
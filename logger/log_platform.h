@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+namespace pug{
+namespace log{
+
+	//what the logger needs from the operating system, the Win32 console on Windows and ANSI escape codes on POSIX
+
+	//LOG_COLOR_* values are Win32 console attributes, POSIX maps them to the closest ANSI color
+	//and leaves the output alone when it is not a terminal, e.g. redirected into a file on the cook farm
+	void SetConsoleColor(uint16_t color);
+	void ResetConsoleColor();
+
+	//UTC "day/month/year - hour:minute:second"
+	void GetWallClockString(char* out_string, size_t stringSize);
+
+	//called on unhandled exceptions on Windows and on fatal signals on POSIX, before the previous handler runs
+	typedef void(*LogCrashCallback)();
+	void InstallCrashHandler(LogCrashCallback callback);
+	void RemoveCrashHandler();
+
+	//on POSIX this does nothing when no debugger is attached
+	void BreakIntoDebugger();
+
+}//pug::log
+}//pug
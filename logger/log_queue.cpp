@@ -0,0 +1,141 @@
+#include "log_queue.h"
+#include "../utility/allocator.h"
+
+#include <cstring>
+#include <cassert>
+#include <thread>
+
+//set in the size word of the filler record that skips the end of the ring when a record does not fit there
+#define LOG_QUEUE_PADDING_FLAG 0x80000000
+#define LOG_QUEUE_MIN_CAPACITY 4096
+
+using namespace pug::log;
+
+//record layout: uint32 size word | uint32 payload size | payload | padding up to LOG_QUEUE_RECORD_ALIGNMENT
+//the size word is 0 until the record is published and covers the whole record including the header
+static std::atomic<uint32_t>* GetSizeWord(uint8_t* buffer, uint32_t offset)
+{
+	return reinterpret_cast<std::atomic<uint32_t>*>(buffer + offset);
+}
+
+static uint32_t AlignRecordSize(uint32_t size)
+{
+	return (size + (LOG_QUEUE_RECORD_ALIGNMENT - 1)) & ~(uint32_t)(LOG_QUEUE_RECORD_ALIGNMENT - 1);
+}
+
+LogQueue::LogQueue()
+	: m_buffer(nullptr)
+	, m_capacity(0)
+	, m_head(0)
+	, m_tail(0)
+{
+
+}
+
+LogQueue::~LogQueue()
+{
+	Destroy();
+}
+
+void LogQueue::Initialize(uint32_t capacityBytes)
+{
+	Destroy();
+	m_capacity = LOG_QUEUE_MIN_CAPACITY;
+	while (m_capacity < capacityBytes)
+	{
+		m_capacity <<= 1;
+	}
+	m_buffer = (uint8_t*)pug::utility::Allocate(m_capacity, MEMORY_DEFAULT_ALIGNMENT, pug::utility::MemoryTag_Log);
+	memset(m_buffer, 0, m_capacity);//unpublished records have to read as 0
+	m_head.store(0, std::memory_order_relaxed);
+	m_tail.store(0, std::memory_order_relaxed);
+}
+
+void LogQueue::Destroy()
+{
+	pug::utility::Free(m_buffer);
+	m_buffer = nullptr;
+	m_capacity = 0;
+	m_head.store(0, std::memory_order_relaxed);
+	m_tail.store(0, std::memory_order_relaxed);
+}
+
+bool LogQueue::Push(const char* data, uint32_t size)
+{
+	if (m_buffer == nullptr || size > GetMaxRecordSize())
+	{
+		return false;
+	}
+
+	const uint32_t recordSize = AlignRecordSize(LOG_QUEUE_HEADER_SIZE + size);
+	const uint32_t mask = m_capacity - 1;
+	uint64_t head = m_head.load(std::memory_order_relaxed);
+	uint32_t paddingSize = 0;
+	for (;;)
+	{
+		const uint32_t offset = (uint32_t)(head & mask);
+		//records never wrap, pad the end of the ring and start over at 0 if this one does not fit
+		paddingSize = m_capacity - offset < recordSize ? m_capacity - offset : 0;
+		const uint64_t tail = m_tail.load(std::memory_order_acquire);
+		if (head + paddingSize + recordSize - tail > m_capacity)
+		{//full, give the consumer time to catch up
+			std::this_thread::yield();
+			head = m_head.load(std::memory_order_relaxed);
+			continue;
+		}
+		if (m_head.compare_exchange_weak(head, head + paddingSize + recordSize, std::memory_order_relaxed))
+		{
+			break;
+		}
+	}
+
+	uint32_t offset = (uint32_t)(head & mask);
+	if (paddingSize > 0)
+	{
+		GetSizeWord(m_buffer, offset)->store(paddingSize | LOG_QUEUE_PADDING_FLAG, std::memory_order_release);
+		offset = 0;
+	}
+	memcpy(m_buffer + offset + 4, &size, sizeof(size));
+	memcpy(m_buffer + offset + LOG_QUEUE_HEADER_SIZE, data, size);
+	GetSizeWord(m_buffer, offset)->store(recordSize, std::memory_order_release);//publish
+	return true;
+}
+
+uint64_t LogQueue::Drain(LogQueueWriteFunction write, void* userData)
+{
+	if (m_buffer == nullptr)
+	{
+		return 0;
+	}
+
+	const uint32_t mask = m_capacity - 1;
+	const uint64_t start = m_tail.load(std::memory_order_relaxed);
+	const uint64_t head = m_head.load(std::memory_order_acquire);
+	uint64_t tail = start;
+	while (tail < head)
+	{
+		const uint32_t offset = (uint32_t)(tail & mask);
+		const uint32_t sizeWord = GetSizeWord(m_buffer, offset)->load(std::memory_order_acquire);
+		if (sizeWord == 0)
+		{//reserved but still being copied, picked up by the next drain
+			break;
+		}
+		if ((sizeWord & LOG_QUEUE_PADDING_FLAG) == 0)
+		{
+			uint32_t size = 0;
+			memcpy(&size, m_buffer + offset + 4, sizeof(size));
+			write((const char*)m_buffer + offset + LOG_QUEUE_HEADER_SIZE, size, userData);
+		}
+		tail += sizeWord & ~LOG_QUEUE_PADDING_FLAG;
+	}
+
+	//zero the consumed records before handing them back, the next records published there start with a 0 size word
+	const uint32_t startOffset = (uint32_t)(start & mask);
+	const uint64_t consumed = tail - start;
+	assert(consumed <= m_capacity);
+	const uint32_t firstPart = (uint32_t)(consumed < m_capacity - startOffset ? consumed : m_capacity - startOffset);
+	memset(m_buffer + startOffset, 0, firstPart);
+	memset(m_buffer, 0, (size_t)(consumed - firstPart));
+	m_tail.store(tail, std::memory_order_release);
+	return consumed;
+}
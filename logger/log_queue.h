@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <atomic>
+
+#define LOG_QUEUE_RECORD_ALIGNMENT 8
+#define LOG_QUEUE_HEADER_SIZE 8
+
+namespace pug {
+namespace log {
+
+	//called by the consumer for every record, in the order the records were reserved
+	typedef void(*LogQueueWriteFunction)(const char* data, uint32_t size, void* userData);
+
+	//lock free multi producer single consumer byte ring for log records
+	//producers reserve space with one compare exchange on the head, copy their record and publish it by writing its header,
+	//the consumer reads published records in order, zeroes them and hands the space back by moving the tail
+	class LogQueue
+	{
+	public:
+		LogQueue();
+		~LogQueue();
+
+		void Initialize(uint32_t capacityBytes);//rounded up to a power of two
+		void Destroy();
+
+		//waits for the consumer if the ring is full, records larger than GetMaxRecordSize are rejected
+		bool Push(const char* data, uint32_t size);
+		//consumer side, only one thread may drain at a time, returns the number of bytes handed back to the producers
+		uint64_t Drain(LogQueueWriteFunction write, void* userData);
+
+		uint64_t GetPendingBytes() const { return m_head.load(std::memory_order_relaxed) - m_tail.load(std::memory_order_relaxed); }
+		uint32_t GetCapacity() const { return m_capacity; }
+		uint32_t GetMaxRecordSize() const { return m_capacity / 4 - LOG_QUEUE_HEADER_SIZE; }
+
+	private:
+		uint8_t* m_buffer;
+		uint32_t m_capacity;
+		//on their own cache lines, every producer touches the head and only the consumer writes the tail
+		alignas(64) std::atomic<uint64_t> m_head;
+		alignas(64) std::atomic<uint64_t> m_tail;
+	};
+
+}//pug::log
+}//pug
@@ -1,27 +1,60 @@
 #include "logger.h"
+#include "log_queue.h"
+#include "log_platform.h"
 #include <fstream>
 #include <sstream>
-#include <experimental\filesystem>
+#include <experimental/filesystem>
 #include <iostream>
-
-#include <windows.h>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <vector>
 
 #define MAX_PATH_SIZE 260
+#define LOG_TIMESTAMP_PREFIX_LENGTH 32//"[seconds.microseconds] " in front of every line of the text log
+#define LOG_QUEUE_BYTES (1 << 20)
+#define LOG_WRITER_WAKE_INTERVAL_MS 5//how often the writer thread looks for new records
+#define LOG_DEFAULT_FLUSH_INTERVAL_MS 100
 
 using namespace std::experimental::filesystem;
 using namespace pug::log;
 
 static path g_logFile;
 static std::fstream logFileStream;
-static CONSOLE_SCREEN_BUFFER_INFO g_csbi;
 static uint32_t g_breakLevel;
+std::atomic<uint32_t> pug::log::g_logLevel(LogLevel_Log);
+std::atomic<bool> pug::log::g_binaryLog(false);
+static std::chrono::steady_clock::time_point g_logStartTime;//all timestamps are relative to it
+static std::mutex g_writeLock;//the asset cook tool logs from multiple threads, guards the console
+
+//records are pushed by any thread and written to the file by the writer thread in batches
+static LogQueue g_logQueue;
+static std::thread g_writerThread;
+static std::atomic<bool> g_writerRunning;
+//threads between the g_writerRunning check and the end of their push, EndLog waits for them before the ring goes away
+alignas(64) static std::atomic<uint32_t> g_activeProducers;
+static std::mutex g_drainLock;//one drain at a time, the writer thread or an explicit flush
+static std::mutex g_writerWakeLock;
+static std::condition_variable g_writerWake;
+static std::atomic<uint32_t> g_flushIntervalMilliseconds(LOG_DEFAULT_FLUSH_INTERVAL_MS);
+static std::terminate_handler g_previousTerminateHandler;
+static std::atomic<bool> g_logStarted(false);//EndLog only tears down a log that is running, it can be called more than once
+static bool g_exitHandlerInstalled = false;
+
+//every PUG_LOG call site that ran so far, the index + 1 is the site id the binary log refers to
+static std::mutex g_siteLock;
+static std::vector<LogSite*> g_sites;
 
 void GetDateAndTimeString(std::string& out_string)
 {
-	SYSTEMTIME st;
-	GetSystemTime(&st);
 	char s[MAX_PATH_SIZE];
-	sprintf_s(s, "%d/%d/%d - %d:%d:%d", st.wDay, st.wMonth, st.wYear, st.wHour, st.wMinute, st.wSecond);
+	GetWallClockString(s, sizeof(s));
 	out_string = s;
 }
 
@@ -29,66 +62,320 @@ void GetBreakLevelString(EBreakLevel breakLevel, std::string& out_string)
 {
 	switch (breakLevel)
 	{
-	case(EBreakLevel::BreakLevel_Info): out_string = "Info";
-	case(EBreakLevel::BreakLevel_Message): out_string = "Message";
-	case(EBreakLevel::BreakLevel_Warning): out_string = "Warning";
-	case(EBreakLevel::BreakLevel_Error): out_string = "Error";
+	case(EBreakLevel::BreakLevel_Info): out_string = "Info"; break;
+	case(EBreakLevel::BreakLevel_Message): out_string = "Message"; break;
+	case(EBreakLevel::BreakLevel_Warning): out_string = "Warning"; break;
+	case(EBreakLevel::BreakLevel_Error): out_string = "Error"; break;
 	default: out_string = "Unknown";
 	}
 }
 
 void pug::log::SetTextColor(uint16_t color)
 {
-	HANDLE hstdout = GetStdHandle(STD_OUTPUT_HANDLE);
-	SetConsoleTextAttribute(hstdout, color);
+	SetConsoleColor(color);
 }
 
 void pug::log::ResetTextColor()
 {
-	HANDLE hstdout = GetStdHandle(STD_OUTPUT_HANDLE);
-	SetConsoleTextAttribute(hstdout, g_csbi.wAttributes);
+	ResetConsoleColor();
+}
+
+//microseconds since the log was started, monotonic
+static uint64_t GetLogTimestamp()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - g_logStartTime).count();
+}
+
+static void WriteRecordToFile(const char* data, uint32_t size, void*)
+{
+	if (!logFileStream.write(data, size))
+	{
+		printf("\nFailed to write to log!\n");
+	}
+}
+
+//caller holds g_drainLock
+static void DrainLogQueue(bool flushFile)
+{
+	g_logQueue.Drain(WriteRecordToFile, nullptr);
+	if (flushFile)
+	{
+		logFileStream.flush();
+	}
+}
+
+static void LogWriterThread()
+{
+	std::chrono::steady_clock::time_point lastFlush = std::chrono::steady_clock::now();
+	while (g_writerRunning.load(std::memory_order_acquire))
+	{
+		{
+			std::unique_lock<std::mutex> lock(g_writerWakeLock);
+			g_writerWake.wait_for(lock, std::chrono::milliseconds(LOG_WRITER_WAKE_INTERVAL_MS));
+		}
+		const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		const bool flushFile = now - lastFlush >= std::chrono::milliseconds(g_flushIntervalMilliseconds.load(std::memory_order_relaxed));
+		{
+			std::lock_guard<std::mutex> lock(g_drainLock);
+			DrainLogQueue(flushFile);
+		}
+		if (flushFile)
+		{
+			lastFlush = now;
+		}
+	}
+}
+
+//best effort, the crashing thread might be the one holding the drain lock
+static void FlushLogOnCrash()
+{
+	if (g_drainLock.try_lock())
+	{
+		DrainLogQueue(true);
+		g_drainLock.unlock();
+	}
+	else
+	{
+		logFileStream.flush();
+	}
+}
+
+static void LogTerminateHandler()
+{
+	FlushLogOnCrash();
+	if (g_previousTerminateHandler != nullptr)
+	{
+		g_previousTerminateHandler();
+	}
+	abort();
 }
 
 void pug::log::WriteToLog(const std::string& text)
 {
-	if (!logFileStream.write(text.c_str(), text.length()))
+	WriteToLog(text.c_str(), text.length());
+}
+
+static void QueueLogBytes(const char* data, size_t length)
+{
+	//sequentially consistent with the store in EndLog, either EndLog sees this producer or the producer sees the log stopped
+	g_activeProducers.fetch_add(1, std::memory_order_seq_cst);
+	if (!g_writerRunning.load(std::memory_order_seq_cst))
+	{//no log file open
+		g_activeProducers.fetch_sub(1, std::memory_order_release);
+		return;
+	}
+	//a line is one record, only texts longer than a record are split
+	const uint32_t maxRecordSize = g_logQueue.GetMaxRecordSize();
+	for (size_t offset = 0; offset < length; offset += maxRecordSize)
 	{
-		printf("/nFailed to write to log!/n");
+		const size_t remaining = length - offset;
+		g_logQueue.Push(data + offset, (uint32_t)(remaining < maxRecordSize ? remaining : maxRecordSize));
+	}
+	if (g_logQueue.GetPendingBytes() > g_logQueue.GetCapacity() / 2)
+	{//do not wait for the next wake up when the ring fills up
+		g_writerWake.notify_one();
+	}
+	g_activeProducers.fetch_sub(1, std::memory_order_release);
+}
+
+//in binary mode the text goes into text records, split if it does not fit into one
+static void WriteTextToLog(ELogLevel level, const char* text, size_t length)
+{
+	if (!IsBinaryLogEnabled())
+	{//prefixed with the timestamp and queued together, text that does not fit behind it follows in a second record
+		char buffer[LOG_TIMESTAMP_PREFIX_LENGTH + LOG_MAX_LINE_LENGTH + 1];
+		const uint64_t timestamp = GetLogTimestamp();
+		const int prefixLength = snprintf(buffer, LOG_TIMESTAMP_PREFIX_LENGTH, "[%6llu.%06llu] ", (unsigned long long)(timestamp / 1000000), (unsigned long long)(timestamp % 1000000));
+		const size_t prefix = prefixLength > 0 && prefixLength < LOG_TIMESTAMP_PREFIX_LENGTH ? (size_t)prefixLength : 0;
+		const size_t copyLength = length < sizeof(buffer) - prefix ? length : sizeof(buffer) - prefix;
+		memcpy(buffer + prefix, text, copyLength);
+		QueueLogBytes(buffer, prefix + copyLength);
+		if (copyLength < length)
+		{
+			QueueLogBytes(text + copyLength, length - copyLength);
+		}
+		return;
 	}
-	logFileStream.flush();
+	const uint32_t recordLevel = level;
+	size_t offset = 0;
+	do
+	{
+		LogRecord record;
+		BeginLogRecord(record, PlogRecord_Text);
+		AppendLogRecordBytes(record, &recordLevel, sizeof(recordLevel));
+		const size_t space = LOG_MAX_LINE_LENGTH - record.length;
+		const size_t chunk = length - offset < space ? length - offset : space;
+		AppendLogRecordBytes(record, text + offset, chunk);
+		WriteLogRecord(record);
+		offset += chunk;
+	} while (offset < length);
+}
+
+void pug::log::WriteToLog(const char* text, size_t length)
+{
+	WriteTextToLog(LogLevel_Log, text, length);
+}
+
+void pug::log::WriteLogRecord(LogRecord& record)
+{
+	PlogRecordHeader header;
+	memcpy(&header, record.data, sizeof(header));
+	header.size = record.length - sizeof(header);
+	header.timestamp = GetLogTimestamp();
+	memcpy(record.data, &header, sizeof(header));
+	QueueLogBytes((const char*)record.data, record.length);
+}
+
+//caller holds g_siteLock
+static void WriteSiteRecord(const LogSite& site, uint32_t id)
+{
+	LogRecord record;
+	BeginLogRecord(record, PlogRecord_Site);
+	const uint32_t fields[4] = { id, site.level, site.line, site.format->length };
+	AppendLogRecordBytes(record, fields, sizeof(fields));
+	AppendLogRecordBytes(record, site.format->text, site.format->length);
+	//the source file is only for reference, cut it if it does not fit
+	const size_t fileLength = strlen(site.file);
+	const size_t space = LOG_MAX_LINE_LENGTH - record.length;
+	AppendLogRecordBytes(record, site.file, fileLength < space ? fileLength : space);
+	WriteLogRecord(record);
+}
+
+uint32_t pug::log::RegisterLogSite(LogSite& site)
+{
+	std::lock_guard<std::mutex> lock(g_siteLock);
+	uint32_t id = site.id.load(std::memory_order_relaxed);
+	if (id == 0)
+	{//another thread might have registered it while we waited
+		g_sites.push_back(&site);
+		id = (uint32_t)g_sites.size();
+		if (IsBinaryLogEnabled())
+		{//before the id is published, no line can refer to it earlier in the queue
+			WriteSiteRecord(site, id);
+		}
+		site.id.store(id, std::memory_order_release);
+	}
+	return id;
+}
+
+void pug::log::SetLogLevel(ELogLevel level)
+{
+	g_logLevel.store(level, std::memory_order_relaxed);
+}
+
+void pug::log::FlushLog()
+{
+	std::lock_guard<std::mutex> lock(g_drainLock);
+	DrainLogQueue(true);
+}
+
+void pug::log::SetLogFlushInterval(uint32_t milliseconds)
+{
+	g_flushIntervalMilliseconds.store(milliseconds, std::memory_order_relaxed);
 }
 
 void pug::log::WriteToConsole(const std::string& text)
 {
+	std::lock_guard<std::mutex> lock(g_writeLock);
 	printf("%s", text.c_str());
 }
 
-uint32_t pug::log::StartLog(const std::string& logFilePath, const pug::log::EBreakLevel breakLevel /* = EBreakLevel::BreakLevel_Error */)
+//returning from main without EndLog would destroy the joinable writer thread and terminate
+static void EndLogAtExit()
+{
+	EndLog();
+}
+
+uint32_t pug::log::StartLog(const std::string& logFilePath, const pug::log::EBreakLevel breakLevel /* = EBreakLevel::BreakLevel_Error */, const ELogFileFormat fileFormat /* = LogFileFormat_Text */)
 {
-	g_logFile = path(logFilePath) / "log.txt";
-	logFileStream.open(g_logFile.c_str(), std::fstream::in | std::fstream::out | std::fstream::trunc);
+	const bool binary = fileFormat == LogFileFormat_Binary;
+	g_logFile = path(logFilePath) / (binary ? "log.plog" : "log.txt");
+	std::ios_base::openmode openMode = std::fstream::in | std::fstream::out | std::fstream::trunc;
+	if (binary)
+	{//no line ending translation for the records
+		openMode |= std::fstream::binary;
+	}
+	logFileStream.open(g_logFile.c_str(), openMode);
 	
 	if (!logFileStream.is_open())
 	{
 		return -1;
 	}
 
+	g_logStartTime = std::chrono::steady_clock::now();
+	if (binary)
+	{
+		PlogFileHeader header;
+		header.magic = PLOG_FILE_MAGIC;
+		header.version = PLOG_FILE_VERSION;
+		header.startTime = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		logFileStream.write((const char*)&header, sizeof(header));
+	}
+
+	g_logQueue.Initialize(LOG_QUEUE_BYTES);
+	g_writerRunning.store(true, std::memory_order_release);
+	g_writerThread = std::thread(LogWriterThread);
+	g_previousTerminateHandler = std::set_terminate(LogTerminateHandler);
+	InstallCrashHandler(FlushLogOnCrash);
+	g_logStarted.store(true, std::memory_order_release);
+	if (!g_exitHandlerInstalled)
+	{//registered after every static of this file is constructed, so it runs before they are destroyed
+		atexit(EndLogAtExit);
+		g_exitHandlerInstalled = true;
+	}
+
+	if (binary)
+	{//call sites that already ran before this log was started have to be described as well
+		std::lock_guard<std::mutex> lock(g_siteLock);
+		g_binaryLog.store(true, std::memory_order_relaxed);
+		for (uint32_t i = 0; i < (uint32_t)g_sites.size(); ++i)
+		{
+			WriteSiteRecord(*g_sites[i], i + 1);
+		}
+	}
+
 	g_breakLevel = breakLevel;
 	std::string breakLevelString;
 	GetBreakLevelString(breakLevel, breakLevelString);
 	std::string timeAndDate;
 	GetDateAndTimeString(timeAndDate);
-	WriteToLog(" -- " + timeAndDate + " BEGINNING LOG -- Debug Break Level set to" + breakLevelString + "\n");
+	WriteToLog(" -- " + timeAndDate + " BEGINNING LOG -- Debug Break Level set to " + breakLevelString + ", lines are stamped with the seconds since this one\n");
 
 	return 0;
 }
 
 uint32_t pug::log::EndLog()
 {
+	if (!g_logStarted.exchange(false))
+	{
+		return 0;
+	}
+
 	std::string timeAndDate;
 	GetDateAndTimeString(timeAndDate);
 	WriteToLog(" -- " + timeAndDate + " ENDING LOG -- \n");
 
+	//stop the writer and write out whatever it did not get to
+	g_writerRunning.store(false, std::memory_order_seq_cst);
+	g_writerWake.notify_one();
+	if (g_writerThread.joinable())
+	{
+		g_writerThread.join();
+	}
+	while (g_activeProducers.load(std::memory_order_acquire) != 0)
+	{//producers that passed the check are still pushing, keep draining so a full ring does not block them
+		{
+			std::lock_guard<std::mutex> lock(g_drainLock);
+			DrainLogQueue(false);
+		}
+		std::this_thread::yield();
+	}
+	FlushLog();
+	g_binaryLog.store(false, std::memory_order_relaxed);
+	std::set_terminate(g_previousTerminateHandler);
+	RemoveCrashHandler();
+	g_logQueue.Destroy();
+
 	logFileStream.close();
 	if (logFileStream.is_open())
 	{
@@ -99,99 +386,127 @@ uint32_t pug::log::EndLog()
 	return 0;
 }
 
-void pug::log::Log(const char* log)
+static uint16_t GetLevelColor(ELogLevel level)
 {
-	std::stringstream buffer;
-	while (log && *log)
+	switch (level)
 	{
-		buffer << *log++;//stream in characters
+	case LogLevel_Message: return LOG_COLOR_GREEN;
+	case LogLevel_Warning: return LOG_COLOR_YELLOW;
+	case LogLevel_Error:
+	case LogLevel_Assert: return LOG_COLOR_RED;
+	default: return LOG_COLOR_WHITE;
 	}
-	buffer << std::endl;
-	WriteToLog(buffer.str());
 }
-void pug::log::Info(const char* info)
+
+static bool ShouldBreak(ELogLevel level)
 {
-	std::stringstream buffer;
-	SetTextColor(LOG_COLOR_WHITE);
-	while (info && *info)
+	switch (level)
 	{
-		buffer << *info++;//stream in characters
-	}
-	buffer << std::endl;
-	WriteToLog(buffer.str());
-	WriteToConsole(buffer.str());
-	ResetTextColor();
-	if (g_breakLevel >= BreakLevel_Info)
-	{
-		__debugbreak();
+	case LogLevel_Info: return g_breakLevel >= BreakLevel_Info;
+	case LogLevel_Message: return g_breakLevel >= BreakLevel_Message;
+	case LogLevel_Warning: return g_breakLevel >= BreakLevel_Warning;
+	case LogLevel_Error: return g_breakLevel >= BreakLevel_Error;
+	default: return false;//plain logs never break, asserts break in the macro
 	}
 }
-void pug::log::Message(const char* message)
+
+//text includes the line break
+static void WriteLineToConsole(ELogLevel level, const char* text, size_t length)
 {
-	std::stringstream buffer;
-	SetTextColor(LOG_COLOR_GREEN);
-	while (message && *message)
+	if (level == LogLevel_Log)
 	{
-		buffer << *message++;//stream in characters
+		return;
 	}
-	buffer << std::endl;
-	WriteToLog(buffer.str());
-	WriteToConsole(buffer.str());
+	//color and text under one lock so lines from different threads keep their colors
+	std::lock_guard<std::mutex> lock(g_writeLock);
+	SetTextColor(GetLevelColor(level));
+	fwrite(text, 1, length, stdout);
 	ResetTextColor();
-	if (g_breakLevel >= BreakLevel_Message)
+}
+
+static void TerminateLine(LogLine& line)
+{
+	if (line.truncated)
 	{
-		__debugbreak();
+		memcpy(line.text + LOG_MAX_LINE_LENGTH - 3, "...", 3);
 	}
+	line.text[line.length++] = '\n';//LogLine has room for it
 }
-void pug::log::Warning(const char* warning)
+
+void pug::log::WriteLogLine(ELogLevel level, LogLine& line)
 {
-	std::stringstream buffer;
-	SetTextColor(LOG_COLOR_YELLOW);
-	while (warning && *warning)
+	TerminateLine(line);
+	WriteTextToLog(level, line.text, line.length);
+	WriteLineToConsole(level, line.text, line.length);
+	if (ShouldBreak(level))
 	{
-		buffer << *warning++;//stream in characters
+		BreakIntoDebugger();
 	}
-	buffer << std::endl;
-	WriteToLog(buffer.str());
-	WriteToConsole(buffer.str());
-	ResetTextColor();
-	if (g_breakLevel >= BreakLevel_Warning)
+}
+
+void pug::log::WriteConsoleLine(ELogLevel level, LogLine& line)
+{
+	TerminateLine(line);
+	WriteLineToConsole(level, line.text, line.length);
+	if (ShouldBreak(level))
 	{
-		__debugbreak();
+		BreakIntoDebugger();
 	}
 }
-void pug::log::Error(const char* error)
+
+void pug::log::WriteLogText(ELogLevel level, const char* text)
 {
-	std::stringstream buffer;
-	SetTextColor(LOG_COLOR_RED);
-	while (error && *error)
+	if (!IsLogLevelEnabled(level))
 	{
-		buffer << *error++;//stream in characters
+		return;
 	}
-	buffer << std::endl;
-	WriteToLog(buffer.str());
-	WriteToConsole(buffer.str());
-	ResetTextColor();
-	if (g_breakLevel >= BreakLevel_Error)
+	LogLine line;
+	line.length = 0;
+	line.truncated = false;
+	const size_t length = text != nullptr ? strlen(text) : 0;
+	if (length <= LOG_MAX_LINE_LENGTH)
+	{
+		AppendLogText(line, text, length);
+		WriteLogLine(level, line);
+		return;
+	}
+	//too long for a line, the only case that allocates
+	std::string longLine(text, length);
+	longLine += '\n';
+	WriteTextToLog(level, longLine.c_str(), longLine.length());
+	WriteLineToConsole(level, longLine.c_str(), longLine.length());
+	if (ShouldBreak(level))
 	{
-		__debugbreak();
+		BreakIntoDebugger();
 	}
 }
+
+void pug::log::Log(const char* log)
+{
+	WriteLogText(LogLevel_Log, log);
+}
+void pug::log::Info(const char* info)
+{
+	WriteLogText(LogLevel_Info, info);
+}
+void pug::log::Message(const char* message)
+{
+	WriteLogText(LogLevel_Message, message);
+}
+void pug::log::Warning(const char* warning)
+{
+	WriteLogText(LogLevel_Warning, warning);
+}
+void pug::log::Error(const char* error)
+{
+	WriteLogText(LogLevel_Error, error);
+}
 	 
 //special case for our assert macro, 
 //we dont want to trigger a break point twice
 void pug::log::LogAssert(const char* error)
 {//just an error msg without breaking
-	std::stringstream buffer;
-	SetTextColor(LOG_COLOR_RED);
-	while (error && *error)
-	{
-		buffer << *error++;//stream in characters
-	}
-	buffer << std::endl;
-	WriteToLog(buffer.str());
-	WriteToConsole(buffer.str());
-	ResetTextColor();
+	WriteLogText(LogLevel_Assert, error);
 }
 
 std::string pug::log::GetLogFilePath()
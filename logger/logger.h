@@ -1,7 +1,15 @@
 #pragma once
+#include "log_format.h"
+#include "log_binary.h"
 #include <string>
 #include <sstream>
 #include <iostream>
+#include <atomic>
+
+//calls of the PUG_LOG macros below this ELogLevel are compiled out, 0 keeps all of them
+#ifndef PUG_LOG_MIN_LEVEL
+#define PUG_LOG_MIN_LEVEL 0
+#endif
 
 namespace pug{
 namespace log{
@@ -19,14 +27,59 @@ namespace log{
 		BreakLevel_Error = 8,
 	};
 
-	uint32_t StartLog(const std::string& logFilePath, const pug::log::EBreakLevel breakLevel = EBreakLevel::BreakLevel_Error);
+	enum ELogFileFormat : uint32_t
+	{
+		LogFileFormat_Text = 0,//log.txt
+		LogFileFormat_Binary,//log.plog, see plog_format.h, turned back into text by log_decoder
+	};
+
+	uint32_t StartLog(const std::string& logFilePath, const pug::log::EBreakLevel breakLevel = EBreakLevel::BreakLevel_Error, const ELogFileFormat fileFormat = LogFileFormat_Text);
 	uint32_t EndLog();
 
 	void SetTextColor(uint16_t color);
 	void ResetTextColor();
 
 	void WriteToConsole(const std::string& text);
+	//queued, a writer thread started by StartLog writes the queued text to the file in batches
 	void WriteToLog(const std::string& text);
+	void WriteToLog(const char* text, size_t length);
+	//blocks until everything logged so far is written and flushed, EndLog and crashes flush as well
+	void FlushLog();
+	//how often the writer thread flushes the file, 0 flushes after every batch
+	void SetLogFlushInterval(uint32_t milliseconds);
+
+	enum ELogLevel : uint32_t
+	{
+		LogLevel_Log = 0,//log file only
+		LogLevel_Info,
+		LogLevel_Message,
+		LogLevel_Warning,
+		LogLevel_Error,
+		LogLevel_Assert,//an error that does not break, the assert macro breaks itself
+	};
+
+	//lines below this level are dropped before they are formatted, everything is logged by default
+	extern std::atomic<uint32_t> g_logLevel;
+	void SetLogLevel(ELogLevel level);
+	inline bool IsLogLevelEnabled(ELogLevel level)
+	{
+		return (uint32_t)level >= g_logLevel.load(std::memory_order_relaxed);
+	}
+
+	extern std::atomic<bool> g_binaryLog;
+	inline bool IsBinaryLogEnabled()
+	{
+		return g_binaryLog.load(std::memory_order_relaxed);
+	}
+
+	//hands one finished line to the log file and the console, the line break is added here
+	void WriteLogLine(ELogLevel level, LogLine& line);
+	//console only, for lines that went to the binary log as a record
+	void WriteConsoleLine(ELogLevel level, LogLine& line);
+	//timestamps a binary record and queues it for the log file
+	void WriteLogRecord(LogRecord& record);
+	//unformatted text, written as is
+	void WriteLogText(ELogLevel level, const char* text);
 
 	void Log(const char* log);
 	void Info(const char* info);
@@ -36,119 +89,101 @@ namespace log{
 
 	void LogAssert(const char* error);
 
-	///http://www.stroustrup.com/C++11FAQ.html#variadic-templates
-	template<typename T, typename... Args>
-	void Log(const char* log, T value, Args... args)
+	template<typename... Args>
+	void WriteFormattedLog(ELogLevel level, const LogFormat& format, const Args&... args)
+	{
+		LogLine line;
+		FormatLogLine(line, format, args...);
+		WriteLogLine(level, line);
+	}
+
+	//the PUG_LOG macros, in binary mode the arguments are stored raw and only warnings and errors are formatted for the console
+	template<typename... Args>
+	void WriteFormattedLog(ELogLevel level, LogSite& site, const Args&... args)
 	{
-		std::stringstream buffer;
-		while (log && *log)
+		if (IsBinaryLogEnabled())
 		{
-			if (*log == '%' && *++log != '%')
-			{	// a format specifier (ignore which one it is)
-				buffer << value;//stream in the value
-				WriteToLog(buffer.str());
-				Log(++log, args...); 	// ``peel off'' first argument
-				break;
+			LogRecord record;
+			EncodeLogLine(record, GetLogSiteID(site), args...);
+			WriteLogRecord(record);
+			if (level >= LogLevel_Warning)
+			{
+				LogLine line;
+				FormatLogLine(line, *site.format, args...);
+				WriteConsoleLine(level, line);
 			}
-			buffer << *log++;//stream in characters
+			return;
 		}
+		WriteFormattedLog(level, *site.format, args...);
 	}
-	template<typename T, typename... Args>
-	void Info(const char* info, T value, Args... args)
+
+	//the format is parsed at runtime, the PUG_LOG macros below do that at compile time
+	template<typename... Args>
+	void ParseAndWriteFormattedLog(ELogLevel level, const char* format, const Args&... args)
 	{
-		std::stringstream buffer;
-		SetTextColor(LOG_COLOR_WHITE);
-		while (info && *info)
+		if (!IsLogLevelEnabled(level))
 		{
-			if (*info == '%' && *++info != '%')
-			{	// a format specifier (ignore which one it is)
-				buffer << value;//stream in the value
-				WriteToLog(buffer.str());
-				WriteToConsole(buffer.str());
-				Info(++info, args...); 	// ``peel off'' first argument
-				break;
-			}
-			buffer << *info++;//stream in characters
+			return;
 		}
-		ResetTextColor();
+		LogFormat parsedFormat;
+		ParseLogFormat(format, parsedFormat);
+		WriteFormattedLog(level, parsedFormat, args...);
 	}
+
 	template<typename T, typename... Args>
-	void Message(const char* message, T value, Args... args)
+	void Log(const char* log, const T& value, const Args&... args)
 	{
-		std::stringstream buffer;
-		SetTextColor(LOG_COLOR_GREEN);
-		while (message && *message)
-		{
-			if (*message == '%' && *++message != '%')
-			{	// a format specifier (ignore which one it is)
-				buffer << value;//stream in the value
-				WriteToLog(buffer.str());
-				WriteToConsole(buffer.str());
-				Message(++message, args...); 	// ``peel off'' first argument
-				break;
-			}
-			buffer << *message++;//stream in characters
-		}
-		ResetTextColor();
+		ParseAndWriteFormattedLog(LogLevel_Log, log, value, args...);
 	}
 	template<typename T, typename... Args>
-	void Warning(const char* warning, T value, Args... args)
+	void Info(const char* info, const T& value, const Args&... args)
 	{
-		std::stringstream buffer;
-		SetTextColor(LOG_COLOR_YELLOW);
-		while (warning && *warning)
-		{
-			if (*warning == '%' && *++warning != '%')
-			{	// a format specifier (ignore which one it is)
-				buffer << value;//stream in the value
-				WriteToLog(buffer.str());
-				WriteToConsole(buffer.str());
-				Warning(++warning, args...); 	// ``peel off'' first argument
-				break;
-			}
-			buffer << *warning++;//stream in characters
-		}
-		ResetTextColor();
+		ParseAndWriteFormattedLog(LogLevel_Info, info, value, args...);
 	}
 	template<typename T, typename... Args>
-	void Error(const char* error, T value, Args... args)
+	void Message(const char* message, const T& value, const Args&... args)
 	{
-		std::stringstream buffer;
-		SetTextColor(LOG_COLOR_RED);
-		while (error && *error)
-		{
-			if (*error == '%' && *++error != '%')
-			{	// a format specifier (ignore which one it is)
-				buffer << value;//stream in the value
-				WriteToLog(buffer.str());
-				WriteToConsole(buffer.str());
-				Error(++error, args...); 	// ``peel off'' first argument
-				break;
-			}
-			buffer << *error++;//stream in characters
-		}
-		ResetTextColor();
+		ParseAndWriteFormattedLog(LogLevel_Message, message, value, args...);
 	}
 	template<typename T, typename... Args>
-	void LogAssert(const char* error, T value, Args... args)
+	void Warning(const char* warning, const T& value, const Args&... args)
 	{
-		std::stringstream buffer;
-		SetTextColor(g_colors[1]);
-		while (error && *error)
-		{
-			if (*error == '%' && *++error != '%')
-			{	// a format specifier (ignore which one it is)
-				buffer << value;//stream in the value
-				WriteToLog(buffer.str());
-				WriteToConsole(buffer.str());
-				Error(++error, args...); 	// ``peel off'' first argument
-				break;
-			}
-			buffer << *error++;//stream in characters
-		}
-		ResetTextColor();
+		ParseAndWriteFormattedLog(LogLevel_Warning, warning, value, args...);
+	}
+	template<typename T, typename... Args>
+	void Error(const char* error, const T& value, const Args&... args)
+	{
+		ParseAndWriteFormattedLog(LogLevel_Error, error, value, args...);
+	}
+	template<typename T, typename... Args>
+	void LogAssert(const char* error, const T& value, const Args&... args)
+	{
+		ParseAndWriteFormattedLog(LogLevel_Assert, error, value, args...);
 	}
 
 	std::string GetLogFilePath();
 }//pug::log
-}//pug
\ No newline at end of file
+}//pug
+
+//the format has to be a string literal, it is split and checked against the arguments at compile time
+//levels below PUG_LOG_MIN_LEVEL fold the condition to false, the arguments are still compiled but never evaluated
+#define PUG_LOG_FORMATTED(level, format, ...)																								\
+	do																																		\
+	{																																		\
+		if ((uint32_t)(level) < PUG_LOG_MIN_LEVEL || !pug::log::IsLogLevelEnabled(level))													\
+		{																																	\
+			break;																															\
+		}																																	\
+		static constexpr pug::log::LogFormat pug_log_format = pug::log::MakeLogFormat(format);											\
+		static_assert(pug_log_format.argumentCount <= LOG_MAX_ARGUMENTS, "Too many log arguments: " format);								\
+		static_assert(pug_log_format.argumentCount == decltype(pug::log::CountLogArguments(__VA_ARGS__))::value,						\
+			"Log arguments do not match the format: " format);																				\
+		static pug::log::LogSite pug_log_site = { &pug_log_format, __FILE__, __LINE__, (uint32_t)(level) };						\
+		pug::log::WriteFormattedLog(level, pug_log_site, ##__VA_ARGS__);																\
+	} while (0)
+
+#define PUG_LOG(format, ...) PUG_LOG_FORMATTED(pug::log::LogLevel_Log, format, ##__VA_ARGS__)
+#define PUG_INFO(format, ...) PUG_LOG_FORMATTED(pug::log::LogLevel_Info, format, ##__VA_ARGS__)
+#define PUG_MESSAGE(format, ...) PUG_LOG_FORMATTED(pug::log::LogLevel_Message, format, ##__VA_ARGS__)
+#define PUG_WARNING(format, ...) PUG_LOG_FORMATTED(pug::log::LogLevel_Warning, format, ##__VA_ARGS__)
+#define PUG_ERROR(format, ...) PUG_LOG_FORMATTED(pug::log::LogLevel_Error, format, ##__VA_ARGS__)
\ No newline at end of file
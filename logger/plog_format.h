@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+
+#define PLOG_FILE_MAGIC 0x474F4C50//"PLOG" when read as bytes
+#define PLOG_FILE_VERSION 1
+
+namespace pug{
+namespace log{
+
+	//binary log file layout, written when the log is started with LogFileFormat_Binary and read back by log_decoder
+	//header | records, every record is a PlogRecordHeader followed by its payload, records are packed without alignment
+	//a call site is described once by a site record, the lines logged from it only carry its id and the raw arguments
+
+	struct PlogFileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t startTime;//microseconds since the unix epoch, record timestamps are relative to it
+	};//16 bytes
+
+	enum EPlogRecordType : uint32_t
+	{
+		PlogRecord_Site = 1,//uint32 site id | uint32 level | uint32 source line | uint32 format length | format | source file
+		PlogRecord_Line,//uint32 site id | arguments
+		PlogRecord_Text,//uint32 level | text, lines that were formatted where they were logged
+	};
+
+	struct PlogRecordHeader
+	{
+		uint32_t type;
+		uint32_t size;//payload bytes following the header
+		uint64_t timestamp;//microseconds since PlogFileHeader::startTime
+	};//16 bytes
+
+	//every argument of a line record is one of these followed by its value
+	enum EPlogArgumentType : uint8_t
+	{
+		PlogArgument_Int = 0,//int64
+		PlogArgument_UInt,//uint64
+		PlogArgument_Float,//double
+		PlogArgument_Char,//1 byte
+		PlogArgument_Bool,//1 byte
+		PlogArgument_Pointer,//uint64
+		PlogArgument_String,//uint32 length | characters
+		PlogArgument_Null,//no value, a null string or pointer
+	};
+
+}//pug::log
+}//pug
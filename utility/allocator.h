@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+#define MEMORY_DEFAULT_ALIGNMENT 16
+
+namespace pug {
+namespace utility {
+
+	//who owns an allocation, every tag keeps its own counters
+	enum EMemoryTag : uint32_t
+	{
+		MemoryTag_Untagged = 0,
+		MemoryTag_Resource,
+		MemoryTag_Graphics,
+		MemoryTag_Log,
+		MemoryTag_Cooker,
+		MemoryTag_Count
+	};
+
+	//where tagged allocations get their memory from, the system heap unless SetAllocator replaced it
+	class Allocator
+	{
+	public:
+		virtual ~Allocator() {}
+		//alignment is a power of two, nullptr when out of memory
+		virtual void* Allocate(size_t size, size_t alignment) = 0;
+		virtual void Free(void* memory) = 0;
+	};
+
+	Allocator* GetSystemAllocator();
+	//only affects later allocations, memory is always returned to the allocator it came from
+	//so a replaced allocator has to stay alive until everything it handed out is freed
+	void SetAllocator(Allocator* allocator);
+	Allocator* GetAllocator();
+
+	//counters are updated lock free, each tag on its own cache line
+	void* Allocate(size_t size, size_t alignment, EMemoryTag tag);
+	void Free(void* memory);//accepts nullptr
+
+	//memory the allocator never sees, static tables or memory owned by the driver, negative bytes when it is released
+	void TrackMemory(EMemoryTag tag, int64_t bytes);
+
+	template<typename T, typename... Args>
+	T* New(EMemoryTag tag, Args&&... args)
+	{
+		void* memory = Allocate(sizeof(T), alignof(T) > MEMORY_DEFAULT_ALIGNMENT ? alignof(T) : MEMORY_DEFAULT_ALIGNMENT, tag);
+		return memory != nullptr ? new (memory) T(std::forward<Args>(args)...) : nullptr;
+	}
+
+	template<typename T>
+	void Delete(T* object)
+	{
+		if (object != nullptr)
+		{
+			object->~T();
+			Free(object);
+		}
+	}
+
+	struct MemoryTagStats
+	{
+		int64_t liveBytes;
+		int64_t peakBytes;
+		int64_t liveAllocations;
+		int64_t totalAllocations;//every allocation since startup, freed ones included
+	};
+
+	struct MemoryStats
+	{
+		MemoryTagStats tags[MemoryTag_Count];
+	};
+
+	const char* GetMemoryTagName(EMemoryTag tag);
+	//a snapshot, tags are read one after the other so they can be off by allocations that happen meanwhile
+	void GetMemoryStats(MemoryStats& out_stats);
+	//after - before for every counter, e.g. what a level load left behind
+	void DiffMemoryStats(const MemoryStats& before, const MemoryStats& after, MemoryStats& out_diff);
+	//one line per tag and a total, for the log or the console
+	void FormatMemoryStats(const MemoryStats& stats, char* out_text, size_t textSize);
+
+}//pug::utility
+}//pug
@@ -0,0 +1,199 @@
+#pragma once
+#include "hash.h"
+
+#include <type_traits>
+
+#define HASH128_LANES 8
+#define HASH128_SECRET_BYTES 192
+#define HASH128_STRIPES_PER_BLOCK ((HASH128_SECRET_BYTES - HASH128_STRIPE_BYTES) / 8)//16 stripes, 1024 bytes
+#define HASH128_SCRAMBLE_SECRET (HASH128_SECRET_BYTES - HASH128_STRIPE_BYTES)
+
+#define HASH128_PRIME32_1 0x9E3779B1U
+#define HASH128_PRIME32_2 0x85EBCA77U
+#define HASH128_PRIME32_3 0xC2B2AE3DU
+#define HASH128_PRIME64_1 0x9E3779B185EBCA87ULL
+#define HASH128_PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define HASH128_PRIME64_3 0x165667B19E3779F9ULL
+#define HASH128_PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define HASH128_PRIME64_5 0x27D4EB2F165667C5ULL
+
+//Hash128 of a string literal evaluated by the compiler, '\' is hashed as '/' so windows paths give the same id
+#define PUG_CONST_HASH128(string) \
+	(pug::utility::Hash128{ \
+		std::integral_constant<uint64_t, pug::utility::ConstHashPath128(string).low>::value, \
+		std::integral_constant<uint64_t, pug::utility::ConstHashPath128(string).high>::value })
+
+namespace pug {
+namespace utility {
+
+	//splitmix64 output seeded with the golden ratio, any high entropy bytes work here
+	//changing them changes every asset id, so they are fixed for good
+	alignas(16) constexpr uint8_t HASH128_SECRET[HASH128_SECRET_BYTES] =
+	{
+		0xf4, 0x65, 0xb9, 0xa1, 0x6a, 0x9e, 0x78, 0x6e, 0x4f, 0x45, 0x09, 0x80, 0x18, 0x5d, 0xc4, 0x06,
+		0xec, 0x81, 0x4c, 0x72, 0xa8, 0xb8, 0x8b, 0xf8, 0x9b, 0x74, 0xa8, 0x51, 0x6a, 0x89, 0x39, 0x1b,
+		0xea, 0xa2, 0x7e, 0x74, 0x0c, 0x9f, 0xcb, 0x53, 0xe1, 0x32, 0x45, 0x1f, 0xbe, 0x9a, 0x82, 0x2c,
+		0x3c, 0xab, 0x16, 0xc9, 0x3a, 0x13, 0x84, 0xc5, 0xc3, 0x8a, 0xc9, 0x41, 0x90, 0x78, 0xe5, 0x3e,
+		0xa6, 0xb0, 0x8c, 0x36, 0x8c, 0x48, 0xb8, 0xf3, 0x09, 0x3d, 0xb1, 0x3c, 0xdd, 0xec, 0x7e, 0x65,
+		0xf6, 0xde, 0x5b, 0x05, 0xe0, 0x26, 0xd3, 0xc2, 0x7b, 0xdb, 0xbb, 0xe0, 0x3f, 0xa0, 0x21, 0x86,
+		0x2f, 0xa9, 0x3a, 0x98, 0x55, 0x75, 0x1f, 0x8e, 0x19, 0x4d, 0xcc, 0x00, 0x16, 0x0f, 0x4e, 0xb5,
+		0xab, 0x80, 0x1d, 0x97, 0x97, 0x3f, 0xbb, 0x84, 0x55, 0x12, 0x52, 0x75, 0x5c, 0x82, 0x29, 0x7d,
+		0x86, 0x7f, 0x7f, 0x2b, 0x10, 0x17, 0xcf, 0xc3, 0x64, 0x4f, 0x91, 0x83, 0xa0, 0xe9, 0x66, 0x34,
+		0xac, 0x85, 0x44, 0x5a, 0x2b, 0x8d, 0x1a, 0xd8, 0xd7, 0x9e, 0x0b, 0x10, 0x2b, 0x60, 0x01, 0xdb,
+		0x0d, 0xf1, 0x25, 0x18, 0x92, 0x8a, 0x03, 0xa9, 0x6a, 0x2f, 0xca, 0x0d, 0xd9, 0xf1, 0xf5, 0xed,
+		0x4c, 0x63, 0xd2, 0x7b, 0xd6, 0x6a, 0x49, 0x54, 0x69, 0x72, 0x40, 0xf5, 0xd4, 0x01, 0x7c, 0xdd,
+	};
+
+	//everything below mirrors hash128.cpp step by step, written as single expressions because v140 only has c++11 constexpr
+	//the accumulators are passed by value and rebuilt after every stripe
+	struct ConstHash128Lanes
+	{
+		uint64_t lane[HASH128_LANES];
+	};
+
+	constexpr uint64_t ConstPathByte(const char* string, size_t length, size_t index)
+	{//bytes past the end are the zero padding of the last stripe
+		return index >= length ? 0 : string[index] == '\\' ? (uint64_t)'/' : (uint64_t)(uint8_t)string[index];
+	}
+
+	constexpr uint64_t ConstRead64(const char* string, size_t length, size_t offset)
+	{
+		return ConstPathByte(string, length, offset)
+			| ConstPathByte(string, length, offset + 1) << 8
+			| ConstPathByte(string, length, offset + 2) << 16
+			| ConstPathByte(string, length, offset + 3) << 24
+			| ConstPathByte(string, length, offset + 4) << 32
+			| ConstPathByte(string, length, offset + 5) << 40
+			| ConstPathByte(string, length, offset + 6) << 48
+			| ConstPathByte(string, length, offset + 7) << 56;
+	}
+
+	constexpr uint64_t ConstSecret64(size_t offset)
+	{
+		return (uint64_t)HASH128_SECRET[offset]
+			| (uint64_t)HASH128_SECRET[offset + 1] << 8
+			| (uint64_t)HASH128_SECRET[offset + 2] << 16
+			| (uint64_t)HASH128_SECRET[offset + 3] << 24
+			| (uint64_t)HASH128_SECRET[offset + 4] << 32
+			| (uint64_t)HASH128_SECRET[offset + 5] << 40
+			| (uint64_t)HASH128_SECRET[offset + 6] << 48
+			| (uint64_t)HASH128_SECRET[offset + 7] << 56;
+	}
+
+	constexpr uint64_t ConstMultiply32x32(uint64_t value)
+	{
+		return (value & 0xFFFFFFFF) * (value >> 32);
+	}
+
+	constexpr uint64_t ConstAccumulateLane(const ConstHash128Lanes& acc, const char* string, size_t length, size_t stripeOffset, size_t secretOffset, uint32_t i)
+	{//the raw input of the neighbour lane is added as well
+		return acc.lane[i]
+			+ ConstRead64(string, length, stripeOffset + 8 * (i ^ 1))
+			+ ConstMultiply32x32(ConstRead64(string, length, stripeOffset + 8 * i) ^ ConstSecret64(secretOffset + 8 * i));
+	}
+
+	constexpr ConstHash128Lanes ConstAccumulateStripe(const ConstHash128Lanes& acc, const char* string, size_t length, size_t stripeOffset, size_t secretOffset)
+	{
+		return ConstHash128Lanes{ {
+			ConstAccumulateLane(acc, string, length, stripeOffset, secretOffset, 0),
+			ConstAccumulateLane(acc, string, length, stripeOffset, secretOffset, 1),
+			ConstAccumulateLane(acc, string, length, stripeOffset, secretOffset, 2),
+			ConstAccumulateLane(acc, string, length, stripeOffset, secretOffset, 3),
+			ConstAccumulateLane(acc, string, length, stripeOffset, secretOffset, 4),
+			ConstAccumulateLane(acc, string, length, stripeOffset, secretOffset, 5),
+			ConstAccumulateLane(acc, string, length, stripeOffset, secretOffset, 6),
+			ConstAccumulateLane(acc, string, length, stripeOffset, secretOffset, 7) } };
+	}
+
+	constexpr uint64_t ConstScrambleLane(uint64_t acc, uint32_t i)
+	{
+		return ((acc ^ (acc >> 47)) ^ ConstSecret64(HASH128_SCRAMBLE_SECRET + 8 * i)) * HASH128_PRIME32_1;
+	}
+
+	constexpr ConstHash128Lanes ConstScramble(const ConstHash128Lanes& acc)
+	{
+		return ConstHash128Lanes{ {
+			ConstScrambleLane(acc.lane[0], 0), ConstScrambleLane(acc.lane[1], 1),
+			ConstScrambleLane(acc.lane[2], 2), ConstScrambleLane(acc.lane[3], 3),
+			ConstScrambleLane(acc.lane[4], 4), ConstScrambleLane(acc.lane[5], 5),
+			ConstScrambleLane(acc.lane[6], 6), ConstScrambleLane(acc.lane[7], 7) } };
+	}
+
+	constexpr ConstHash128Lanes ConstAccumulate(const ConstHash128Lanes& acc, const char* string, size_t length, size_t stripe)
+	{//full stripes that end a block are scrambled, the zero padded last stripe never is
+		return stripe * HASH128_STRIPE_BYTES >= length ? acc :
+			ConstAccumulate(
+				(stripe + 1) * HASH128_STRIPE_BYTES <= length && stripe % HASH128_STRIPES_PER_BLOCK == HASH128_STRIPES_PER_BLOCK - 1 ?
+					ConstScramble(ConstAccumulateStripe(acc, string, length, stripe * HASH128_STRIPE_BYTES, (stripe % HASH128_STRIPES_PER_BLOCK) * 8)) :
+					ConstAccumulateStripe(acc, string, length, stripe * HASH128_STRIPE_BYTES, (stripe % HASH128_STRIPES_PER_BLOCK) * 8),
+				string, length, stripe + 1);
+	}
+
+	constexpr uint64_t ConstFoldCross(uint64_t loLo, uint64_t hiLo, uint64_t hiHi, uint64_t cross)
+	{
+		return ((cross << 32) | (loLo & 0xFFFFFFFF)) ^ ((hiLo >> 32) + (cross >> 32) + hiHi);
+	}
+
+	constexpr uint64_t ConstFoldProducts(uint64_t loLo, uint64_t hiLo, uint64_t loHi, uint64_t hiHi)
+	{
+		return ConstFoldCross(loLo, hiLo, hiHi, (loLo >> 32) + (hiLo & 0xFFFFFFFF) + loHi);
+	}
+
+	constexpr uint64_t ConstMultiply128Fold64(uint64_t a, uint64_t b)
+	{
+		return ConstFoldProducts(
+			(a & 0xFFFFFFFF) * (b & 0xFFFFFFFF),
+			(a >> 32) * (b & 0xFFFFFFFF),
+			(a & 0xFFFFFFFF) * (b >> 32),
+			(a >> 32) * (b >> 32));
+	}
+
+	constexpr uint64_t ConstAvalancheMultiplied(uint64_t hash)
+	{
+		return hash ^ (hash >> 32);
+	}
+
+	constexpr uint64_t ConstAvalanche(uint64_t hash)
+	{
+		return ConstAvalancheMultiplied((hash ^ (hash >> 37)) * 0x165667919E3779F9ULL);
+	}
+
+	constexpr uint64_t ConstMergePair(const ConstHash128Lanes& acc, size_t secretOffset, uint32_t i)
+	{
+		return ConstMultiply128Fold64(
+			acc.lane[2 * i] ^ ConstSecret64(secretOffset + 16 * i),
+			acc.lane[2 * i + 1] ^ ConstSecret64(secretOffset + 16 * i + 8));
+	}
+
+	constexpr uint64_t ConstMergeAccumulators(const ConstHash128Lanes& acc, size_t secretOffset, uint64_t start)
+	{
+		return ConstAvalanche(start
+			+ ConstMergePair(acc, secretOffset, 0)
+			+ ConstMergePair(acc, secretOffset, 1)
+			+ ConstMergePair(acc, secretOffset, 2)
+			+ ConstMergePair(acc, secretOffset, 3));
+	}
+
+	constexpr Hash128 ConstFinalize(const ConstHash128Lanes& acc, uint64_t length)
+	{
+		return Hash128{
+			ConstMergeAccumulators(acc, 11, length * HASH128_PRIME64_1),
+			ConstMergeAccumulators(acc, HASH128_SCRAMBLE_SECRET - 11, ~(length * HASH128_PRIME64_2)) };
+	}
+
+	//same result as HashBuffer128 over the path with '/' separators, without the terminating zero
+	//only takes arrays so a plain pointer can not slip in and hash sizeof(pointer) bytes
+	template<size_t N>
+	constexpr Hash128 ConstHashPath128(const char(&string)[N])
+	{
+		return ConstFinalize(
+			ConstAccumulate(
+				ConstHash128Lanes{ {
+					HASH128_PRIME32_3, HASH128_PRIME64_1, HASH128_PRIME64_2, HASH128_PRIME64_3,
+					HASH128_PRIME64_4, HASH128_PRIME32_2, HASH128_PRIME64_5, HASH128_PRIME32_1 } },
+				string, N - 1, 0),
+			N - 1);
+	}
+
+}//pug::utility
+}//pug
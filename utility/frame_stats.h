@@ -0,0 +1,77 @@
+#pragma once
+#include "latency_histogram.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+
+namespace pug {
+namespace utility {
+
+	enum EFramePhase : uint32_t
+	{
+		FramePhase_Frame = 0,//BeginFrameTiming to EndFrameTiming, everything the main loop does
+		FramePhase_MessagePump,
+		FramePhase_PopulateCommandList,//recording, submission and Present
+		FramePhase_FenceWait,//blocked until the gpu is done with the next back buffer
+		FramePhase_Count
+	};
+
+	struct FramePhaseReport
+	{
+		uint64_t p50;//microseconds
+		uint64_t p95;
+		uint64_t p99;
+		uint64_t max;
+		double mean;
+	};
+
+	//percentiles of the frames since the previous report, the histograms start over after every report
+	struct FrameStatsReport
+	{
+		uint64_t firstFrame;
+		uint32_t frameCount;
+		FramePhaseReport phases[FramePhase_Count];
+	};
+
+	//main thread only, frames and phases are measured with the steady clock
+	//csvFilePath is optional, every report is appended to it as one row
+	bool StartFrameStats(uint32_t reportIntervalFrames, const char* csvFilePath);
+	void StopFrameStats();
+	bool IsFrameStatsRunning();
+
+	void BeginFrameTiming();
+	//true when the frame completed a report interval, GetFrameStatsReport has the new numbers
+	bool EndFrameTiming();
+	//phases measured more than once in a frame are summed up
+	void AddFramePhaseTime(EFramePhase phase, uint64_t microseconds);
+
+	const FrameStatsReport& GetFrameStatsReport();
+	const char* GetFramePhaseName(EFramePhase phase);
+	//one line per phase
+	void FormatFrameStatsReport(const FrameStatsReport& report, char* out_text, size_t textSize);
+
+	class FramePhaseScope
+	{
+	public:
+		explicit FramePhaseScope(EFramePhase phase)
+			: m_phase(phase)
+			, m_start(std::chrono::steady_clock::now())
+		{
+
+		}
+		~FramePhaseScope()
+		{
+			AddFramePhaseTime(m_phase, (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count());
+		}
+
+	private:
+		FramePhaseScope(const FramePhaseScope&) = delete;
+		FramePhaseScope& operator=(const FramePhaseScope&) = delete;
+
+		EFramePhase m_phase;
+		std::chrono::steady_clock::time_point m_start;
+	};
+
+}//pug::utility
+}//pug
@@ -2,14 +2,73 @@
 
 #include <iostream>
 #include <string>
+#include <cstdint>
+#include <cstddef>
 
 #define SHA1_HASH_BYTES 20
+#define SHA1_BLOCK_BYTES 64
+#define HASH128_BYTES 16
+#define HASH128_STRIPE_BYTES 64
 
 namespace pug {
 namespace utility{
 
+	//streaming sha1 over raw bytes, never allocates
+	//uses the x86 sha extensions when the cpu has them (PUG_SHA1_NO_HARDWARE forces the scalar path)
+	struct SHA1State
+	{
+		uint32_t digest[5];
+		uint8_t buffer[SHA1_BLOCK_BYTES];
+		uint32_t bufferedBytes;
+		uint64_t totalBytes;
+	};
+
+	void SHA1Init(SHA1State& state);
+	void SHA1Update(SHA1State& state, const void* data, size_t size);
+	//standard big endian digest like sha1sum prints it, does not modify the state
+	void SHA1Final(const SHA1State& state, char* out_result, const size_t& resultSize);
+
+	//true when the blocks go through the sha extensions, turning them off lets tests check the scalar path on the same cpu
+	//both paths give the same digest, so switching while other threads hash is harmless
+	bool IsSHA1HardwareEnabled();
+	void SetSHA1HardwareEnabled(bool enabled);//no effect without cpu support
+
+	//sha1 of a whole file in standard byte order, mapped if possible and streamed through a fixed buffer otherwise
+	bool HashFile(const char* filePath, char* out_result, const size_t& resultSize);
+
+	//legacy asset guid hash, not sha1 for strings of 64 bytes or more: only their first 64 bytes reach the digest
+	//and the digest words are written in host byte order, so it differs from SHA1Final
+	//kept bit exact because version 1 and 2 libraries store these guids, use Hash128 or the streaming api for anything new
 	void SHA1(const std::string &string, char* out_result, const size_t& resultSize);
 
+	//fast non cryptographic 128 bit hash for asset ids and content keys, not for anything security related
+	//same structure as XXH3 (64 byte stripes accumulated into 8 lanes, scrambled every 1024 bytes),
+	//but not bit compatible with it, uses SSE2 where available and gives the same result without it
+	struct Hash128
+	{
+		uint64_t low;
+		uint64_t high;
+	};
+
+	//streaming state, lives wherever the caller puts it, hashing never allocates
+	struct Hash128State
+	{
+		uint64_t accumulators[8];
+		uint8_t buffer[HASH128_STRIPE_BYTES];
+		uint32_t bufferedBytes;
+		uint32_t stripeIndex;//stripes accumulated since the last scramble
+		uint64_t totalBytes;
+	};
+
+	void Hash128Init(Hash128State& state);
+	void Hash128Update(Hash128State& state, const void* data, size_t size);
+	Hash128 Hash128Final(const Hash128State& state);//does not modify the state, more data can be appended afterwards
+
+	Hash128 HashBuffer128(const void* data, size_t size);
+	inline uint64_t HashBuffer64(const void* data, size_t size) { return HashBuffer128(data, size).low; }
+	//little endian bytes of the hash, zero padded if resultSize is larger than HASH128_BYTES
+	void WriteHash128(const Hash128& hash, char* out_result, const size_t& resultSize);
+
 }
 }
 
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+
+#define HASH_INDEX_KEY_BYTES 20
+#define HASH_INDEX_INVALID_VALUE 0xFFFFFFFF
+
+namespace pug {
+namespace utility {
+
+	//open addressing hash index, maps a 20 byte asset guid to a 32 bit value
+	//linear probing over a power of two table that is kept at most half full,
+	//the guids are already uniformly distributed so the first 4 bytes are used as the hash
+	class HashIndex
+	{
+	public:
+		HashIndex();
+		~HashIndex();
+
+		void Initialize(uint32_t expectedItemCount);
+		void Destroy();
+		void Clear();
+
+		bool Insert(const char* key, uint32_t value);//fails if the key is already in the index
+		bool Find(const char* key, uint32_t& out_value) const;
+		bool Update(const char* key, uint32_t value);
+		bool Remove(const char* key);
+
+		uint32_t GetCount() const { return m_count; }
+		uint32_t GetCapacity() const { return m_capacity; }
+
+	private:
+		struct Slot
+		{
+			char key[HASH_INDEX_KEY_BYTES];
+			uint32_t hash;
+			uint32_t value;
+			uint32_t state;
+		};//32 bytes, two slots per cache line
+
+		uint32_t FindSlot(const char* key, uint32_t hash) const;
+		void Rehash(uint32_t newCapacity);
+
+		Slot* m_slots;
+		uint32_t m_capacity;
+		uint32_t m_count;
+		uint32_t m_tombstones;
+	};
+
+}//pug::utility
+}//pug
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+namespace pug {
+namespace utility {
+
+	typedef std::function<void(uint32_t jobIndex, uint32_t workerIndex)> JobFunction;
+
+	//fixed set of worker threads that run batches of indexed jobs
+	//every worker owns a deque of job indices, it pops from the front of its own deque
+	//and steals from the back of the other deques once its own runs dry
+	class JobPool
+	{
+	public:
+		JobPool();
+		~JobPool();
+
+		void Initialize(uint32_t workerCount);
+		void Destroy();
+
+		//blocks until all jobs of the batch have finished
+		//workerIndex is in the range [0, GetWorkerCount()) and can be used to index per worker state
+		void Run(uint32_t jobCount, const JobFunction& job);
+
+		uint32_t GetWorkerCount() const { return (uint32_t)m_threads.size(); }
+
+	private:
+		struct WorkerQueue
+		{
+			std::mutex lock;
+			std::deque<uint32_t> jobs;
+		};
+
+		void WorkerMain(uint32_t workerIndex);
+		bool PopJob(uint32_t workerIndex, uint32_t& out_jobIndex);
+
+		std::vector<std::thread> m_threads;
+		std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+
+		std::mutex m_runLock;//one batch at a time
+		std::mutex m_stateLock;
+		std::condition_variable m_wakeCondition;
+		std::condition_variable m_doneCondition;
+		const JobFunction* m_job;
+		uint64_t m_generation;
+		std::atomic<uint32_t> m_pendingJobs;
+		uint32_t m_activeWorkers;
+		bool m_shutdown;
+	};
+
+}//pug::utility
+}//pug
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+
+//every power of two is split into 32 linear buckets, percentiles are off by at most 1/32 (~3%)
+#define LATENCY_HISTOGRAM_SUB_BUCKET_BITS 6
+#define LATENCY_HISTOGRAM_SUB_BUCKET_COUNT (1u << LATENCY_HISTOGRAM_SUB_BUCKET_BITS)
+#define LATENCY_HISTOGRAM_HALF_BUCKET_COUNT (LATENCY_HISTOGRAM_SUB_BUCKET_COUNT / 2)
+#define LATENCY_HISTOGRAM_BUCKET_COUNT ((64 - LATENCY_HISTOGRAM_SUB_BUCKET_BITS + 1) * LATENCY_HISTOGRAM_HALF_BUCKET_COUNT + LATENCY_HISTOGRAM_HALF_BUCKET_COUNT)
+
+namespace pug {
+namespace utility {
+
+	//log-linear histogram in the style of HdrHistogram, fixed size and no allocations
+	//values below 64 are exact, larger ones share a bucket with values within ~3% of them
+	//the unit is up to the caller, the frame statistics record microseconds
+	class LatencyHistogram
+	{
+	public:
+		LatencyHistogram();
+
+		void Record(uint64_t value);
+		void Reset();
+		void Merge(const LatencyHistogram& other);
+
+		//highest value of the bucket the percentile falls into, never above the recorded max, 0 when empty
+		uint64_t GetPercentile(double percentile) const;
+		uint64_t GetMin() const { return m_count > 0 ? m_min : 0; }
+		uint64_t GetMax() const { return m_max; }
+		double GetMean() const { return m_count > 0 ? (double)m_sum / (double)m_count : 0.0; }
+		uint64_t GetCount() const { return m_count; }
+
+	private:
+		static uint32_t GetBucketIndex(uint64_t value);
+		static uint64_t GetBucketUpperBound(uint32_t bucketIndex);
+
+		uint32_t m_buckets[LATENCY_HISTOGRAM_BUCKET_COUNT];
+		uint64_t m_count;
+		uint64_t m_sum;
+		uint64_t m_min;
+		uint64_t m_max;
+	};
+
+}//pug::utility
+}//pug
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+
+namespace pug {
+namespace utility {
+
+	//read only view of a whole file, backed by CreateFileMapping on windows and mmap everywhere else
+	struct MappedFile
+	{
+		const uint8_t* data;
+		uint64_t size;
+
+		//platform handles, do not touch
+		void* fileHandle;
+		void* mappingHandle;
+	};
+
+	bool MapFile(const char* path, MappedFile& out_file);
+	void UnmapFile(MappedFile& file);
+
+}//pug::utility
+}//pug
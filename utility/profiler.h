@@ -0,0 +1,92 @@
+#pragma once
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+
+//PUG_PROFILE_SCOPE records the time spent in the enclosing scope while a capture runs
+//define PUG_PROFILE_ENABLED as 0 to compile all zones out
+#ifndef PUG_PROFILE_ENABLED
+#define PUG_PROFILE_ENABLED 1
+#endif
+
+//the time stamp counter is a few nanoseconds cheaper than the steady clock, it is calibrated against it for the export
+#if !defined(PUG_PROFILE_NO_RDTSC) && (defined(_M_X64) || defined(__x86_64__))
+#define PUG_PROFILE_RDTSC 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+#define PROFILER_THREAD_EVENT_CAPACITY (64 * 1024)//events per thread and capture, the ones after that are dropped and counted
+#define PROFILER_THREAD_NAME_LENGTH 64
+
+namespace pug {
+namespace utility {
+
+	extern std::atomic<bool> g_profilerCapturing;
+	inline bool IsProfilerCapturing()
+	{
+		return g_profilerCapturing.load(std::memory_order_relaxed);
+	}
+
+	inline uint64_t GetProfilerTicks()
+	{
+#ifdef PUG_PROFILE_RDTSC
+		return __rdtsc();
+#else
+		return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+	}
+
+	//zones are recorded into a buffer owned by the calling thread, no locks or atomics shared between threads
+	//a new capture drops the events of the previous one
+	void BeginProfileCapture();
+	void EndProfileCapture();
+	//name is copied, shows up as the thread name in the trace
+	void SetProfilerThreadName(const char* name);
+	//Chrome trace_event JSON of the last capture, open it in chrome://tracing or ui.perfetto.dev
+	bool WriteChromeTrace(const char* filePath);
+	uint64_t GetProfilerDroppedEventCount();
+
+	//name has to outlive the capture, only the pointer is stored
+	void RecordProfileEvent(const char* name, uint64_t startTicks, uint64_t endTicks);
+
+	class ProfileScope
+	{
+	public:
+		explicit ProfileScope(const char* name)
+			: m_name(IsProfilerCapturing() ? name : nullptr)
+			, m_start(m_name != nullptr ? GetProfilerTicks() : 0)
+		{
+
+		}
+		~ProfileScope()
+		{
+			if (m_name != nullptr)
+			{
+				RecordProfileEvent(m_name, m_start, GetProfilerTicks());
+			}
+		}
+
+	private:
+		ProfileScope(const ProfileScope&) = delete;
+		ProfileScope& operator=(const ProfileScope&) = delete;
+
+		const char* m_name;
+		uint64_t m_start;
+	};
+
+}//pug::utility
+}//pug
+
+#if PUG_PROFILE_ENABLED
+#define PUG_PROFILE_CONCAT_INNER(a, b) a##b
+#define PUG_PROFILE_CONCAT(a, b) PUG_PROFILE_CONCAT_INNER(a, b)
+#define PUG_PROFILE_SCOPE(name) pug::utility::ProfileScope PUG_PROFILE_CONCAT(pug_profile_scope_, __LINE__)(name)
+#define PUG_PROFILE_FUNCTION() PUG_PROFILE_SCOPE(__FUNCTION__)
+#else
+#define PUG_PROFILE_SCOPE(name)
+#define PUG_PROFILE_FUNCTION()
+#endif
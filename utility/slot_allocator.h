@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+
+#define SLOT_HANDLE_INDEX_BITS 16
+#define SLOT_HANDLE_INDEX_MASK ((1u << SLOT_HANDLE_INDEX_BITS) - 1)
+#define SLOT_HANDLE_MAX_CAPACITY (1u << SLOT_HANDLE_INDEX_BITS)
+#define SLOT_INVALID_HANDLE 0
+#define SLOT_INDEX(handle) ((handle) & SLOT_HANDLE_INDEX_MASK)
+
+namespace pug {
+namespace utility {
+
+	//hands out slots of a fixed size table in O(1) through an intrusive free list
+	//handles are (generation << 16) | index, the generation of a slot is bumped every time it is freed
+	//so handles to freed slots are detected, generations skip 0 so a valid handle is never 0
+	class SlotAllocator
+	{
+	public:
+		SlotAllocator();
+		~SlotAllocator();
+
+		void Initialize(uint32_t capacity);
+		void Destroy();
+		void Clear();//frees every slot, outstanding handles become stale
+
+		uint32_t Allocate();//SLOT_INVALID_HANDLE when the table is full
+		bool Free(uint32_t handle);//fails for stale or invalid handles
+		bool IsValid(uint32_t handle) const;
+
+		uint32_t GetCount() const { return m_count; }
+		uint32_t GetCapacity() const { return m_capacity; }
+
+	private:
+		uint16_t* m_generations;
+		uint32_t* m_nextFree;//next free slot for free slots, SLOT_IN_USE for allocated slots
+		uint32_t m_freeHead;
+		uint32_t m_capacity;
+		uint32_t m_count;
+	};
+
+}//pug::utility
+}//pug
@@ -0,0 +1,192 @@
+#include "allocator.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+#define MEMORY_CACHE_LINE_SIZE 64
+
+using namespace pug::utility;
+
+//in front of every tagged allocation, offset leads back to the start of the block the allocator returned
+//the allocator is kept so the block goes back where it came from even if SetAllocator was called since
+struct AllocationHeader
+{
+	Allocator* allocator;
+	uint64_t size;
+	uint32_t tag;
+	uint32_t offset;
+};
+
+struct alignas(MEMORY_CACHE_LINE_SIZE) MemoryTagCounters
+{
+	std::atomic<int64_t> liveBytes;
+	std::atomic<int64_t> peakBytes;
+	std::atomic<int64_t> liveAllocations;
+	std::atomic<int64_t> totalAllocations;
+};
+
+class SystemAllocator : public Allocator
+{
+public:
+	void* Allocate(size_t size, size_t alignment) override
+	{
+#ifdef _MSC_VER
+		return _aligned_malloc(size, alignment);
+#else
+		void* memory = nullptr;
+		return posix_memalign(&memory, alignment < sizeof(void*) ? sizeof(void*) : alignment, size) == 0 ? memory : nullptr;
+#endif
+	}
+
+	void Free(void* memory) override
+	{
+#ifdef _MSC_VER
+		_aligned_free(memory);
+#else
+		free(memory);
+#endif
+	}
+};
+
+static SystemAllocator g_systemAllocator;
+static std::atomic<Allocator*> g_allocator(&g_systemAllocator);
+static MemoryTagCounters g_counters[MemoryTag_Count];//zero initialized as a static
+
+static void AddToCounters(EMemoryTag tag, int64_t bytes, int64_t allocations)
+{
+	MemoryTagCounters& counters = g_counters[tag < MemoryTag_Count ? tag : MemoryTag_Untagged];
+	const int64_t liveBytes = counters.liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+	counters.liveAllocations.fetch_add(allocations, std::memory_order_relaxed);
+	if (allocations > 0)
+	{
+		counters.totalAllocations.fetch_add(allocations, std::memory_order_relaxed);
+	}
+	int64_t peakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+	while (liveBytes > peakBytes && !counters.peakBytes.compare_exchange_weak(peakBytes, liveBytes, std::memory_order_relaxed))
+	{//another thread raised the peak meanwhile, peakBytes was reloaded
+	}
+}
+
+Allocator* pug::utility::GetSystemAllocator()
+{
+	return &g_systemAllocator;
+}
+
+void pug::utility::SetAllocator(Allocator* allocator)
+{
+	g_allocator.store(allocator != nullptr ? allocator : &g_systemAllocator, std::memory_order_release);
+}
+
+Allocator* pug::utility::GetAllocator()
+{
+	return g_allocator.load(std::memory_order_acquire);
+}
+
+void* pug::utility::Allocate(size_t size, size_t alignment, EMemoryTag tag)
+{
+	if (alignment < alignof(AllocationHeader))
+	{
+		alignment = alignof(AllocationHeader);
+	}
+	//the header sits right in front of the returned memory, which keeps its alignment
+	const size_t headerSpace = (sizeof(AllocationHeader) + alignment - 1) & ~(alignment - 1);
+	Allocator* allocator = g_allocator.load(std::memory_order_acquire);
+	uint8_t* block = (uint8_t*)allocator->Allocate(size + headerSpace, alignment);
+	if (block == nullptr)
+	{
+		return nullptr;
+	}
+	uint8_t* memory = block + headerSpace;
+	AllocationHeader* header = (AllocationHeader*)memory - 1;
+	header->allocator = allocator;
+	header->size = size;
+	header->tag = tag;
+	header->offset = (uint32_t)headerSpace;
+	AddToCounters(tag, (int64_t)size, 1);
+	return memory;
+}
+
+void pug::utility::Free(void* memory)
+{
+	if (memory == nullptr)
+	{
+		return;
+	}
+	const AllocationHeader* header = (const AllocationHeader*)memory - 1;
+	AddToCounters((EMemoryTag)header->tag, -(int64_t)header->size, -1);
+	header->allocator->Free((uint8_t*)memory - header->offset);
+}
+
+void pug::utility::TrackMemory(EMemoryTag tag, int64_t bytes)
+{
+	AddToCounters(tag, bytes, 0);
+}
+
+const char* pug::utility::GetMemoryTagName(EMemoryTag tag)
+{
+	static const char* tagNames[] = { "Untagged", "Resource", "Graphics", "Log", "Cooker" };
+	static_assert(sizeof(tagNames) / sizeof(tagNames[0]) == MemoryTag_Count, "Every memory tag needs a name");
+	return tag < MemoryTag_Count ? tagNames[tag] : "Unknown";
+}
+
+void pug::utility::GetMemoryStats(MemoryStats& out_stats)
+{
+	for (uint32_t i = 0; i < MemoryTag_Count; ++i)
+	{
+		const MemoryTagCounters& counters = g_counters[i];
+		MemoryTagStats& stats = out_stats.tags[i];
+		stats.liveBytes = counters.liveBytes.load(std::memory_order_relaxed);
+		stats.peakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+		stats.liveAllocations = counters.liveAllocations.load(std::memory_order_relaxed);
+		stats.totalAllocations = counters.totalAllocations.load(std::memory_order_relaxed);
+	}
+}
+
+void pug::utility::DiffMemoryStats(const MemoryStats& before, const MemoryStats& after, MemoryStats& out_diff)
+{
+	for (uint32_t i = 0; i < MemoryTag_Count; ++i)
+	{
+		out_diff.tags[i].liveBytes = after.tags[i].liveBytes - before.tags[i].liveBytes;
+		out_diff.tags[i].peakBytes = after.tags[i].peakBytes - before.tags[i].peakBytes;
+		out_diff.tags[i].liveAllocations = after.tags[i].liveAllocations - before.tags[i].liveAllocations;
+		out_diff.tags[i].totalAllocations = after.tags[i].totalAllocations - before.tags[i].totalAllocations;
+	}
+}
+
+void pug::utility::FormatMemoryStats(const MemoryStats& stats, char* out_text, size_t textSize)
+{
+	if (textSize == 0)
+	{
+		return;
+	}
+	out_text[0] = 0;
+	size_t length = 0;
+	MemoryTagStats total = {};
+	for (uint32_t i = 0; i <= MemoryTag_Count && length < textSize; ++i)
+	{
+		const MemoryTagStats& tagStats = i < MemoryTag_Count ? stats.tags[i] : total;
+		const char* name = i < MemoryTag_Count ? GetMemoryTagName((EMemoryTag)i) : "Total";
+		const int written = snprintf(out_text + length, textSize - length, "%-9s live %12.1f KB peak %12.1f KB allocations %8lld live %10lld total\n",
+			name, tagStats.liveBytes / 1024.0, tagStats.peakBytes / 1024.0,
+			(long long)tagStats.liveAllocations, (long long)tagStats.totalAllocations);
+		if (written < 0)
+		{
+			break;
+		}
+		length += (size_t)written;
+		if (i == MemoryTag_Count)
+		{
+			break;
+		}
+		//the peaks of different tags do not have to line up, their sum is an upper bound
+		total.liveBytes += tagStats.liveBytes;
+		total.peakBytes += tagStats.peakBytes;
+		total.liveAllocations += tagStats.liveAllocations;
+		total.totalAllocations += tagStats.totalAllocations;
+	}
+}
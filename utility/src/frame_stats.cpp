@@ -0,0 +1,175 @@
+#include "frame_stats.h"
+
+#include <cstdio>
+
+using namespace pug::utility;
+
+static bool g_frameStatsRunning = false;
+static uint32_t g_reportIntervalFrames;
+static FILE* g_csvFile;
+static uint64_t g_frameIndex;
+static uint64_t g_windowFirstFrame;
+static std::chrono::steady_clock::time_point g_frameStart;
+static uint64_t g_framePhaseTimes[FramePhase_Count];//this frame, recorded into the histograms when it ends
+static LatencyHistogram g_phaseHistograms[FramePhase_Count];
+static FrameStatsReport g_report;
+
+static FILE* OpenFile(const char* filePath, const char* mode)
+{
+	FILE* file = nullptr;
+#ifdef _MSC_VER
+	fopen_s(&file, filePath, mode);
+#else
+	file = fopen(filePath, mode);
+#endif
+	return file;
+}
+
+static void WriteCsvRow(const FrameStatsReport& report)
+{
+	fprintf(g_csvFile, "%llu,%u", (unsigned long long)report.firstFrame, report.frameCount);
+	for (uint32_t i = 0; i < FramePhase_Count; ++i)
+	{
+		const FramePhaseReport& phase = report.phases[i];
+		fprintf(g_csvFile, ",%llu,%llu,%llu,%llu,%.1f", (unsigned long long)phase.p50, (unsigned long long)phase.p95, (unsigned long long)phase.p99, (unsigned long long)phase.max, phase.mean);
+	}
+	fprintf(g_csvFile, "\n");
+	fflush(g_csvFile);//the main loop is usually left by closing the process
+}
+
+bool pug::utility::StartFrameStats(uint32_t reportIntervalFrames, const char* csvFilePath)
+{
+	StopFrameStats();
+	if (csvFilePath != nullptr)
+	{
+		g_csvFile = OpenFile(csvFilePath, "w");
+		if (g_csvFile == nullptr)
+		{
+			return false;
+		}
+		fprintf(g_csvFile, "first_frame,frame_count");
+		for (uint32_t i = 0; i < FramePhase_Count; ++i)
+		{
+			const char* name = GetFramePhaseName((EFramePhase)i);
+			fprintf(g_csvFile, ",%s_p50_us,%s_p95_us,%s_p99_us,%s_max_us,%s_mean_us", name, name, name, name, name);
+		}
+		fprintf(g_csvFile, "\n");
+	}
+	g_reportIntervalFrames = reportIntervalFrames > 0 ? reportIntervalFrames : 1;
+	g_frameIndex = 0;
+	g_windowFirstFrame = 0;
+	for (uint32_t i = 0; i < FramePhase_Count; ++i)
+	{
+		g_phaseHistograms[i].Reset();
+		g_framePhaseTimes[i] = 0;
+	}
+	g_report = {};
+	g_frameStatsRunning = true;
+	return true;
+}
+
+void pug::utility::StopFrameStats()
+{
+	if (g_csvFile != nullptr)
+	{
+		fclose(g_csvFile);
+		g_csvFile = nullptr;
+	}
+	g_frameStatsRunning = false;
+}
+
+bool pug::utility::IsFrameStatsRunning()
+{
+	return g_frameStatsRunning;
+}
+
+void pug::utility::BeginFrameTiming()
+{
+	g_frameStart = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < FramePhase_Count; ++i)
+	{
+		g_framePhaseTimes[i] = 0;
+	}
+}
+
+bool pug::utility::EndFrameTiming()
+{
+	if (!g_frameStatsRunning)
+	{
+		return false;
+	}
+	g_framePhaseTimes[FramePhase_Frame] = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - g_frameStart).count();
+	for (uint32_t i = 0; i < FramePhase_Count; ++i)
+	{
+		g_phaseHistograms[i].Record(g_framePhaseTimes[i]);
+	}
+	++g_frameIndex;
+	if (g_frameIndex - g_windowFirstFrame < g_reportIntervalFrames)
+	{
+		return false;
+	}
+
+	g_report.firstFrame = g_windowFirstFrame;
+	g_report.frameCount = (uint32_t)(g_frameIndex - g_windowFirstFrame);
+	for (uint32_t i = 0; i < FramePhase_Count; ++i)
+	{
+		LatencyHistogram& histogram = g_phaseHistograms[i];
+		FramePhaseReport& phase = g_report.phases[i];
+		phase.p50 = histogram.GetPercentile(50.0);
+		phase.p95 = histogram.GetPercentile(95.0);
+		phase.p99 = histogram.GetPercentile(99.0);
+		phase.max = histogram.GetMax();
+		phase.mean = histogram.GetMean();
+		histogram.Reset();
+	}
+	g_windowFirstFrame = g_frameIndex;
+	if (g_csvFile != nullptr)
+	{
+		WriteCsvRow(g_report);
+	}
+	return true;
+}
+
+void pug::utility::AddFramePhaseTime(EFramePhase phase, uint64_t microseconds)
+{
+	if (phase < FramePhase_Count)
+	{
+		g_framePhaseTimes[phase] += microseconds;
+	}
+}
+
+const FrameStatsReport& pug::utility::GetFrameStatsReport()
+{
+	return g_report;
+}
+
+const char* pug::utility::GetFramePhaseName(EFramePhase phase)
+{
+	static const char* phaseNames[] = { "frame", "message_pump", "populate_command_list", "fence_wait" };
+	static_assert(sizeof(phaseNames) / sizeof(phaseNames[0]) == FramePhase_Count, "Every frame phase needs a name");
+	return phase < FramePhase_Count ? phaseNames[phase] : "unknown";
+}
+
+void pug::utility::FormatFrameStatsReport(const FrameStatsReport& report, char* out_text, size_t textSize)
+{
+	if (textSize == 0)
+	{
+		return;
+	}
+	out_text[0] = 0;
+	int written = snprintf(out_text, textSize, "Frames %llu - %llu, microseconds:\n",
+		(unsigned long long)report.firstFrame, (unsigned long long)(report.firstFrame + report.frameCount - 1));
+	size_t length = written > 0 ? (size_t)written : 0;
+	for (uint32_t i = 0; i < FramePhase_Count && length < textSize; ++i)
+	{
+		const FramePhaseReport& phase = report.phases[i];
+		written = snprintf(out_text + length, textSize - length, "%-22s p50 %7llu p95 %7llu p99 %7llu max %7llu mean %9.1f\n",
+			GetFramePhaseName((EFramePhase)i), (unsigned long long)phase.p50, (unsigned long long)phase.p95,
+			(unsigned long long)phase.p99, (unsigned long long)phase.max, phase.mean);
+		if (written < 0)
+		{
+			break;
+		}
+		length += (size_t)written;
+	}
+}
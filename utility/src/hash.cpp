@@ -16,10 +16,26 @@ Translation to simpler C++ Code
 */
 
 #include "hash.h"
-#include <sstream>
-#include <iomanip>
-#include <fstream>
+#include "mapped_file.h"
+#include <cstring>
+#include <cstdio>
 #include <cassert>
+#include <atomic>
+
+#if !defined(PUG_SHA1_NO_HARDWARE) && (defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__))
+#define SHA1_HARDWARE 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define SHA1_HARDWARE_TARGET
+#else
+#include <cpuid.h>
+#define SHA1_HARDWARE_TARGET __attribute__((target("sha,ssse3,sse4.1")))
+#endif
+#endif
+
+#define HASH_FILE_CHUNK_SIZE (64ull * 1024 * 1024)
+#define HASH_FILE_BUFFER_SIZE (64 * 1024)
 
 /* Help macros */
 #define SHA1_ROL(value, bits) (((value) << (bits)) | (((value) & 0xffffffff) >> (32 - (bits))))
@@ -131,92 +147,281 @@ static void Transform(uint32_t* block, uint32_t* digest)
 	digest[3] += d;
 	digest[4] += e;
 }
-static void BufferToBlock(const std::string &buffer, uint32_t* block, uint32_t blockInts)
+static void BufferToBlock(const uint8_t* buffer, uint32_t* block, uint32_t blockInts)
 {
-	/* Convert the std::string (byte buffer) to a uint32 array (MSB) */
+	/* Convert the byte buffer to a uint32 array (MSB) */
 	for (unsigned int i = 0; i < blockInts; i++)
 	{
 		block[i] = 
-			  (buffer[4 * i + 3] & 0xff)
-			| (buffer[4 * i + 2] & 0xff) << 8
-			| (buffer[4 * i + 1] & 0xff) << 16
-			| (buffer[4 * i + 0] & 0xff) << 24;
+			  (uint32_t)buffer[4 * i + 3]
+			| (uint32_t)buffer[4 * i + 2] << 8
+			| (uint32_t)buffer[4 * i + 1] << 16
+			| (uint32_t)buffer[4 * i + 0] << 24;
 	}
 }
-static void Read(std::istream &is, std::string &s, int max)
+
+static void TransformBlocks(uint32_t* digest, const uint8_t* data, size_t blockCount)
 {
-	char* sbuf = (char*)_malloca(sizeof(char) * max);//c
-	is.read(sbuf, max);
-	s.assign(sbuf, is.gcount());
+	for (size_t i = 0; i < blockCount; ++i, data += SHA1_BLOCK_BYTES)
+	{
+		uint32_t block[SHA1_BLOCK_BYTES / 4];
+		BufferToBlock(data, block, SHA1_BLOCK_BYTES / 4);
+		Transform(block, digest);
+	}
 }
 
-void pug::utility::SHA1(const std::string &string, char* out_result, const size_t& resultSize)
+#ifdef SHA1_HARDWARE
+/* One group of 4 rounds with the x86 sha extensions, g is the group index 0-19.
+   The message schedule rotates through msg[0-3], e[] alternates between the two E registers */
+#define SHA1_NI_GROUP(g) \
+	{ \
+		if ((g) < 4) \
+		{ \
+			msg[(g) & 3] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16 * ((g) & 3))), byteSwap); \
+		} \
+		const __m128i m = msg[(g) & 3]; \
+		e[(g) & 1] = (g) == 0 ? _mm_add_epi32(e[0], m) : _mm_sha1nexte_epu32(e[(g) & 1], m); \
+		e[((g) + 1) & 1] = abcd; \
+		if ((g) >= 3 && (g) <= 18) msg[((g) + 1) & 3] = _mm_sha1msg2_epu32(msg[((g) + 1) & 3], m); \
+		abcd = _mm_sha1rnds4_epu32(abcd, e[(g) & 1], (g) / 5); \
+		if ((g) >= 1 && (g) <= 16) msg[((g) + 3) & 3] = _mm_sha1msg1_epu32(msg[((g) + 3) & 3], m); \
+		if ((g) >= 2 && (g) <= 17) msg[((g) + 2) & 3] = _mm_xor_si128(msg[((g) + 2) & 3], m); \
+	}
+
+SHA1_HARDWARE_TARGET static void TransformBlocksHardware(uint32_t* digest, const uint8_t* data, size_t blockCount)
 {
-	constexpr uint32_t digestInts = 5;  /* number of 32bit integers per SHA1 digest */
-	constexpr uint32_t blockInts = 16;  /* number of 32bit integers per SHA1 block */
-	constexpr uint32_t blockBytes = blockInts * 4;
+	const __m128i byteSwap = _mm_set_epi64x(0x0001020304050607LL, 0x08090a0b0c0d0e0fLL);
+	__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)digest), 0x1B);
+	__m128i e[2] = { _mm_set_epi32((int)digest[4], 0, 0, 0), _mm_setzero_si128() };
+	__m128i msg[4];
 
-	assert(resultSize == 20);
+	for (size_t i = 0; i < blockCount; ++i, data += SHA1_BLOCK_BYTES)
+	{
+		const __m128i abcdSave = abcd;
+		const __m128i eSave = e[0];
 
-	uint32_t digest[digestInts] =
+		SHA1_NI_GROUP(0); SHA1_NI_GROUP(1); SHA1_NI_GROUP(2); SHA1_NI_GROUP(3);
+		SHA1_NI_GROUP(4); SHA1_NI_GROUP(5); SHA1_NI_GROUP(6); SHA1_NI_GROUP(7);
+		SHA1_NI_GROUP(8); SHA1_NI_GROUP(9); SHA1_NI_GROUP(10); SHA1_NI_GROUP(11);
+		SHA1_NI_GROUP(12); SHA1_NI_GROUP(13); SHA1_NI_GROUP(14); SHA1_NI_GROUP(15);
+		SHA1_NI_GROUP(16); SHA1_NI_GROUP(17); SHA1_NI_GROUP(18); SHA1_NI_GROUP(19);
+
+		/* Add the working vars back, the last group left E in e[0] */
+		e[0] = _mm_sha1nexte_epu32(e[0], eSave);
+		abcd = _mm_add_epi32(abcd, abcdSave);
+	}
+
+	_mm_storeu_si128((__m128i*)digest, _mm_shuffle_epi32(abcd, 0x1B));
+	digest[4] = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(e[0], 12));
+}
+
+static bool HasHardwareSupport()
+{
+	int registers[4] = {};
+#ifdef _MSC_VER
+	__cpuid(registers, 0);
+	if (registers[0] < 7)
 	{
-		0x67452301,
-		0xefcdab89,
-		0x98badcfe,
-		0x10325476,
-		0xc3d2e1f0,
-	};
-	std::string buffer = "";
-	uint64_t transforms = 0;
-
-	std::istringstream is = std::istringstream(string);
-
-	//checksum.update(string);
-	std::string rest_of_buffer;
-	size_t bufferSize = buffer.size();
-	Read(is, rest_of_buffer, (int)(blockBytes - bufferSize));
-	buffer += rest_of_buffer;
-
-	//removing this while loop is a hack
-	while (is && (blockBytes - bufferSize) != 0)
+		return false;
+	}
+	__cpuidex(registers, 7, 0);
+	const bool sha = (registers[1] & (1 << 29)) != 0;
+	__cpuid(registers, 1);
+#else
+	unsigned int a, b, c, d;
+	if (!__get_cpuid_count(7, 0, &a, &b, &c, &d))
 	{
-		uint32_t block[blockInts];
-		BufferToBlock(buffer, block, blockInts);
-		Transform(block, digest);
+		return false;
+	}
+	const bool sha = (b & (1u << 29)) != 0;
+	__get_cpuid(1, &a, &b, &c, &d);
+	registers[2] = (int)c;
+#endif
+	const bool ssse3 = (registers[2] & (1 << 9)) != 0;
+	const bool sse41 = (registers[2] & (1 << 19)) != 0;
+	return sha && ssse3 && sse41;
+}
+#endif
+
+typedef void(*TransformBlocksFunction)(uint32_t* digest, const uint8_t* data, size_t blockCount);
+
+static std::atomic<bool> g_hardwareEnabled(true);
+
+static TransformBlocksFunction GetTransformBlocks()
+{
+#ifdef SHA1_HARDWARE
+	static const bool hasHardwareSupport = HasHardwareSupport();//checked once, the cpu does not change while we run
+	return hasHardwareSupport && g_hardwareEnabled.load(std::memory_order_relaxed) ? TransformBlocksHardware : TransformBlocks;
+#else
+	return TransformBlocks;
+#endif
+}
 
-		bufferSize = buffer.size();
-		Read(is, rest_of_buffer, (int)(blockBytes - bufferSize));
-		/* Count the number of transformations */
-		transforms++;
+bool pug::utility::IsSHA1HardwareEnabled()
+{
+	return GetTransformBlocks() != TransformBlocks;
+}
+
+void pug::utility::SetSHA1HardwareEnabled(bool enabled)
+{
+	g_hardwareEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+/* Pads a copy of the state and returns the digest words */
+static void FinishDigest(const pug::utility::SHA1State& state, uint32_t* out_digest)
+{
+	uint8_t lastBlocks[SHA1_BLOCK_BYTES * 2] = {};
+	memcpy(lastBlocks, state.buffer, state.bufferedBytes);
+	lastBlocks[state.bufferedBytes] = 0x80;
+
+	/* The bit length takes the last 8 bytes, spill into a second block if they do not fit */
+	const size_t blockCount = state.bufferedBytes + 1 > SHA1_BLOCK_BYTES - 8 ? 2 : 1;
+	const uint64_t totalBits = state.totalBytes * 8;
+	uint8_t* lengthBytes = lastBlocks + blockCount * SHA1_BLOCK_BYTES - 8;
+	for (uint32_t i = 0; i < 8; ++i)
+	{
+		lengthBytes[i] = (uint8_t)(totalBits >> (56 - 8 * i));
 	}
 
-	/* Total number of hashed bits */
-	uint64_t total_bits = (transforms*blockBytes + buffer.size()) * 8;
+	memcpy(out_digest, state.digest, sizeof(state.digest));
+	GetTransformBlocks()(out_digest, lastBlocks, blockCount);
+}
+
+void pug::utility::SHA1Init(SHA1State& state)
+{
+	state.digest[0] = 0x67452301;
+	state.digest[1] = 0xefcdab89;
+	state.digest[2] = 0x98badcfe;
+	state.digest[3] = 0x10325476;
+	state.digest[4] = 0xc3d2e1f0;
+	state.bufferedBytes = 0;
+	state.totalBytes = 0;
+}
 
-	/* Padding */
-	buffer += (char)0x80;
-	size_t orig_size = buffer.size();
-	while (buffer.size() < blockBytes)
+void pug::utility::SHA1Update(SHA1State& state, const void* data, size_t size)
+{
+	const TransformBlocksFunction transformBlocks = GetTransformBlocks();
+	const uint8_t* input = (const uint8_t*)data;
+	state.totalBytes += size;
+
+	if (state.bufferedBytes > 0)
+	{/* Top up the partial block from the last update first */
+		size_t fill = SHA1_BLOCK_BYTES - state.bufferedBytes;
+		if (fill > size)
+		{
+			fill = size;
+		}
+		memcpy(state.buffer + state.bufferedBytes, input, fill);
+		state.bufferedBytes += (uint32_t)fill;
+		input += fill;
+		size -= fill;
+		if (state.bufferedBytes < SHA1_BLOCK_BYTES)
+		{
+			return;
+		}
+		transformBlocks(state.digest, state.buffer, 1);
+		state.bufferedBytes = 0;
+	}
+
+	/* Transform all full blocks straight from the input */
+	const size_t blockCount = size / SHA1_BLOCK_BYTES;
+	transformBlocks(state.digest, input, blockCount);
+	input += blockCount * SHA1_BLOCK_BYTES;
+	size -= blockCount * SHA1_BLOCK_BYTES;
+
+	memcpy(state.buffer, input, size);
+	state.bufferedBytes = (uint32_t)size;
+}
+
+void pug::utility::SHA1Final(const SHA1State& state, char* out_result, const size_t& resultSize)
+{
+	assert(resultSize == SHA1_HASH_BYTES);
+
+	uint32_t digest[5];
+	FinishDigest(state, digest);
+	for (uint32_t i = 0; i < 5; ++i)
 	{
-		buffer += (char)0x00;
+		out_result[4 * i + 0] = (char)(digest[i] >> 24);
+		out_result[4 * i + 1] = (char)(digest[i] >> 16);
+		out_result[4 * i + 2] = (char)(digest[i] >> 8);
+		out_result[4 * i + 3] = (char)digest[i];
 	}
+}
 
-	uint32_t block[blockInts];
-	BufferToBlock(buffer, block, blockInts);
+void pug::utility::SHA1(const std::string &string, char* out_result, const size_t& resultSize)
+{
+	assert(resultSize == SHA1_HASH_BYTES);
+
+	SHA1State state;
+	SHA1Init(state);
 
-	if (orig_size > blockBytes - 8)
+	/* Bit exact with the original string hash, version 1 and 2 libraries store its digests as guids.
+	   Its read loop stopped after the first block, so a string of 64 bytes or more hashed that block,
+	   hashed it again in place of the padding block and finished with a length of 128 bytes */
+	uint32_t digest[5];
+	if (string.size() >= SHA1_BLOCK_BYTES)
 	{
+		memcpy(digest, state.digest, sizeof(digest));
+		uint32_t block[SHA1_BLOCK_BYTES / 4];
+		BufferToBlock((const uint8_t*)string.data(), block, SHA1_BLOCK_BYTES / 4);
+		Transform(block, digest);
+		BufferToBlock((const uint8_t*)string.data(), block, SHA1_BLOCK_BYTES / 4);
+		Transform(block, digest);
+		memset(block, 0, sizeof(block));
+		block[SHA1_BLOCK_BYTES / 4 - 1] = SHA1_BLOCK_BYTES * 2 * 8;
 		Transform(block, digest);
-		for (unsigned int i = 0; i < blockInts - 2; i++)
+	}
+	else
+	{/* Shorter strings got a standard sha1 */
+		SHA1Update(state, string.data(), string.size());
+		FinishDigest(state, digest);
+	}
+
+	/* The digest words are copied in host order, the guids in version 1 and 2 libraries were written this way */
+	memcpy(out_result, digest, sizeof(digest));
+}
+
+bool pug::utility::HashFile(const char* filePath, char* out_result, const size_t& resultSize)
+{
+	SHA1State state;
+	SHA1Init(state);
+
+	MappedFile file;
+	if (MapFile(filePath, file))
+	{
+		for (uint64_t offset = 0; offset < file.size; offset += HASH_FILE_CHUNK_SIZE)
+		{/* In chunks so the size always fits a size_t */
+			const uint64_t remaining = file.size - offset;
+			SHA1Update(state, file.data + offset, (size_t)(remaining < HASH_FILE_CHUNK_SIZE ? remaining : HASH_FILE_CHUNK_SIZE));
+		}
+		UnmapFile(file);
+	}
+	else
+	{/* Could not map it (out of address space or not a regular file), stream it through a fixed buffer */
+		FILE* stream = nullptr;
+#ifdef _MSC_VER
+		fopen_s(&stream, filePath, "rb");
+#else
+		stream = fopen(filePath, "rb");
+#endif
+		if (stream == nullptr)
 		{
-			block[i] = 0;
+			return false;
+		}
+		uint8_t buffer[HASH_FILE_BUFFER_SIZE];
+		size_t readBytes = 0;
+		while ((readBytes = fread(buffer, 1, sizeof(buffer), stream)) > 0)
+		{
+			SHA1Update(state, buffer, readBytes);
+		}
+		const bool failed = ferror(stream) != 0;
+		fclose(stream);
+		if (failed)
+		{
+			return false;
 		}
 	}
 
-	/* Append total_bits, split this uint64 into two uint32 */
-	block[blockInts - 1] = (uint32_t)total_bits;
-	block[blockInts - 2] = (uint32_t)(total_bits >> 32);
-	Transform(block, digest);
-
-	memcpy(out_result, digest, sizeof(digest));
-}
\ No newline at end of file
+	SHA1Final(state, out_result, resultSize);
+	return true;
+}
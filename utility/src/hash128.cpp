@@ -0,0 +1,224 @@
+#include "hash.h"
+#include "const_hash.h"
+
+#include <cstring>
+
+#if !defined(PUG_HASH_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define PUG_HASH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+using namespace pug::utility;
+
+static inline uint64_t Read64(const uint8_t* data)
+{//little endian targets only, like the rest of the file formats
+	uint64_t value;
+	memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+static inline uint64_t Multiply128Fold64(uint64_t a, uint64_t b)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	uint64_t high;
+	uint64_t low = _umul128(a, b, &high);
+	return low ^ high;
+#elif defined(__SIZEOF_INT128__)
+	unsigned __int128 product = (unsigned __int128)a * b;
+	return (uint64_t)product ^ (uint64_t)(product >> 64);
+#else
+	const uint64_t loLo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+	const uint64_t hiLo = (a >> 32) * (b & 0xFFFFFFFF);
+	const uint64_t loHi = (a & 0xFFFFFFFF) * (b >> 32);
+	const uint64_t hiHi = (a >> 32) * (b >> 32);
+	const uint64_t cross = (loLo >> 32) + (hiLo & 0xFFFFFFFF) + loHi;
+	const uint64_t high = (hiLo >> 32) + (cross >> 32) + hiHi;
+	const uint64_t low = (cross << 32) | (loLo & 0xFFFFFFFF);
+	return low ^ high;
+#endif
+}
+
+static inline uint64_t Avalanche(uint64_t hash)
+{
+	hash ^= hash >> 37;
+	hash *= 0x165667919E3779F9ULL;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+#ifdef PUG_HASH_SSE2
+static void AccumulateStripe(uint64_t* accumulators, const uint8_t* data, const uint8_t* secret)
+{
+	__m128i* acc = (__m128i*)accumulators;//the state is only 8 byte aligned
+	for (uint32_t i = 0; i < HASH128_LANES / 2; ++i)
+	{
+		const __m128i dataVec = _mm_loadu_si128((const __m128i*)data + i);
+		const __m128i keyVec = _mm_loadu_si128((const __m128i*)secret + i);
+		const __m128i dataKey = _mm_xor_si128(dataVec, keyVec);
+		//low 32 bits times high 32 bits of every lane
+		const __m128i product = _mm_mul_epu32(dataKey, _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1)));
+		//the raw input goes into the neighbour lane
+		const __m128i dataSwap = _mm_shuffle_epi32(dataVec, _MM_SHUFFLE(1, 0, 3, 2));
+		const __m128i accVec = _mm_loadu_si128(acc + i);
+		_mm_storeu_si128(acc + i, _mm_add_epi64(product, _mm_add_epi64(accVec, dataSwap)));
+	}
+}
+
+static void ScrambleAccumulators(uint64_t* accumulators, const uint8_t* secret)
+{
+	__m128i* acc = (__m128i*)accumulators;
+	const __m128i prime = _mm_set1_epi32((int)HASH128_PRIME32_1);
+	for (uint32_t i = 0; i < HASH128_LANES / 2; ++i)
+	{
+		const __m128i accVec = _mm_loadu_si128(acc + i);
+		const __m128i shifted = _mm_xor_si128(accVec, _mm_srli_epi64(accVec, 47));
+		const __m128i dataKey = _mm_xor_si128(shifted, _mm_loadu_si128((const __m128i*)secret + i));
+		//64 bit multiply by a 32 bit constant out of two 32x32 multiplies
+		const __m128i productLow = _mm_mul_epu32(dataKey, prime);
+		const __m128i productHigh = _mm_mul_epu32(_mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+		_mm_storeu_si128(acc + i, _mm_add_epi64(productLow, _mm_slli_epi64(productHigh, 32)));
+	}
+}
+#else
+static void AccumulateStripe(uint64_t* accumulators, const uint8_t* data, const uint8_t* secret)
+{
+	for (uint32_t i = 0; i < HASH128_LANES; ++i)
+	{
+		const uint64_t dataValue = Read64(data + i * 8);
+		const uint64_t dataKey = dataValue ^ Read64(secret + i * 8);
+		accumulators[i ^ 1] += dataValue;
+		accumulators[i] += (dataKey & 0xFFFFFFFF) * (dataKey >> 32);
+	}
+}
+
+static void ScrambleAccumulators(uint64_t* accumulators, const uint8_t* secret)
+{
+	for (uint32_t i = 0; i < HASH128_LANES; ++i)
+	{
+		uint64_t acc = accumulators[i];
+		acc ^= acc >> 47;
+		acc ^= Read64(secret + i * 8);
+		acc *= HASH128_PRIME32_1;
+		accumulators[i] = acc;
+	}
+}
+#endif
+
+static void ConsumeStripe(uint64_t* accumulators, uint32_t& stripeIndex, const uint8_t* data)
+{
+	AccumulateStripe(accumulators, data, HASH128_SECRET + stripeIndex * 8);
+	if (++stripeIndex == HASH128_STRIPES_PER_BLOCK)
+	{
+		ScrambleAccumulators(accumulators, HASH128_SECRET + HASH128_SCRAMBLE_SECRET);
+		stripeIndex = 0;
+	}
+}
+
+static uint64_t MergeAccumulators(const uint64_t* accumulators, const uint8_t* secret, uint64_t start)
+{
+	uint64_t result = start;
+	for (uint32_t i = 0; i < HASH128_LANES / 2; ++i)
+	{
+		result += Multiply128Fold64(
+			accumulators[2 * i] ^ Read64(secret + 16 * i),
+			accumulators[2 * i + 1] ^ Read64(secret + 16 * i + 8));
+	}
+	return Avalanche(result);
+}
+
+void pug::utility::Hash128Init(Hash128State& state)
+{
+	state.accumulators[0] = HASH128_PRIME32_3;
+	state.accumulators[1] = HASH128_PRIME64_1;
+	state.accumulators[2] = HASH128_PRIME64_2;
+	state.accumulators[3] = HASH128_PRIME64_3;
+	state.accumulators[4] = HASH128_PRIME64_4;
+	state.accumulators[5] = HASH128_PRIME32_2;
+	state.accumulators[6] = HASH128_PRIME64_5;
+	state.accumulators[7] = HASH128_PRIME32_1;
+	state.bufferedBytes = 0;
+	state.stripeIndex = 0;
+	state.totalBytes = 0;
+}
+
+void pug::utility::Hash128Update(Hash128State& state, const void* data, size_t size)
+{
+	const uint8_t* input = (const uint8_t*)data;
+	state.totalBytes += size;
+
+	if (state.bufferedBytes > 0)
+	{//top up the partial stripe from the last update first
+		size_t fill = HASH128_STRIPE_BYTES - state.bufferedBytes;
+		if (fill > size)
+		{
+			fill = size;
+		}
+		memcpy(state.buffer + state.bufferedBytes, input, fill);
+		state.bufferedBytes += (uint32_t)fill;
+		input += fill;
+		size -= fill;
+		if (state.bufferedBytes < HASH128_STRIPE_BYTES)
+		{
+			return;
+		}
+		ConsumeStripe(state.accumulators, state.stripeIndex, state.buffer);
+		state.bufferedBytes = 0;
+	}
+
+	while (size >= HASH128_STRIPE_BYTES)
+	{//full stripes are read straight from the input
+		ConsumeStripe(state.accumulators, state.stripeIndex, input);
+		input += HASH128_STRIPE_BYTES;
+		size -= HASH128_STRIPE_BYTES;
+	}
+
+	if (size > 0)
+	{
+		memcpy(state.buffer, input, size);
+		state.bufferedBytes = (uint32_t)size;
+	}
+}
+
+Hash128 pug::utility::Hash128Final(const Hash128State& state)
+{
+	uint64_t accumulators[HASH128_LANES];
+	memcpy(accumulators, state.accumulators, sizeof(accumulators));
+
+	if (state.bufferedBytes > 0)
+	{//the tail is zero padded to a full stripe, the length below tells apart inputs that only differ in trailing zeros
+		uint8_t lastStripe[HASH128_STRIPE_BYTES] = {};
+		memcpy(lastStripe, state.buffer, state.bufferedBytes);
+		AccumulateStripe(accumulators, lastStripe, HASH128_SECRET + state.stripeIndex * 8);
+	}
+
+	Hash128 result;
+	result.low = MergeAccumulators(accumulators, HASH128_SECRET + 11, state.totalBytes * HASH128_PRIME64_1);
+	result.high = MergeAccumulators(accumulators, HASH128_SECRET + HASH128_SCRAMBLE_SECRET - 11, ~(state.totalBytes * HASH128_PRIME64_2));
+	return result;
+}
+
+Hash128 pug::utility::HashBuffer128(const void* data, size_t size)
+{
+	Hash128State state;
+	Hash128Init(state);
+	Hash128Update(state, data, size);
+	return Hash128Final(state);
+}
+
+void pug::utility::WriteHash128(const Hash128& hash, char* out_result, const size_t& resultSize)
+{
+	uint8_t bytes[HASH128_BYTES];
+	memcpy(bytes, &hash.low, sizeof(hash.low));
+	memcpy(bytes + sizeof(hash.low), &hash.high, sizeof(hash.high));
+
+	const size_t copySize = resultSize < HASH128_BYTES ? resultSize : HASH128_BYTES;
+	memcpy(out_result, bytes, copySize);
+	if (resultSize > copySize)
+	{
+		memset(out_result + copySize, 0, resultSize - copySize);
+	}
+}
@@ -0,0 +1,193 @@
+#include "hash_index.h"
+
+#include <cstring>
+#include <cassert>
+
+#define SLOT_EMPTY 0
+#define SLOT_USED 1
+#define SLOT_DELETED 2
+
+#define MIN_CAPACITY 16
+
+using namespace pug::utility;
+
+static uint32_t KeyToHash(const char* key)
+{
+	uint32_t hash;
+	memcpy(&hash, key, sizeof(hash));
+	return hash;
+}
+
+static uint32_t NextPowerOfTwo(uint32_t value)
+{
+	uint32_t result = MIN_CAPACITY;
+	while (result < value)
+	{
+		result <<= 1;
+	}
+	return result;
+}
+
+HashIndex::HashIndex()
+	: m_slots(nullptr)
+	, m_capacity(0)
+	, m_count(0)
+	, m_tombstones(0)
+{
+
+}
+
+HashIndex::~HashIndex()
+{
+	Destroy();
+}
+
+void HashIndex::Initialize(uint32_t expectedItemCount)
+{
+	Destroy();
+	m_capacity = NextPowerOfTwo(expectedItemCount * 2);//keep the load factor at or below 0.5
+	m_slots = new Slot[m_capacity];
+	Clear();
+}
+
+void HashIndex::Destroy()
+{
+	delete[] m_slots;
+	m_slots = nullptr;
+	m_capacity = 0;
+	m_count = 0;
+	m_tombstones = 0;
+}
+
+void HashIndex::Clear()
+{
+	if (m_slots != nullptr)
+	{
+		memset(m_slots, 0, sizeof(Slot) * m_capacity);
+	}
+	m_count = 0;
+	m_tombstones = 0;
+}
+
+uint32_t HashIndex::FindSlot(const char* key, uint32_t hash) const
+{
+	const uint32_t mask = m_capacity - 1;
+	for (uint32_t i = hash & mask, probes = 0; probes < m_capacity; i = (i + 1) & mask, ++probes)
+	{
+		const Slot& slot = m_slots[i];
+		if (slot.state == SLOT_EMPTY)
+		{//end of the probe sequence
+			break;
+		}
+		if (slot.state == SLOT_USED && slot.hash == hash && memcmp(slot.key, key, HASH_INDEX_KEY_BYTES) == 0)
+		{
+			return i;
+		}
+	}
+	return HASH_INDEX_INVALID_VALUE;
+}
+
+void HashIndex::Rehash(uint32_t newCapacity)
+{
+	Slot* oldSlots = m_slots;
+	const uint32_t oldCapacity = m_capacity;
+
+	m_capacity = newCapacity;
+	m_slots = new Slot[m_capacity];
+	Clear();
+
+	for (uint32_t i = 0; i < oldCapacity; ++i)
+	{
+		if (oldSlots[i].state == SLOT_USED)
+		{
+			Insert(oldSlots[i].key, oldSlots[i].value);
+		}
+	}
+	delete[] oldSlots;
+}
+
+bool HashIndex::Insert(const char* key, uint32_t value)
+{
+	if (m_slots == nullptr)
+	{
+		Initialize(MIN_CAPACITY / 2);
+	}
+	if ((m_count + m_tombstones + 1) * 2 > m_capacity)
+	{//grow once live entries fill a quarter of the table, otherwise just flush the tombstones
+		//growing only at half would leave a nearly half full table with no room for tombstones, and remove/insert churn would rehash every few calls
+		Rehash((m_count + 1) * 2 > m_capacity / 2 ? m_capacity * 2 : m_capacity);
+	}
+
+	const uint32_t hash = KeyToHash(key);
+	if (FindSlot(key, hash) != HASH_INDEX_INVALID_VALUE)
+	{
+		return false;
+	}
+
+	const uint32_t mask = m_capacity - 1;
+	uint32_t i = hash & mask;
+	while (m_slots[i].state == SLOT_USED)
+	{
+		i = (i + 1) & mask;
+	}
+
+	Slot& slot = m_slots[i];
+	if (slot.state == SLOT_DELETED)
+	{
+		--m_tombstones;
+	}
+	memcpy(slot.key, key, HASH_INDEX_KEY_BYTES);
+	slot.hash = hash;
+	slot.value = value;
+	slot.state = SLOT_USED;
+	++m_count;
+	return true;
+}
+
+bool HashIndex::Find(const char* key, uint32_t& out_value) const
+{
+	if (m_slots == nullptr)
+	{
+		return false;
+	}
+	uint32_t i = FindSlot(key, KeyToHash(key));
+	if (i == HASH_INDEX_INVALID_VALUE)
+	{
+		return false;
+	}
+	out_value = m_slots[i].value;
+	return true;
+}
+
+bool HashIndex::Update(const char* key, uint32_t value)
+{
+	if (m_slots == nullptr)
+	{
+		return false;
+	}
+	uint32_t i = FindSlot(key, KeyToHash(key));
+	if (i == HASH_INDEX_INVALID_VALUE)
+	{
+		return false;
+	}
+	m_slots[i].value = value;
+	return true;
+}
+
+bool HashIndex::Remove(const char* key)
+{
+	if (m_slots == nullptr)
+	{
+		return false;
+	}
+	uint32_t i = FindSlot(key, KeyToHash(key));
+	if (i == HASH_INDEX_INVALID_VALUE)
+	{
+		return false;
+	}
+	m_slots[i].state = SLOT_DELETED;
+	--m_count;
+	++m_tombstones;
+	assert(m_count < m_capacity);
+	return true;
+}
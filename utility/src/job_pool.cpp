@@ -0,0 +1,156 @@
+#include "job_pool.h"
+#include "profiler.h"
+
+#include <cstdio>
+
+using namespace pug::utility;
+
+JobPool::JobPool()
+	: m_job(nullptr)
+	, m_generation(0)
+	, m_pendingJobs(0)
+	, m_activeWorkers(0)
+	, m_shutdown(false)
+{
+
+}
+
+JobPool::~JobPool()
+{
+	Destroy();
+}
+
+void JobPool::Initialize(uint32_t workerCount)
+{
+	Destroy();
+	if (workerCount == 0)
+	{
+		workerCount = 1;
+	}
+
+	m_shutdown = false;
+	for (uint32_t i = 0; i < workerCount; ++i)
+	{
+		m_queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+	}
+	for (uint32_t i = 0; i < workerCount; ++i)
+	{
+		m_threads.push_back(std::thread(&JobPool::WorkerMain, this, i));
+	}
+}
+
+void JobPool::Destroy()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_stateLock);
+		m_shutdown = true;
+	}
+	m_wakeCondition.notify_all();
+	for (std::thread& thread : m_threads)
+	{
+		thread.join();
+	}
+	m_threads.clear();
+	m_queues.clear();
+}
+
+void JobPool::Run(uint32_t jobCount, const JobFunction& job)
+{
+	if (jobCount == 0)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> runLock(m_runLock);
+	const uint32_t workerCount = GetWorkerCount();
+
+	//hand every worker a contiguous range, neighbouring jobs tend to touch neighbouring data
+	for (uint32_t w = 0; w < workerCount; ++w)
+	{
+		const uint32_t begin = (uint32_t)(((uint64_t)jobCount * w) / workerCount);
+		const uint32_t end = (uint32_t)(((uint64_t)jobCount * (w + 1)) / workerCount);
+		std::lock_guard<std::mutex> queueLock(m_queues[w]->lock);
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			m_queues[w]->jobs.push_back(i);
+		}
+	}
+
+	std::unique_lock<std::mutex> lock(m_stateLock);
+	m_job = &job;
+	m_pendingJobs = jobCount;
+	++m_generation;
+	m_wakeCondition.notify_all();
+	//also wait for the workers to leave their pop loop, so none of them can pick up jobs of the next batch with this job function
+	m_doneCondition.wait(lock, [this]() { return m_pendingJobs == 0 && m_activeWorkers == 0; });
+	m_job = nullptr;
+}
+
+bool JobPool::PopJob(uint32_t workerIndex, uint32_t& out_jobIndex)
+{
+	{//own queue, front
+		WorkerQueue& queue = *m_queues[workerIndex];
+		std::lock_guard<std::mutex> lock(queue.lock);
+		if (!queue.jobs.empty())
+		{
+			out_jobIndex = queue.jobs.front();
+			queue.jobs.pop_front();
+			return true;
+		}
+	}
+
+	const uint32_t workerCount = GetWorkerCount();
+	for (uint32_t i = 1; i < workerCount; ++i)
+	{//steal from the back of the other queues
+		WorkerQueue& victim = *m_queues[(workerIndex + i) % workerCount];
+		std::lock_guard<std::mutex> lock(victim.lock);
+		if (!victim.jobs.empty())
+		{
+			out_jobIndex = victim.jobs.back();
+			victim.jobs.pop_back();
+			return true;
+		}
+	}
+	return false;
+}
+
+void JobPool::WorkerMain(uint32_t workerIndex)
+{
+	char threadName[PROFILER_THREAD_NAME_LENGTH];
+	snprintf(threadName, sizeof(threadName), "job worker %u", workerIndex);
+	SetProfilerThreadName(threadName);
+
+	uint64_t seenGeneration = 0;
+	while (true)
+	{
+		const JobFunction* job = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(m_stateLock);
+			m_wakeCondition.wait(lock, [&]() { return m_shutdown || m_generation != seenGeneration; });
+			if (m_shutdown)
+			{
+				return;
+			}
+			seenGeneration = m_generation;
+			job = m_job;
+			if (job == nullptr)
+			{//woke up in between two batches
+				continue;
+			}
+			++m_activeWorkers;
+		}
+
+		uint32_t jobIndex = 0;
+		while (PopJob(workerIndex, jobIndex))
+		{
+			(*job)(jobIndex, workerIndex);
+			--m_pendingJobs;
+		}
+
+		std::lock_guard<std::mutex> lock(m_stateLock);
+		if (--m_activeWorkers == 0)
+		{
+			m_doneCondition.notify_all();
+		}
+	}
+}
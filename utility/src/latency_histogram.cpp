@@ -0,0 +1,90 @@
+#include "latency_histogram.h"
+
+#include <cstring>
+#include <cmath>
+
+using namespace pug::utility;
+
+LatencyHistogram::LatencyHistogram()
+{
+	Reset();
+}
+
+uint32_t LatencyHistogram::GetBucketIndex(uint64_t value)
+{
+	if (value < LATENCY_HISTOGRAM_SUB_BUCKET_COUNT)
+	{
+		return (uint32_t)value;
+	}
+	uint32_t highestBit = LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+	while ((value >> highestBit) > 1)
+	{
+		++highestBit;
+	}
+	//keep the top SUB_BUCKET_BITS bits, the top one is always set so only the upper half of the sub buckets is used
+	const uint32_t shift = highestBit - (LATENCY_HISTOGRAM_SUB_BUCKET_BITS - 1);
+	return shift * LATENCY_HISTOGRAM_HALF_BUCKET_COUNT + (uint32_t)(value >> shift);
+}
+
+uint64_t LatencyHistogram::GetBucketUpperBound(uint32_t bucketIndex)
+{
+	if (bucketIndex < LATENCY_HISTOGRAM_SUB_BUCKET_COUNT)
+	{
+		return bucketIndex;
+	}
+	const uint32_t shift = bucketIndex / LATENCY_HISTOGRAM_HALF_BUCKET_COUNT - 1;
+	const uint64_t subBucket = bucketIndex % LATENCY_HISTOGRAM_HALF_BUCKET_COUNT + LATENCY_HISTOGRAM_HALF_BUCKET_COUNT;
+	return ((subBucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(uint64_t value)
+{
+	++m_buckets[GetBucketIndex(value)];
+	++m_count;
+	m_sum += value;
+	m_min = value < m_min ? value : m_min;
+	m_max = value > m_max ? value : m_max;
+}
+
+void LatencyHistogram::Reset()
+{
+	memset(m_buckets, 0, sizeof(m_buckets));
+	m_count = 0;
+	m_sum = 0;
+	m_min = UINT64_MAX;
+	m_max = 0;
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other)
+{
+	for (uint32_t i = 0; i < LATENCY_HISTOGRAM_BUCKET_COUNT; ++i)
+	{
+		m_buckets[i] += other.m_buckets[i];
+	}
+	m_count += other.m_count;
+	m_sum += other.m_sum;
+	m_min = other.m_min < m_min ? other.m_min : m_min;
+	m_max = other.m_max > m_max ? other.m_max : m_max;
+}
+
+uint64_t LatencyHistogram::GetPercentile(double percentile) const
+{
+	if (m_count == 0)
+	{
+		return 0;
+	}
+	//the value at least percentile% of the recorded values are less or equal to
+	uint64_t rank = (uint64_t)ceil(percentile / 100.0 * (double)m_count);
+	rank = rank < 1 ? 1 : (rank > m_count ? m_count : rank);
+	uint64_t seen = 0;
+	for (uint32_t i = 0; i < LATENCY_HISTOGRAM_BUCKET_COUNT; ++i)
+	{
+		seen += m_buckets[i];
+		if (seen >= rank)
+		{
+			const uint64_t upperBound = GetBucketUpperBound(i);
+			return upperBound < m_max ? upperBound : m_max;
+		}
+	}
+	return m_max;
+}
@@ -0,0 +1,122 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace pug::utility;
+
+#ifdef _WIN32
+
+bool pug::utility::MapFile(const char* path, MappedFile& out_file)
+{
+	out_file = {};
+
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize))
+	{
+		CloseHandle(file);
+		return false;
+	}
+	if (fileSize.QuadPart == 0)
+	{//empty files can not be mapped, hand out an empty view
+		out_file.fileHandle = file;
+		return true;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	out_file.data = (const uint8_t*)view;
+	out_file.size = (uint64_t)fileSize.QuadPart;
+	out_file.fileHandle = file;
+	out_file.mappingHandle = mapping;
+	return true;
+}
+
+void pug::utility::UnmapFile(MappedFile& file)
+{
+	if (file.data != nullptr)
+	{
+		UnmapViewOfFile(file.data);
+	}
+	if (file.mappingHandle != nullptr)
+	{
+		CloseHandle((HANDLE)file.mappingHandle);
+	}
+	if (file.fileHandle != nullptr)
+	{
+		CloseHandle((HANDLE)file.fileHandle);
+	}
+	file = {};
+}
+
+#else
+
+bool pug::utility::MapFile(const char* path, MappedFile& out_file)
+{
+	out_file = {};
+
+	int fd = open(path, O_RDONLY);
+	if (fd == -1)
+	{
+		return false;
+	}
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0)
+	{
+		close(fd);
+		return false;
+	}
+	if (fileStat.st_size == 0)
+	{//empty files can not be mapped, hand out an empty view
+		close(fd);
+		return true;
+	}
+
+	void* view = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);//the mapping keeps its own reference to the file
+	if (view == MAP_FAILED)
+	{
+		return false;
+	}
+
+	out_file.data = (const uint8_t*)view;
+	out_file.size = (uint64_t)fileStat.st_size;
+	return true;
+}
+
+void pug::utility::UnmapFile(MappedFile& file)
+{
+	if (file.data != nullptr)
+	{
+		munmap((void*)file.data, (size_t)file.size);
+	}
+	file = {};
+}
+
+#endif
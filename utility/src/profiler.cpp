@@ -0,0 +1,235 @@
+#include "profiler.h"
+
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+
+#define PROFILER_EXPORT_BUFFER_SIZE (64 * 1024)
+
+using namespace pug::utility;
+
+std::atomic<bool> pug::utility::g_profilerCapturing(false);
+
+struct ProfileEvent
+{
+	const char* name;
+	uint64_t start;//profiler ticks
+	uint64_t end;
+};
+
+//only written by its own thread, the exporter reads the events below the published count
+struct ProfilerThreadBuffer
+{
+	std::unique_ptr<ProfileEvent[]> events;//allocated on the first event, threads that never profile cost nothing
+	std::atomic<uint32_t> eventCount;
+	std::atomic<uint32_t> capture;//the capture the events belong to, a new one starts over at 0
+	std::atomic<uint64_t> droppedEvents;
+	char name[PROFILER_THREAD_NAME_LENGTH];
+	uint32_t threadIndex;
+};
+
+static std::mutex g_bufferLock;//guards the buffer list, taken once per thread and by the export
+static std::vector<std::unique_ptr<ProfilerThreadBuffer>> g_buffers;
+static thread_local ProfilerThreadBuffer* t_buffer = nullptr;
+
+static std::atomic<uint32_t> g_capture(0);
+//both clocks at the start and the end of the capture, converts ticks to microseconds
+static uint64_t g_captureStartTicks;
+static uint64_t g_captureEndTicks;
+static std::chrono::steady_clock::time_point g_captureStartTime;
+static std::chrono::steady_clock::time_point g_captureEndTime;
+
+static ProfilerThreadBuffer* GetThreadBuffer()
+{
+	if (t_buffer == nullptr)
+	{
+		std::unique_ptr<ProfilerThreadBuffer> buffer(new ProfilerThreadBuffer());
+		buffer->eventCount.store(0, std::memory_order_relaxed);
+		buffer->capture.store(0, std::memory_order_relaxed);
+		buffer->droppedEvents.store(0, std::memory_order_relaxed);
+		std::lock_guard<std::mutex> lock(g_bufferLock);
+		buffer->threadIndex = (uint32_t)g_buffers.size() + 1;
+		snprintf(buffer->name, sizeof(buffer->name), "thread %u", buffer->threadIndex);
+		t_buffer = buffer.get();
+		g_buffers.push_back(std::move(buffer));
+	}
+	return t_buffer;
+}
+
+void pug::utility::BeginProfileCapture()
+{
+	g_profilerCapturing.store(false, std::memory_order_relaxed);
+	g_capture.fetch_add(1, std::memory_order_relaxed);
+	g_captureStartTime = std::chrono::steady_clock::now();
+	g_captureStartTicks = GetProfilerTicks();
+	g_captureEndTicks = 0;
+	g_profilerCapturing.store(true, std::memory_order_release);
+}
+
+void pug::utility::EndProfileCapture()
+{
+	g_profilerCapturing.store(false, std::memory_order_release);
+	g_captureEndTicks = GetProfilerTicks();
+	g_captureEndTime = std::chrono::steady_clock::now();
+}
+
+void pug::utility::SetProfilerThreadName(const char* name)
+{
+	ProfilerThreadBuffer* buffer = GetThreadBuffer();
+	std::lock_guard<std::mutex> lock(g_bufferLock);//the export might be reading it
+	snprintf(buffer->name, sizeof(buffer->name), "%s", name);
+}
+
+void pug::utility::RecordProfileEvent(const char* name, uint64_t startTicks, uint64_t endTicks)
+{
+	ProfilerThreadBuffer* buffer = GetThreadBuffer();
+	const uint32_t capture = g_capture.load(std::memory_order_relaxed);
+	if (buffer->capture.load(std::memory_order_relaxed) != capture)
+	{//first event of this thread in a new capture
+		buffer->eventCount.store(0, std::memory_order_relaxed);
+		buffer->droppedEvents.store(0, std::memory_order_relaxed);
+		buffer->capture.store(capture, std::memory_order_release);
+	}
+	if (!buffer->events)
+	{
+		buffer->events.reset(new ProfileEvent[PROFILER_THREAD_EVENT_CAPACITY]);
+	}
+
+	const uint32_t count = buffer->eventCount.load(std::memory_order_relaxed);
+	if (count >= PROFILER_THREAD_EVENT_CAPACITY)
+	{
+		buffer->droppedEvents.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	ProfileEvent& event = buffer->events[count];
+	event.name = name;
+	event.start = startTicks;
+	event.end = endTicks;
+	buffer->eventCount.store(count + 1, std::memory_order_release);//publish
+}
+
+uint64_t pug::utility::GetProfilerDroppedEventCount()
+{
+	const uint32_t capture = g_capture.load(std::memory_order_relaxed);
+	uint64_t droppedEvents = 0;
+	std::lock_guard<std::mutex> lock(g_bufferLock);
+	for (const std::unique_ptr<ProfilerThreadBuffer>& buffer : g_buffers)
+	{
+		if (buffer->capture.load(std::memory_order_acquire) == capture)
+		{
+			droppedEvents += buffer->droppedEvents.load(std::memory_order_relaxed);
+		}
+	}
+	return droppedEvents;
+}
+
+//batches the JSON text, the file is written in large chunks
+struct TraceWriter
+{
+	std::ofstream file;
+	char buffer[PROFILER_EXPORT_BUFFER_SIZE];
+	size_t length;
+
+	void Flush()
+	{
+		file.write(buffer, length);
+		length = 0;
+	}
+
+	void Append(const char* text, size_t textLength)
+	{
+		if (length + textLength > sizeof(buffer))
+		{
+			Flush();
+		}
+		if (textLength > sizeof(buffer))
+		{
+			file.write(text, textLength);
+			return;
+		}
+		memcpy(buffer + length, text, textLength);
+		length += textLength;
+	}
+
+	void AppendEscaped(const char* text)
+	{
+		for (; *text != 0; ++text)
+		{
+			char escaped[8];
+			if (*text == '"' || *text == '\\')
+			{
+				escaped[0] = '\\';
+				escaped[1] = *text;
+				Append(escaped, 2);
+			}
+			else if ((unsigned char)*text < 0x20)
+			{
+				const int escapedLength = snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned int)(unsigned char)*text);
+				Append(escaped, (size_t)escapedLength);
+			}
+			else
+			{
+				Append(text, 1);
+			}
+		}
+	}
+};
+
+bool pug::utility::WriteChromeTrace(const char* filePath)
+{
+	std::unique_ptr<TraceWriter> writer(new TraceWriter());//too large for the stack
+	writer->file.open(filePath, std::ios::out | std::ios::trunc | std::ios::binary);
+	if (!writer->file.is_open())
+	{
+		return false;
+	}
+	writer->length = 0;
+
+	//a capture that is still running is measured up to now
+	const bool capturing = IsProfilerCapturing();
+	const uint64_t endTicks = capturing ? GetProfilerTicks() : g_captureEndTicks;
+	const std::chrono::steady_clock::time_point endTime = capturing ? std::chrono::steady_clock::now() : g_captureEndTime;
+	const double captureMicroseconds = std::chrono::duration<double, std::micro>(endTime - g_captureStartTime).count();
+	const double ticksPerMicrosecond = endTicks > g_captureStartTicks && captureMicroseconds > 0.0 ? (double)(endTicks - g_captureStartTicks) / captureMicroseconds : 1.0;
+	const uint32_t capture = g_capture.load(std::memory_order_relaxed);
+
+	char line[256];
+	uint64_t droppedEvents = 0;
+	bool first = true;
+	writer->Append("{\"traceEvents\":[\n", 17);
+	std::lock_guard<std::mutex> lock(g_bufferLock);
+	for (const std::unique_ptr<ProfilerThreadBuffer>& buffer : g_buffers)
+	{
+		if (buffer->capture.load(std::memory_order_acquire) != capture)
+		{//nothing recorded on this thread during the capture
+			continue;
+		}
+		const uint32_t eventCount = buffer->eventCount.load(std::memory_order_acquire);
+		droppedEvents += buffer->droppedEvents.load(std::memory_order_relaxed);
+
+		int lineLength = snprintf(line, sizeof(line), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"", first ? "" : ",\n", buffer->threadIndex);
+		writer->Append(line, (size_t)lineLength);
+		writer->AppendEscaped(buffer->name);
+		writer->Append("\"}}", 3);
+		first = false;
+
+		for (uint32_t i = 0; i < eventCount; ++i)
+		{
+			const ProfileEvent& event = buffer->events[i];
+			writer->Append(",\n{\"name\":\"", 11);
+			writer->AppendEscaped(event.name);
+			//events that started before the capture are clamped to its start
+			const double start = event.start > g_captureStartTicks ? (double)(event.start - g_captureStartTicks) / ticksPerMicrosecond : 0.0;
+			const double duration = event.end > event.start ? (double)(event.end - event.start) / ticksPerMicrosecond : 0.0;
+			lineLength = snprintf(line, sizeof(line), "\",\"cat\":\"pug\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", buffer->threadIndex, start, duration);
+			writer->Append(line, (size_t)lineLength);
+		}
+	}
+	const int lineLength = snprintf(line, sizeof(line), "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedEvents\":\"%llu\"}}\n", (unsigned long long)droppedEvents);
+	writer->Append(line, (size_t)lineLength);
+	writer->Flush();
+	return writer->file.good();
+}
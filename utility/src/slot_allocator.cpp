@@ -0,0 +1,104 @@
+#include "slot_allocator.h"
+
+#include <cassert>
+
+#define SLOT_IN_USE 0xFFFFFFFF
+#define SLOT_LIST_END 0xFFFFFFFE
+
+using namespace pug::utility;
+
+static uint16_t NextGeneration(uint16_t generation)
+{
+	return generation == 0xFFFF ? 1 : generation + 1;
+}
+
+SlotAllocator::SlotAllocator()
+	: m_generations(nullptr)
+	, m_nextFree(nullptr)
+	, m_freeHead(SLOT_LIST_END)
+	, m_capacity(0)
+	, m_count(0)
+{
+
+}
+
+SlotAllocator::~SlotAllocator()
+{
+	Destroy();
+}
+
+void SlotAllocator::Initialize(uint32_t capacity)
+{
+	assert(capacity <= SLOT_HANDLE_MAX_CAPACITY);
+	Destroy();
+	m_capacity = capacity;
+	m_generations = new uint16_t[m_capacity];
+	m_nextFree = new uint32_t[m_capacity]();//zeroed, Clear reads it to find the slots in use
+	for (uint32_t i = 0; i < m_capacity; ++i)
+	{
+		m_generations[i] = 1;
+	}
+	Clear();
+}
+
+void SlotAllocator::Destroy()
+{
+	delete[] m_generations;
+	delete[] m_nextFree;
+	m_generations = nullptr;
+	m_nextFree = nullptr;
+	m_freeHead = SLOT_LIST_END;
+	m_capacity = 0;
+	m_count = 0;
+}
+
+void SlotAllocator::Clear()
+{
+	for (uint32_t i = 0; i < m_capacity; ++i)
+	{
+		if (m_nextFree[i] == SLOT_IN_USE)
+		{
+			m_generations[i] = NextGeneration(m_generations[i]);
+		}
+		//low slots are handed out first, keeps the tables dense
+		m_nextFree[i] = (i + 1 < m_capacity) ? i + 1 : SLOT_LIST_END;
+	}
+	m_freeHead = m_capacity > 0 ? 0 : SLOT_LIST_END;
+	m_count = 0;
+}
+
+uint32_t SlotAllocator::Allocate()
+{
+	if (m_freeHead == SLOT_LIST_END)
+	{
+		return SLOT_INVALID_HANDLE;
+	}
+	const uint32_t index = m_freeHead;
+	m_freeHead = m_nextFree[index];
+	m_nextFree[index] = SLOT_IN_USE;
+	++m_count;
+	return ((uint32_t)m_generations[index] << SLOT_HANDLE_INDEX_BITS) | index;
+}
+
+bool SlotAllocator::Free(uint32_t handle)
+{
+	if (!IsValid(handle))
+	{
+		return false;
+	}
+	const uint32_t index = SLOT_INDEX(handle);
+	m_generations[index] = NextGeneration(m_generations[index]);
+	m_nextFree[index] = m_freeHead;
+	m_freeHead = index;
+	--m_count;
+	return true;
+}
+
+bool SlotAllocator::IsValid(uint32_t handle) const
+{
+	const uint32_t index = SLOT_INDEX(handle);
+	return handle != SLOT_INVALID_HANDLE &&
+		index < m_capacity &&
+		m_nextFree[index] == SLOT_IN_USE &&
+		m_generations[index] == (handle >> SLOT_HANDLE_INDEX_BITS);
+}